@@ -68,6 +68,7 @@ public class MaterialBuilder {
         SAMPLER_2D,             // 2D texture
         SAMPLER_CUBEMAP,        // Cube map texture
         SAMPLER_EXTERNAL,       // External texture
+        SAMPLER_2D_ARRAY,       // 2D array texture
     }
 
     public enum SamplerFormat {
@@ -86,7 +86,9 @@ public class Texture {
         /** Cubemap sampler */
         SAMPLER_CUBEMAP,
         /** External texture sampler */
-        SAMPLER_EXTERNAL
+        SAMPLER_EXTERNAL,
+        /** 2D array sampler */
+        SAMPLER_2D_ARRAY
     }
 
     /**
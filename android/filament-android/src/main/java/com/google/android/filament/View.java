@@ -625,18 +625,24 @@ public class View {
     /**
      * Sets whether this view is rendered with or without a depth pre-pass.
      *
-     * <p><b>This setting is ignored and will be removed in future versions of Filament.</b></p>
-     *
      * <p>
      * By default, the system picks the most appropriate strategy for your platform; this method
-     * lets you override that strategy.
+     * lets you override that strategy. Currently the default is to not use a depth pre-pass.
      * </p>
      *
      * <p>
-     * When the depth pre-pass is enabled, the renderer will first draw all objects in the
+     * When the depth pre-pass is enabled, the renderer will first draw all opaque objects in the
      * depth buffer from front to back, and then draw the objects again but sorted to minimize
-     * state changes. With the depth pre-pass disabled, objects are drawn only once, but it may
-     * result in more state changes or more overdraw.
+     * state changes, with an equal depth test and without writing depth, so that each pixel is
+     * shaded only once. With the depth pre-pass disabled, objects are drawn only once, but it
+     * may result in more state changes or more overdraw.
+     * </p>
+     *
+     * <p>
+     * When ambient occlusion is enabled and multi-sampling is disabled, the depth pass used
+     * by ambient occlusion is rendered at full resolution and also used as the depth pre-pass,
+     * so the pre-pass is free. Ambient occlusion is still computed at the resolution set in
+     * the ambient occlusion options, and upsampled with a depth-aware filter.
      * </p>
      *
      * <p>
@@ -649,7 +655,6 @@ public class View {
      * <li>DepthPrepass::ENABLE enables the depth pre-pass</li>
      * </ul>
      */
-    @Deprecated
     public void setDepthPrepass(@NonNull DepthPrepass depthPrepass) {
         mDepthPrepass = depthPrepass;
         nSetDepthPrepass(getNativeObject(), depthPrepass.value);
@@ -91,9 +91,51 @@ public class ResourceLoader {
         return this;
     }
 
+    /**
+     * Starts an asynchronous resource load.
+     *
+     * <p>This does the same work as {@link #loadResources}, except that it returns without
+     * waiting for images to be decoded. The decoded textures are uploaded progressively by
+     * subsequent calls to {@link #asyncUpdateLoad}.</p>
+     *
+     * <p>Only one asset can be loaded asynchronously at a time.</p>
+     *
+     * @param asset the Filament asset that contains URI-based resources
+     * @return false if the resources could not be loaded, or if a load is already in progress
+     */
+    public boolean asyncBeginLoad(@NonNull FilamentAsset asset) {
+        return nAsyncBeginLoad(mNativeObject, asset.getNativeObject());
+    }
+
+    /**
+     * Uploads the textures decoded since the last call, within the upload budget. This should be
+     * called once per frame until {@link #asyncGetLoadProgress} returns 1.
+     */
+    public void asyncUpdateLoad() {
+        nAsyncUpdateLoad(mNativeObject);
+    }
+
+    /**
+     * Returns the fraction of textures that have been uploaded, between 0 and 1.
+     */
+    public float asyncGetLoadProgress() {
+        return nAsyncGetLoadProgress(mNativeObject);
+    }
+
+    /**
+     * Cancels the asynchronous load in progress, if any.
+     */
+    public void asyncCancelLoad() {
+        nAsyncCancelLoad(mNativeObject);
+    }
+
     private static native long nCreateResourceLoader(long nativeEngine);
     private static native void nDestroyResourceLoader(long nativeLoader);
     private static native void nAddResourceData(long nativeLoader, String url, Buffer buffer,
             int remaining);
     private static native void nLoadResources(long nativeLoader, long nativeAsset);
+    private static native boolean nAsyncBeginLoad(long nativeLoader, long nativeAsset);
+    private static native void nAsyncUpdateLoad(long nativeLoader);
+    private static native float nAsyncGetLoadProgress(long nativeLoader);
+    private static native void nAsyncCancelLoad(long nativeLoader);
 }
@@ -171,6 +171,7 @@ enum class SamplerType : uint8_t {
     SAMPLER_2D,         //!< 2D or 2D array texture
     SAMPLER_CUBEMAP,    //!< Cube map texture
     SAMPLER_EXTERNAL,   //!< External texture
+    SAMPLER_2D_ARRAY,   //!< 2D array texture
 };
 
 //! Texture sampler format
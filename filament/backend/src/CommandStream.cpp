@@ -237,6 +237,7 @@ io::ostream& operator<<(io::ostream& out, SamplerType type) {
         CASE(SamplerType, SAMPLER_2D)
         CASE(SamplerType, SAMPLER_CUBEMAP)
         CASE(SamplerType, SAMPLER_EXTERNAL)
+        CASE(SamplerType, SAMPLER_2D_ARRAY)
     }
     return out;
 }
@@ -128,6 +128,9 @@ struct HwFence : public HwBase {
     Platform::Fence* fence = nullptr;
 };
 
+struct HwTimerQuery : public HwBase {
+};
+
 struct HwSwapChain : public HwBase {
     Platform::SwapChain* swapChain = nullptr;
 };
@@ -68,6 +68,7 @@ template io::ostream& operator<<(io::ostream& out, const Handle<HwRenderTarget>&
 template io::ostream& operator<<(io::ostream& out, const Handle<HwFence>& h) noexcept;
 template io::ostream& operator<<(io::ostream& out, const Handle<HwSwapChain>& h) noexcept;
 template io::ostream& operator<<(io::ostream& out, const Handle<HwStream>& h) noexcept;
+template io::ostream& operator<<(io::ostream& out, const Handle<HwTimerQuery>& h) noexcept;
 
 #endif
 
@@ -43,6 +43,12 @@ public:
      */
     void copyIntoBuffer(void* src, size_t size);
 
+    /**
+     * Update a sub-range of the buffer with data inside src. The rest of the buffer's contents are
+     * preserved, which may require copying them into a new buffer allocation.
+     */
+    void copyIntoBuffer(void* src, size_t size, size_t byteOffset);
+
     /**
      * Denotes that this buffer is used for a draw call ensuring that its allocation remains valid
      * until the end of the current frame.
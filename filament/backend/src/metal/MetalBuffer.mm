@@ -68,6 +68,31 @@ void MetalBuffer::copyIntoBuffer(void* src, size_t size) {
     memcpy(static_cast<uint8_t*>(mBufferPoolEntry->buffer.contents), src, size);
 }
 
+void MetalBuffer::copyIntoBuffer(void* src, size_t size, size_t byteOffset) {
+    if (size <= 0) {
+        return;
+    }
+    ASSERT_PRECONDITION(byteOffset + size <= mBufferSize,
+            "Attempting to copy %d bytes at offset %d into a buffer of size %d",
+            size, byteOffset, mBufferSize);
+
+    if (mCpuBuffer) {
+        memcpy(static_cast<uint8_t*>(mCpuBuffer) + byteOffset, src, size);
+        return;
+    }
+
+    // The current allocation might still be in use by the GPU, so we acquire a new one and carry
+    // over the previous contents before applying the update.
+    const MetalBufferPoolEntry* previous = mBufferPoolEntry;
+    mBufferPoolEntry = mContext.bufferPool->acquireBuffer(mBufferSize);
+    uint8_t* contents = static_cast<uint8_t*>(mBufferPoolEntry->buffer.contents);
+    if (previous) {
+        memcpy(contents, previous->buffer.contents, mBufferSize);
+        mContext.bufferPool->releaseBuffer(previous);
+    }
+    memcpy(contents + byteOffset, src, size);
+}
+
 id<MTLBuffer> MetalBuffer::getGpuBufferForDraw(id<MTLCommandBuffer> cmdBuffer) noexcept {
     if (!mBufferPoolEntry) {
         // If there's a CPU buffer, then we return nil here, as the CPU-side buffer will be bound
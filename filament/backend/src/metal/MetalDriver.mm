@@ -206,8 +206,20 @@ void MetalDriver::createRenderTargetR(Handle<HwRenderTarget> rth,
         return nil;
     };
 
+    // only array textures have layers, for cubemaps the layer is aliased with the face
+    auto getLayer = [&](TargetBufferInfo const& info) -> uint16_t {
+        if (info.handle) {
+            auto texture = handle_cast<MetalTexture>(mHandleMap, info.handle);
+            if (texture->target == SamplerType::SAMPLER_2D_ARRAY) {
+                return info.layer;
+            }
+        }
+        return 0;
+    };
+
     construct_handle<MetalRenderTarget>(mHandleMap, rth, mContext, width, height, samples,
-            getColorTexture(), getDepthTexture(), color.level, depth.level);
+            getColorTexture(), getDepthTexture(), color.level, depth.level,
+            getLayer(color), getLayer(depth));
 
     ASSERT_POSTCONDITION(
             !stencil.handle &&
@@ -219,6 +231,10 @@ void MetalDriver::createFenceR(Handle<HwFence> fh, int dummy) {
     construct_handle<MetalFence>(mHandleMap, fh, *mContext);
 }
 
+void MetalDriver::createTimerQueryR(Handle<HwTimerQuery> tqh, int dummy) {
+    construct_handle<MetalTimerQuery>(mHandleMap, tqh);
+}
+
 void MetalDriver::createSwapChainR(Handle<HwSwapChain> sch, void* nativeWindow, uint64_t flags) {
     auto* metalLayer = (__bridge CAMetalLayer*) nativeWindow;
     construct_handle<MetalSwapChain>(mHandleMap, sch, mContext->device, metalLayer);
@@ -274,6 +290,10 @@ Handle<HwFence> MetalDriver::createFenceS() noexcept {
     return alloc_handle<MetalFence, HwFence>();
 }
 
+Handle<HwTimerQuery> MetalDriver::createTimerQueryS() noexcept {
+    return alloc_handle<MetalTimerQuery, HwTimerQuery>();
+}
+
 Handle<HwSwapChain> MetalDriver::createSwapChainS() noexcept {
     return alloc_handle<MetalSwapChain, HwSwapChain>();
 }
@@ -534,6 +554,16 @@ void MetalDriver::destroyFence(Handle<HwFence> fh) {
     }
 }
 
+void MetalDriver::destroyTimerQuery(Handle<HwTimerQuery> tqh) {
+    if (tqh) {
+        destruct_handle<MetalTimerQuery>(mHandleMap, tqh);
+    }
+}
+
+bool MetalDriver::getTimerQueryValue(Handle<HwTimerQuery> tqh, uint64_t* elapsedTime) {
+    return false;
+}
+
 FenceStatus MetalDriver::wait(Handle<HwFence> fh, uint64_t timeout) {
     auto* fence = handle_cast<MetalFence>(mHandleMap, fh);
     if (!fence) {
@@ -702,6 +732,18 @@ void MetalDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh,
     scheduleDestroy(std::move(data));
 }
 
+void MetalDriver::updateUniformBuffer(Handle<HwUniformBuffer> ubh,
+        BufferDescriptor&& data, uint32_t byteOffset) {
+    if (data.size <= 0) {
+       return;
+    }
+
+    auto uniform = handle_cast<MetalUniformBuffer>(mHandleMap, ubh);
+
+    uniform->buffer.copyIntoBuffer(data.buffer, data.size, byteOffset);
+    scheduleDestroy(std::move(data));
+}
+
 void MetalDriver::updateSamplerGroup(Handle<HwSamplerGroup> sbh,
         SamplerGroup&& samplerGroup) {
     auto sb = handle_cast<MetalSamplerGroup>(mHandleMap, sbh);
@@ -726,6 +768,7 @@ void MetalDriver::beginRenderPass(Handle<HwRenderTarget> rth,
     colorAttachment.texture = renderTarget->getColor();
     colorAttachment.resolveTexture = discardColor ? nil : renderTarget->getColorResolve();
     colorAttachment.level = renderTarget->getColorLevel();
+    colorAttachment.slice = renderTarget->getColorLayer();
     mContext->currentSurfacePixelFormat = colorAttachment.texture.pixelFormat;
 
     // Metal clears the entire attachment without respect to viewport or scissor.
@@ -745,6 +788,7 @@ void MetalDriver::beginRenderPass(Handle<HwRenderTarget> rth,
     depthAttachment.storeAction = renderTarget->getStoreAction(params, TargetBufferFlags::DEPTH);
     depthAttachment.clearDepth = params.clearDepth;
     depthAttachment.level = renderTarget->getDepthLevel();
+    depthAttachment.slice = renderTarget->getDepthLayer();
     mContext->currentDepthPixelFormat = descriptor.depthAttachment.texture.pixelFormat;
 
     mContext->currentRenderPassEncoder =
@@ -859,6 +903,12 @@ void MetalDriver::popGroupMarker(int dummy) {
 
 }
 
+void MetalDriver::beginTimerQuery(Handle<HwTimerQuery> tqh) {
+}
+
+void MetalDriver::endTimerQuery(Handle<HwTimerQuery> tqh) {
+}
+
 void MetalDriver::startCapture(int) {
     [[MTLCaptureManager sharedCaptureManager] startCaptureWithDevice:mContext->device];
 }
@@ -128,7 +128,8 @@ struct MetalSamplerGroup : public HwSamplerGroup {
 class MetalRenderTarget : public HwRenderTarget {
 public:
     MetalRenderTarget(MetalContext* context, uint32_t width, uint32_t height, uint8_t samples,
-            id<MTLTexture> color, id<MTLTexture> depth, uint8_t colorLevel, uint8_t depthLevel);
+            id<MTLTexture> color, id<MTLTexture> depth, uint8_t colorLevel, uint8_t depthLevel,
+            uint16_t colorLayer, uint16_t depthLayer);
     explicit MetalRenderTarget(MetalContext* context)
             : HwRenderTarget(0, 0), context(context), defaultRenderTarget(true) {}
 
@@ -145,6 +146,8 @@ public:
     id<MTLTexture> getBlitDepthSource();
     uint8_t getColorLevel() { return colorLevel; }
     uint8_t getDepthLevel() { return depthLevel; }
+    uint16_t getColorLayer() { return colorLayer; }
+    uint16_t getDepthLayer() { return depthLayer; }
 
 private:
     static id<MTLTexture> createMultisampledTexture(id<MTLDevice> device, MTLPixelFormat format,
@@ -155,6 +158,8 @@ private:
     uint8_t samples = 1;
     uint8_t colorLevel = 0;
     uint8_t depthLevel = 0;
+    uint16_t colorLayer = 0;
+    uint16_t depthLayer = 0;
 
     id<MTLTexture> color = nil;
     id<MTLTexture> depth = nil;
@@ -182,6 +187,10 @@ private:
     uint64_t value;
 };
 
+// Timer queries are not implemented on Metal yet, they never have a result.
+struct MetalTimerQuery : public HwTimerQuery {
+};
+
 } // namespace metal
 } // namespace backend
 } // namespace filament
@@ -234,6 +234,19 @@ MetalTexture::MetalTexture(MetalContext& context, backend::SamplerType target, u
         descriptor.storageMode = MTLStorageModePrivate;
         texture = [context.device newTextureWithDescriptor:descriptor];
         ASSERT_POSTCONDITION(texture != nil, "Could not create Metal texture. Out of memory?");
+    } else if (target == backend::SamplerType::SAMPLER_2D_ARRAY) {
+        ASSERT_POSTCONDITION(!multisampled, "Multisampled texture arrays not supported.");
+        descriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:metalPixelFormat
+                                                                        width:width
+                                                                       height:height
+                                                                    mipmapped:mipmapped];
+        descriptor.mipmapLevelCount = levels;
+        descriptor.textureType = MTLTextureType2DArray;
+        descriptor.arrayLength = depth;
+        descriptor.usage = getMetalTextureUsage(usage);
+        descriptor.storageMode = MTLStorageModePrivate;
+        texture = [context.device newTextureWithDescriptor:descriptor];
+        ASSERT_POSTCONDITION(texture != nil, "Could not create Metal texture. Out of memory?");
     } else if (target == backend::SamplerType::SAMPLER_CUBEMAP) {
         ASSERT_POSTCONDITION(!multisampled, "Multisampled cubemap faces not supported.");
         ASSERT_POSTCONDITION(width == height, "Cubemap faces must be square.");
@@ -370,8 +383,10 @@ void MetalTexture::loadSlice(uint32_t level, uint32_t xoffset, uint32_t yoffset,
 
 MetalRenderTarget::MetalRenderTarget(MetalContext* context, uint32_t width, uint32_t height,
         uint8_t samples, id<MTLTexture> color, id<MTLTexture> depth, uint8_t colorLevel,
-        uint8_t depthLevel) : HwRenderTarget(width, height), context(context), samples(samples),
-        colorLevel(colorLevel), depthLevel(depthLevel) {
+        uint8_t depthLevel, uint16_t colorLayer, uint16_t depthLayer)
+        : HwRenderTarget(width, height), context(context), samples(samples),
+        colorLevel(colorLevel), depthLevel(depthLevel),
+        colorLayer(colorLayer), depthLayer(depthLayer) {
     ASSERT_PRECONDITION(color || depth, "Must provide either a color or depth texture.");
 
     if (color) {
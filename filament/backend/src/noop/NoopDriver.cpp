@@ -95,6 +95,9 @@ void NoopDriver::destroySwapChain(Handle<HwSwapChain> sch) {
 void NoopDriver::destroyStream(Handle<HwStream> sh) {
 }
 
+void NoopDriver::destroyTimerQuery(Handle<HwTimerQuery> tqh) {
+}
+
 Handle<HwStream> NoopDriver::createStreamNative(void* nativeStream) {
     return {};
 }
@@ -124,6 +127,11 @@ FenceStatus NoopDriver::wait(Handle<HwFence> fh, uint64_t timeout) {
     return FenceStatus::CONDITION_SATISFIED;
 }
 
+bool NoopDriver::getTimerQueryValue(Handle<HwTimerQuery> tqh, uint64_t* elapsedTime) {
+    *elapsedTime = 0;
+    return true;
+}
+
 // We create all textures using VK_IMAGE_TILING_OPTIMAL, so our definition of "supported" is that
 // the GPU supports the given texture format with non-zero optimal tiling features.
 bool NoopDriver::isTextureFormatSupported(TextureFormat format) {
@@ -188,6 +196,11 @@ void NoopDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor
     scheduleDestroy(std::move(data));
 }
 
+void NoopDriver::updateUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& data,
+        uint32_t byteOffset) {
+    scheduleDestroy(std::move(data));
+}
+
 void NoopDriver::updateSamplerGroup(Handle<HwSamplerGroup> sbh,
         SamplerGroup&& samplerGroup) {
 }
@@ -238,6 +251,12 @@ void NoopDriver::pushGroupMarker(char const* string,  size_t len) {
 void NoopDriver::popGroupMarker(int) {
 }
 
+void NoopDriver::beginTimerQuery(Handle<HwTimerQuery> tqh) {
+}
+
+void NoopDriver::endTimerQuery(Handle<HwTimerQuery> tqh) {
+}
+
 void NoopDriver::startCapture(int) {
 }
 
@@ -385,6 +385,7 @@ OpenGLDriver::HandleAllocator::HandleAllocator(const utils::HeapArea& area)
     slog.d << "GLVertexBuffer: " << sizeof(GLVertexBuffer) << io::endl;
     slog.d << "GLUniformBuffer: " << sizeof(GLUniformBuffer) << io::endl;
     slog.d << "GLStream: " << sizeof(GLStream) << io::endl;
+    slog.d << "GLTimerQuery: " << sizeof(GLTimerQuery) << io::endl;
 #endif
 }
 
@@ -483,6 +484,10 @@ Handle<HwFence> OpenGLDriver::createFenceS() noexcept {
     return Handle<HwFence>( allocateHandle(sizeof(HwFence)) );
 }
 
+Handle<HwTimerQuery> OpenGLDriver::createTimerQueryS() noexcept {
+    return Handle<HwTimerQuery>( allocateHandle(sizeof(GLTimerQuery)) );
+}
+
 Handle<HwSwapChain> OpenGLDriver::createSwapChainS() noexcept {
     return Handle<HwSwapChain>( allocateHandle(sizeof(HwSwapChain)) );
 }
@@ -667,6 +672,10 @@ void OpenGLDriver::createTextureR(Handle<HwTexture> th, SamplerType target, uint
                                 gl.getIndexForTextureTarget(t->gl.target = GL_TEXTURE_2D_ARRAY);
                     }
                     break;
+                case SamplerType::SAMPLER_2D_ARRAY:
+                    t->gl.targetIndex = (uint8_t)
+                            gl.getIndexForTextureTarget(t->gl.target = GL_TEXTURE_2D_ARRAY);
+                    break;
                 case SamplerType::SAMPLER_CUBEMAP:
                     t->gl.targetIndex = (uint8_t)
                             gl.getIndexForTextureTarget(t->gl.target = GL_TEXTURE_CUBE_MAP);
@@ -727,6 +736,7 @@ void OpenGLDriver::framebufferTexture(backend::TargetBufferInfo const& binfo,
         GLenum target = GL_TEXTURE_2D;
         switch (t->target) {
             case SamplerType::SAMPLER_2D:
+            case SamplerType::SAMPLER_2D_ARRAY:
                 // this could be GL_TEXTURE_2D_MULTISAMPLE or GL_TEXTURE_2D_ARRAY
                 target = t->gl.target;
                 // note: multi-sampled textures can't have mipmaps
@@ -987,6 +997,17 @@ void OpenGLDriver::createFenceR(Handle<HwFence> fh, int) {
     f->fence = mPlatform.createFence();
 }
 
+void OpenGLDriver::createTimerQueryR(Handle<HwTimerQuery> tqh, int) {
+    DEBUG_MARKER()
+
+    GLTimerQuery* tq = construct<GLTimerQuery>(tqh);
+    tq->state = std::make_shared<GLTimerQuery::State>();
+    if (mContext.ext.EXT_disjoint_timer_query) {
+        glGenQueries(1, &tq->state->query);
+    }
+    CHECK_GL_ERROR(utils::slog.e)
+}
+
 void OpenGLDriver::createSwapChainR(Handle<HwSwapChain> sch, void* nativeWindow, uint64_t flags) {
     DEBUG_MARKER()
 
@@ -1146,6 +1167,20 @@ void OpenGLDriver::destroySwapChain(Handle<HwSwapChain> sch) {
     }
 }
 
+void OpenGLDriver::destroyTimerQuery(Handle<HwTimerQuery> tqh) {
+    DEBUG_MARKER()
+
+    if (tqh) {
+        GLTimerQuery* tq = handle_cast<GLTimerQuery*>(tqh);
+        if (tq->state->query) {
+            glDeleteQueries(1, &tq->state->query);
+            // a pending read-back must not use this query name anymore
+            tq->state->query = 0;
+        }
+        destruct(tqh, tq);
+    }
+}
+
 void OpenGLDriver::destroyStream(Handle<HwStream> sh) {
     DEBUG_MARKER()
 
@@ -1258,6 +1293,17 @@ void OpenGLDriver::destroyFence(Handle<HwFence> fh) {
     }
 }
 
+bool OpenGLDriver::getTimerQueryValue(Handle<HwTimerQuery> tqh, uint64_t* elapsedTime) {
+    GLTimerQuery* tq = handle_cast<GLTimerQuery*>(tqh);
+    // Each result is only returned once, so that a recycled query never reports a stale value.
+    const int64_t elapsed = tq->state->elapsed.exchange(-1, std::memory_order_relaxed);
+    if (elapsed < 0) {
+        return false;
+    }
+    *elapsedTime = uint64_t(elapsed);
+    return true;
+}
+
 FenceStatus OpenGLDriver::wait(Handle<HwFence> fh, uint64_t timeout) {
     if (fh) {
         HwFence* f = handle_cast<HwFence*>(fh);
@@ -1444,6 +1490,27 @@ void OpenGLDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescript
     scheduleDestroy(std::move(p));
 }
 
+void OpenGLDriver::updateUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& p,
+        uint32_t byteOffset) {
+    DEBUG_MARKER()
+
+    GLUniformBuffer* ub = handle_cast<GLUniformBuffer *>(ubh);
+    assert(ub);
+
+    // partial updates don't make sense with STREAM buffers, which are orphaned on each update
+    assert(ub->gl.ubo.usage != BufferUsage::STREAM);
+    assert(byteOffset + p.size <= ub->gl.ubo.capacity);
+
+    auto& gl = mContext;
+    if (p.size > 0) {
+        gl.bindBuffer(GL_UNIFORM_BUFFER, ub->gl.ubo.id);
+        glBufferSubData(GL_UNIFORM_BUFFER, byteOffset, p.size, p.buffer);
+    }
+    scheduleDestroy(std::move(p));
+
+    CHECK_GL_ERROR(utils::slog.e)
+}
+
 void OpenGLDriver::updateBuffer(GLenum target,
         GLBuffer* buffer, BufferDescriptor const& p, uint32_t alignment) noexcept {
     assert(buffer->capacity >= p.size);
@@ -1602,6 +1669,7 @@ void OpenGLDriver::setTextureData(GLTexture* t,
             // but it's not supported, so instead, we behave like a texture2d.
             // fallthrough...
         case SamplerType::SAMPLER_2D:
+        case SamplerType::SAMPLER_2D_ARRAY:
             // NOTE: GL_TEXTURE_2D_MULTISAMPLE is not allowed
             bindTexture(OpenGLContext::MAX_TEXTURE_UNIT_COUNT - 1, t);
             gl.activeTexture(OpenGLContext::MAX_TEXTURE_UNIT_COUNT - 1);
@@ -1684,6 +1752,7 @@ void OpenGLDriver::setCompressedTextureData(GLTexture* t,
             // but it's not supported, so instead, we behave like a texture2d.
             // fallthrough...
         case SamplerType::SAMPLER_2D:
+        case SamplerType::SAMPLER_2D_ARRAY:
             // NOTE: GL_TEXTURE_2D_MULTISAMPLE is not allowed
             bindTexture(OpenGLContext::MAX_TEXTURE_UNIT_COUNT - 1, t);
             gl.activeTexture(OpenGLContext::MAX_TEXTURE_UNIT_COUNT - 1);
@@ -2482,6 +2551,47 @@ void OpenGLDriver::popGroupMarker(int) {
 #endif
 }
 
+void OpenGLDriver::beginTimerQuery(Handle<HwTimerQuery> tqh) {
+    DEBUG_MARKER()
+#ifdef GL_TIME_ELAPSED
+    GLTimerQuery* tq = handle_cast<GLTimerQuery*>(tqh);
+    if (tq->state->query) {
+        glBeginQuery(GL_TIME_ELAPSED, tq->state->query);
+        CHECK_GL_ERROR(utils::slog.e)
+    }
+#endif
+}
+
+void OpenGLDriver::endTimerQuery(Handle<HwTimerQuery> tqh) {
+    DEBUG_MARKER()
+#ifdef GL_TIME_ELAPSED
+    GLTimerQuery* tq = handle_cast<GLTimerQuery*>(tqh);
+    if (tq->state->query) {
+        glEndQuery(GL_TIME_ELAPSED);
+        CHECK_GL_ERROR(utils::slog.e)
+
+        // The result is read back once the GPU is done with the current commands, this way we
+        // never stall on glGetQueryObject.
+        whenGpuCommandsComplete([state = tq->state]() {
+            if (!state->query) {
+                return; // the query was destroyed in the meantime
+            }
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(state->query, GL_QUERY_RESULT, &elapsed);
+#ifdef GL_GPU_DISJOINT_EXT
+            // with EXT_disjoint_timer_query, results are meaningless after a disjoint operation
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            if (disjoint) {
+                return;
+            }
+#endif
+            state->elapsed.store(int64_t(elapsed), std::memory_order_relaxed);
+        });
+    }
+#endif
+}
+
 // ------------------------------------------------------------------------------------------------
 // Read-back ops
 // ------------------------------------------------------------------------------------------------
@@ -28,6 +28,8 @@
 
 #include <tsl/robin_map.h>
 
+#include <atomic>
+#include <memory>
 #include <set>
 
 #include <assert.h>
@@ -178,6 +180,17 @@ public:
         } gl;
     };
 
+    struct GLTimerQuery : public backend::HwTimerQuery {
+        // The state is shared with the callback that reads back the result once the GPU is done,
+        // which can happen after the query is destroyed. The result is written on the driver
+        // thread and consumed on the user thread, -1 means no result is available.
+        struct State {
+            GLuint query = 0;
+            std::atomic<int64_t> elapsed{ -1 };
+        };
+        std::shared_ptr<State> state;
+    };
+
     OpenGLDriver(OpenGLDriver const&) = delete;
     OpenGLDriver& operator=(OpenGLDriver const&) = delete;
 
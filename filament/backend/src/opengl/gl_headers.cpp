@@ -42,6 +42,9 @@ PFNGLFRAMEBUFFERTEXTURE2DMULTISAMPLEEXTPROC glFramebufferTexture2DMultisampleEXT
 PFNGLDEBUGMESSAGECALLBACKKHRPROC glDebugMessageCallbackKHR;
 PFNGLGETDEBUGMESSAGELOGKHRPROC glGetDebugMessageLogKHR;
 #endif
+#ifdef GL_EXT_disjoint_timer_query
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT;
+#endif
 
 static std::once_flag sGlExtInitialized;
 
@@ -91,6 +94,11 @@ void importGLESExtensionsEntryPoints() {
         glGetDebugMessageLogKHR =
                 (PFNGLGETDEBUGMESSAGELOGKHRPROC)eglGetProcAddress(
                         "glGetDebugMessageLogKHR");
+#endif
+#ifdef GL_EXT_disjoint_timer_query
+        glGetQueryObjectui64vEXT =
+                (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress(
+                        "glGetQueryObjectui64vEXT");
 #endif
     });
 }
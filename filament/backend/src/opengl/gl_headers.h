@@ -47,6 +47,9 @@
 #ifdef GL_KHR_debug
         extern PFNGLDEBUGMESSAGECALLBACKKHRPROC glDebugMessageCallbackKHR;
         extern PFNGLGETDEBUGMESSAGELOGKHRPROC glGetDebugMessageLogKHR;
+#endif
+#ifdef GL_EXT_disjoint_timer_query
+        extern PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT;
 #endif
     }
 
@@ -69,6 +72,11 @@
 
     #define glDebugMessageCallback            glext::glDebugMessageCallbackKHR
 
+#ifdef GL_EXT_disjoint_timer_query
+    #define GL_TIME_ELAPSED                   GL_TIME_ELAPSED_EXT
+    #define glGetQueryObjectui64v             glext::glGetQueryObjectui64vEXT
+#endif
+
     using namespace glext;
 
 #elif defined(IOS)
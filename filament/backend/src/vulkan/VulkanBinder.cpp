@@ -78,6 +78,7 @@ bool VulkanBinder::getOrCreateDescriptors(VkDescriptorSet descriptors[2],
         descriptors[0] = mCurrentDescriptor->handles[0];
         descriptors[1] = mCurrentDescriptor->handles[1];
         mCurrentDescriptor->timestamp = mCurrentTime;
+        *pipelineLayout = mPipelineLayout;
         return false;
     }
 
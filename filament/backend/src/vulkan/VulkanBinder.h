@@ -116,11 +116,13 @@ public:
     // mutate their copy and pass it back through bindRasterState().
     const RasterState& getDefaultRasterState() const { return mDefaultRasterState; }
 
-    // Returns true if vkCmdBindDescriptorSets is required.
+    // Returns true if vkCmdBindDescriptorSets is required. The descriptors and the pipeline layout
+    // are always returned.
     bool getOrCreateDescriptors(VkDescriptorSet descriptors[2], VkPipelineLayout* pipelineLayout)
             noexcept;
 
     // Returns true if any pipeline bindings have changed. (i.e., vkCmdBindPipeline is required)
+    // The pipeline is always returned.
     bool getOrCreatePipeline(VkPipeline* pipeline) noexcept;
 
     // Each bind method is fast and does not make Vulkan calls.
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vulkan/VulkanCommandRecorder.h"
+
+#include <utils/JobSystem.h>
+#include <utils/Panic.h>
+#include <utils/Systrace.h>
+
+#include <algorithm>
+
+#include <string.h>
+
+namespace filament {
+namespace backend {
+
+VulkanCommandRecorder::VulkanCommandRecorder(VulkanContext& context) noexcept
+        : mContext(context) {
+}
+
+VulkanCommandRecorder::~VulkanCommandRecorder() noexcept {
+    assert(mWorkers.empty());
+}
+
+void VulkanCommandRecorder::initialize() {
+    // Leave a core for the engine's main thread and one for the driver thread.
+    const uint32_t cores = std::thread::hardware_concurrency();
+    const uint32_t count = std::min(MAX_WORKER_COUNT, cores > 2 ? cores - 2 : 0);
+    mWorkers.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        mWorkers.emplace_back(&VulkanCommandRecorder::loop, this, i);
+    }
+}
+
+void VulkanCommandRecorder::terminate() noexcept {
+    std::unique_lock<utils::Mutex> lock(mLock);
+    mExitRequested = true;
+    lock.unlock();
+    mWorkCondition.notify_all();
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+    mWorkers.clear();
+
+    for (auto& entry : mPools) {
+        for (VulkanThreadCommandPool& pool : entry.second) {
+            destroyThreadCommandPool(mContext, pool);
+        }
+    }
+    mPools.clear();
+}
+
+VulkanCommandRecorder::PoolSet& VulkanCommandRecorder::getPoolSet(VkCommandBuffer primary) {
+    PoolSet& pools = mPools[primary];
+    if (pools.empty()) {
+        pools.resize(mWorkers.size() + 1);
+        for (VulkanThreadCommandPool& pool : pools) {
+            createThreadCommandPool(mContext, pool);
+        }
+    }
+    return pools;
+}
+
+void VulkanCommandRecorder::beginFrame(VkCommandBuffer primary) {
+    if (mWorkers.empty()) {
+        return;
+    }
+    auto iter = mPools.find(primary);
+    if (iter != mPools.end()) {
+        for (VulkanThreadCommandPool& pool : iter->second) {
+            resetThreadCommandPool(mContext, pool);
+        }
+    }
+}
+
+void VulkanCommandRecorder::releaseFrame(VkCommandBuffer primary) noexcept {
+    auto iter = mPools.find(primary);
+    if (iter != mPools.end()) {
+        for (VulkanThreadCommandPool& pool : iter->second) {
+            destroyThreadCommandPool(mContext, pool);
+        }
+        mPools.erase(iter);
+    }
+}
+
+void VulkanCommandRecorder::recordRenderPass(VkCommandBuffer primary,
+        VkRenderPassBeginInfo const& renderPassInfo,
+        VkViewport const& viewport, VkRect2D const& scissor,
+        VulkanDrawCall const* calls, size_t count, VulkanStateTracker& tracker) {
+    const uint32_t chunkCount = (uint32_t) std::min(size_t(mWorkers.size() + 1),
+            count / MIN_DRAWS_PER_THREAD);
+
+    if (chunkCount < 2) {
+        vkCmdBeginRenderPass(primary, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdSetScissor(primary, 0, 1, &scissor);
+        vkCmdSetViewport(primary, 0, 1, &viewport);
+        recordDrawCalls(primary, tracker, calls, count);
+        vkCmdEndRenderPass(primary);
+        return;
+    }
+
+    SYSTRACE_CALL();
+
+    // Acquire all secondary command buffers here, since the pools can't be accessed from another
+    // thread while the workers are running. Chunk i is recorded with pool i.
+    PoolSet& pools = getPoolSet(primary);
+    const size_t countPerChunk = (count + chunkCount - 1) / chunkCount;
+    VkCommandBuffer secondaries[MAX_WORKER_COUNT + 1];
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        const size_t first = i * countPerChunk;
+        Chunk& chunk = mChunks[i];
+        chunk.cmdbuffer = secondaries[i] = acquireSecondaryCommandBuffer(mContext, pools[i]);
+        chunk.calls = calls + first;
+        chunk.count = std::min(countPerChunk, count - first);
+        chunk.stats = {};
+    }
+
+    // Secondary command buffers don't inherit any dynamic state, so each of them needs the
+    // viewport. The scissor is set by the first draw call of each chunk.
+    std::unique_lock<utils::Mutex> lock(mLock);
+    mInheritanceInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .renderPass = renderPassInfo.renderPass,
+        .subpass = 0,
+        .framebuffer = renderPassInfo.framebuffer
+    };
+    mViewport = viewport;
+    mActiveWorkerCount = chunkCount - 1;
+    mPendingCount = chunkCount - 1;
+    mGeneration++;
+    lock.unlock();
+    mWorkCondition.notify_all();
+
+    // The driver thread records the first chunk while the workers take care of the others.
+    recordChunk(mChunks[0]);
+
+    lock.lock();
+    mDoneCondition.wait(lock, [this]() { return mPendingCount == 0; });
+    lock.unlock();
+
+    vkCmdBeginRenderPass(primary, &renderPassInfo,
+            VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    vkCmdExecuteCommands(primary, chunkCount, secondaries);
+    vkCmdEndRenderPass(primary);
+
+    for (uint32_t i = 0; i < chunkCount; i++) {
+        tracker.addStats(mChunks[i].stats);
+    }
+
+    // After vkCmdExecuteCommands, the bindings of the primary command buffer are undefined.
+    tracker.reset(primary);
+}
+
+void VulkanCommandRecorder::recordChunk(Chunk& chunk) const noexcept {
+    const VkCommandBufferBeginInfo beginInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+        .pInheritanceInfo = &mInheritanceInfo
+    };
+    VkResult result = vkBeginCommandBuffer(chunk.cmdbuffer, &beginInfo);
+    ASSERT_POSTCONDITION(result == VK_SUCCESS, "vkBeginCommandBuffer error.");
+    vkCmdSetViewport(chunk.cmdbuffer, 0, 1, &mViewport);
+
+    VulkanStateTracker tracker;
+    tracker.reset(chunk.cmdbuffer);
+    recordDrawCalls(chunk.cmdbuffer, tracker, chunk.calls, chunk.count);
+    chunk.stats = tracker.getStats();
+
+    result = vkEndCommandBuffer(chunk.cmdbuffer);
+    ASSERT_POSTCONDITION(result == VK_SUCCESS, "vkEndCommandBuffer error.");
+}
+
+void VulkanCommandRecorder::recordDrawCalls(VkCommandBuffer cmdbuffer,
+        VulkanStateTracker& tracker, VulkanDrawCall const* calls, size_t count) noexcept {
+    VkRect2D scissor = {};
+    for (size_t i = 0; i < count; i++) {
+        VulkanDrawCall const& call = calls[i];
+        if (i == 0 || memcmp(&scissor, &call.scissor, sizeof(VkRect2D)) != 0) {
+            scissor = call.scissor;
+            vkCmdSetScissor(cmdbuffer, 0, 1, &scissor);
+        }
+        tracker.bindDescriptorSets(call.pipelineLayout, call.descriptors);
+        tracker.bindPipeline(call.pipeline);
+        tracker.bindVertexBuffers(call.vertexBufferCount,
+                call.vertexBuffers, call.vertexBufferOffsets);
+        tracker.bindIndexBuffer(call.indexBuffer, call.indexType);
+        const uint32_t instanceCount = 1;
+        const int32_t vertexOffset = 0;
+        const uint32_t firstInstId = 1;
+        vkCmdDrawIndexed(cmdbuffer, call.indexCount, instanceCount, call.firstIndex,
+                vertexOffset, firstInstId);
+    }
+}
+
+void VulkanCommandRecorder::loop(uint32_t index) {
+    utils::JobSystem::setThreadName("VkRecorder");
+    uint32_t generation = 0;
+    std::unique_lock<utils::Mutex> lock(mLock);
+    while (true) {
+        mWorkCondition.wait(lock, [this, generation]() {
+            return mExitRequested || mGeneration != generation;
+        });
+        if (mExitRequested) {
+            return;
+        }
+        generation = mGeneration;
+        if (index >= mActiveWorkerCount) {
+            continue;
+        }
+
+        // worker i records chunk i + 1, chunk 0 is recorded by the driver thread
+        Chunk& chunk = mChunks[index + 1];
+        lock.unlock();
+        recordChunk(chunk);
+        lock.lock();
+        if (--mPendingCount == 0) {
+            mDoneCondition.notify_one();
+        }
+    }
+}
+
+} // namespace backend
+} // namespace filament
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DRIVER_VULKANCOMMANDRECORDER_H
+#define TNT_FILAMENT_DRIVER_VULKANCOMMANDRECORDER_H
+
+#include "VulkanContext.h"
+#include "VulkanStateTracker.h"
+
+#include <bluevk/BlueVK.h>
+
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
+
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace filament {
+namespace backend {
+
+// A fully resolved draw call. VulkanDriver::draw() does all the work that touches the binder and
+// the caches on the driver thread, and stores the result here so that the Vulkan commands can be
+// recorded later, possibly on another thread.
+struct VulkanDrawCall {
+    static constexpr uint32_t MAX_VERTEX_BUFFER_COUNT = VulkanStateTracker::MAX_VERTEX_BUFFER_COUNT;
+    VkPipeline pipeline;
+    VkPipelineLayout pipelineLayout;
+    VkDescriptorSet descriptors[2];
+    VkRect2D scissor;
+    VkBuffer indexBuffer;
+    VkIndexType indexType;
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    uint32_t vertexBufferCount;
+    VkBuffer vertexBuffers[MAX_VERTEX_BUFFER_COUNT];
+    VkDeviceSize vertexBufferOffsets[MAX_VERTEX_BUFFER_COUNT];
+};
+
+// VulkanCommandRecorder records the draw calls of a render pass. Small passes are recorded inline
+// into the primary command buffer. Large passes are split into chunks which are recorded in
+// parallel into secondary command buffers, one per worker thread, and then executed from the
+// primary command buffer.
+//
+// Each worker owns a command pool per primary command buffer (i.e. per swap chain image), so that
+// a pool is only reset after the GPU is done with the frame that used it.
+class VulkanCommandRecorder {
+public:
+    // Below this number of draw calls per thread, it's not worth using secondary command buffers.
+    static constexpr uint32_t MIN_DRAWS_PER_THREAD = 128;
+
+    // Upper bound on the number of worker threads, the driver thread records the first chunk.
+    static constexpr uint32_t MAX_WORKER_COUNT = 3;
+
+    explicit VulkanCommandRecorder(VulkanContext& context) noexcept;
+    ~VulkanCommandRecorder() noexcept;
+
+    VulkanCommandRecorder(VulkanCommandRecorder const&) = delete;
+    VulkanCommandRecorder& operator=(VulkanCommandRecorder const&) = delete;
+
+    // Spawns the worker threads, must be called after the device has been created.
+    void initialize();
+
+    // Joins the worker threads and destroys all command pools, must be called before the device
+    // is destroyed.
+    void terminate() noexcept;
+
+    // Recycles the secondary command buffers associated with the given primary command buffer.
+    // Must be called once the previous submission of that command buffer has finished.
+    void beginFrame(VkCommandBuffer primary);
+
+    // Destroys the command pools associated with the given primary command buffer. Must be called
+    // before that command buffer is freed, once the GPU is done with it, since a new command
+    // buffer could later be allocated with the same handle.
+    void releaseFrame(VkCommandBuffer primary) noexcept;
+
+    // Begins the render pass, records all the given draw calls and ends the render pass.
+    // The tracker is used for inline recording, and receives the stats of the workers.
+    void recordRenderPass(VkCommandBuffer primary, VkRenderPassBeginInfo const& renderPassInfo,
+            VkViewport const& viewport, VkRect2D const& scissor,
+            VulkanDrawCall const* calls, size_t count, VulkanStateTracker& tracker);
+
+    // Records the draw calls into the given command buffer, which must be within a render pass.
+    static void recordDrawCalls(VkCommandBuffer cmdbuffer, VulkanStateTracker& tracker,
+            VulkanDrawCall const* calls, size_t count) noexcept;
+
+private:
+    // per primary command buffer, one pool for the driver thread followed by one per worker
+    using PoolSet = std::vector<VulkanThreadCommandPool>;
+
+    struct Chunk {
+        VkCommandBuffer cmdbuffer = VK_NULL_HANDLE;
+        VulkanDrawCall const* calls = nullptr;
+        size_t count = 0;
+        VulkanStateTracker::Stats stats;
+    };
+
+    PoolSet& getPoolSet(VkCommandBuffer primary);
+    void recordChunk(Chunk& chunk) const noexcept;
+    void loop(uint32_t index);
+
+    VulkanContext& mContext;
+    std::vector<std::thread> mWorkers;
+    std::unordered_map<VkCommandBuffer, PoolSet> mPools;
+
+    // state shared with the workers, protected by mLock
+    utils::Mutex mLock;
+    utils::Condition mWorkCondition;
+    utils::Condition mDoneCondition;
+    Chunk mChunks[MAX_WORKER_COUNT + 1];
+    VkCommandBufferInheritanceInfo mInheritanceInfo = {};
+    VkViewport mViewport = {};
+    uint32_t mGeneration = 0;
+    uint32_t mActiveWorkerCount = 0;
+    uint32_t mPendingCount = 0;
+    bool mExitRequested = false;
+};
+
+} // namespace backend
+} // namespace filament
+
+#endif // TNT_FILAMENT_DRIVER_VULKANCOMMANDRECORDER_H
@@ -634,5 +634,59 @@ void createDepthBuffer(VulkanContext& context, VulkanSurfaceContext& surfaceCont
     flushWorkCommandBuffer(context);
 }
 
+void createThreadCommandPool(VulkanContext& context, VulkanThreadCommandPool& pool) {
+    // Secondary command buffers are re-recorded every frame, hence the transient flag.
+    VkCommandPoolCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    createInfo.flags =
+            VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    createInfo.queueFamilyIndex = context.graphicsQueueFamilyIndex;
+    VkResult result = vkCreateCommandPool(context.device, &createInfo, VKALLOC, &pool.pool);
+    ASSERT_POSTCONDITION(result == VK_SUCCESS, "vkCreateCommandPool error.");
+    pool.buffers.clear();
+    pool.used = 0;
+}
+
+void destroyThreadCommandPool(VulkanContext& context, VulkanThreadCommandPool& pool) {
+    if (pool.pool == VK_NULL_HANDLE) {
+        return;
+    }
+    if (!pool.buffers.empty()) {
+        vkFreeCommandBuffers(context.device, pool.pool, (uint32_t) pool.buffers.size(),
+                pool.buffers.data());
+    }
+    vkDestroyCommandPool(context.device, pool.pool, VKALLOC);
+    pool.pool = VK_NULL_HANDLE;
+    pool.buffers.clear();
+    pool.used = 0;
+}
+
+// Resets all the command buffers allocated from the given pool so they can be re-recorded.
+// The caller is responsible for ensuring that none of them are still pending on the GPU.
+void resetThreadCommandPool(VulkanContext& context, VulkanThreadCommandPool& pool) {
+    if (pool.used > 0) {
+        VkResult result = vkResetCommandPool(context.device, pool.pool, 0);
+        ASSERT_POSTCONDITION(result == VK_SUCCESS, "vkResetCommandPool error.");
+    }
+    pool.used = 0;
+}
+
+VkCommandBuffer acquireSecondaryCommandBuffer(VulkanContext& context,
+        VulkanThreadCommandPool& pool) {
+    if (pool.used == pool.buffers.size()) {
+        const VkCommandBufferAllocateInfo allocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = pool.pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1
+        };
+        VkCommandBuffer cmdbuffer;
+        VkResult result = vkAllocateCommandBuffers(context.device, &allocateInfo, &cmdbuffer);
+        ASSERT_POSTCONDITION(result == VK_SUCCESS, "vkAllocateCommandBuffers error.");
+        pool.buffers.push_back(cmdbuffer);
+    }
+    return pool.buffers[pool.used++];
+}
+
 } // namespace filament
 } // namespace backend
@@ -65,6 +65,15 @@ struct VulkanCommandBuffer {
     VulkanDisposer::Set resources;
 };
 
+// Command pools are externally synchronized, so each thread that records secondary command
+// buffers needs its own pool. The buffers are recycled when the pool is reset, which must only
+// happen once the primary command buffer that executes them has finished on the GPU.
+struct VulkanThreadCommandPool {
+    VkCommandPool pool = VK_NULL_HANDLE;
+    std::vector<VkCommandBuffer> buffers;
+    uint32_t used = 0;
+};
+
 // For now we only support a single-device, single-instance scenario. Our concept of "context" is a
 // bundle of state containing the Device, the Instance, and various globally-useful Vulkan objects.
 struct VulkanContext {
@@ -139,6 +148,10 @@ VkFormat findSupportedFormat(VulkanContext& context, const std::vector<VkFormat>
 VkCommandBuffer acquireWorkCommandBuffer(VulkanContext& context);
 void flushWorkCommandBuffer(VulkanContext& context);
 void createDepthBuffer(VulkanContext& context, VulkanSurfaceContext& sc, VkFormat depthFormat);
+void createThreadCommandPool(VulkanContext& context, VulkanThreadCommandPool& pool);
+void destroyThreadCommandPool(VulkanContext& context, VulkanThreadCommandPool& pool);
+void resetThreadCommandPool(VulkanContext& context, VulkanThreadCommandPool& pool);
+VkCommandBuffer acquireSecondaryCommandBuffer(VulkanContext& context, VulkanThreadCommandPool& pool);
 
 } // namespace filament
 } // namespace backend
@@ -25,6 +25,7 @@
 
 #include <utils/Panic.h>
 #include <utils/CString.h>
+#include <utils/Systrace.h>
 #include <utils/trap.h>
 
 #include <set>
@@ -85,7 +86,8 @@ Driver* VulkanDriverFactory::create(VulkanPlatform* const platform,
 VulkanDriver::VulkanDriver(VulkanPlatform* platform,
         const char* const* ppEnabledExtensions, uint32_t enabledExtensionCount) noexcept :
         DriverBase(new ConcreteDispatcher<VulkanDriver>()),
-        mContextManager(*platform), mStagePool(mContext, mDisposer), mFramebufferCache(mContext),
+        mContextManager(*platform), mRecorder(mContext), mStagePool(mContext, mDisposer),
+        mFramebufferCache(mContext),
         mSamplerCache(mContext) {
     mContext.rasterState = mBinder.getDefaultRasterState();
 
@@ -173,12 +175,16 @@ VulkanDriver::VulkanDriver(VulkanPlatform* platform,
     // Initialize device and graphicsQueue.
     createVirtualDevice(mContext);
     mBinder.setDevice(mContext.device);
+    mRecorder.initialize();
 
     // Choose a depth format that meets our requirements. Take care not to include stencil formats
     // just yet, since that would require a corollary change to the "aspect" flags for the VkImage.
     mContext.depthFormat = findSupportedFormat(mContext,
         { VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32 },
         VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+    // Timer queries are implemented with timestamps, which are optional on some mobile devices.
+    mTimestampsSupported = mContext.physicalDeviceProperties.limits.timestampComputeAndGraphics;
 }
 
 VulkanDriver::~VulkanDriver() noexcept = default;
@@ -238,6 +244,13 @@ void VulkanDriver::terminate() {
     mBinder.destroyCache();
     mFramebufferCache.reset();
     mSamplerCache.reset();
+    mRecorder.terminate();
+
+    for (VkQueryPool pool : mTimestampPools) {
+        vkDestroyQueryPool(mContext.device, pool, VKALLOC);
+    }
+    mTimestampPools.clear();
+    mFreeTimerQueries.clear();
 
     vmaDestroyAllocator(mContext.allocator);
     vkDestroyCommandPool(mContext.device, mContext.commandPool, VKALLOC);
@@ -267,6 +280,7 @@ void VulkanDriver::beginFrame(int64_t monotonic_clock_ns, uint32_t frameId,
 
     acquireSwapCommandBuffer(mContext);
     mDisposer.release(mContext.currentCommands->resources);
+    mRecorder.beginFrame(mContext.currentCommands->cmdbuffer);
 
     // vkCmdBindPipeline and vkCmdBindDescriptorSets establish bindings to a specific command
     // buffer; they are not global to the device. Since VulkanBinder doesn't have context about the
@@ -279,6 +293,7 @@ void VulkanDriver::beginFrame(int64_t monotonic_clock_ns, uint32_t frameId,
     // of allowing us to safely mutate descriptor sets. For now we're avoiding that strategy in the
     // interest of maintaining a small memory footprint.
     mBinder.resetBindings();
+    mStateTracker.reset(mContext.currentCommands->cmdbuffer);
 
     // Free old unused objects.
     mStagePool.gc();
@@ -416,7 +431,8 @@ void VulkanDriver::createRenderTargetR(Handle<HwRenderTarget> rth,
     auto colorTexture = color.handle ? handle_cast<VulkanTexture>(mHandleMap, color.handle) : nullptr;
     auto depthTexture = depth.handle ? handle_cast<VulkanTexture>(mHandleMap, depth.handle) : nullptr;
     auto renderTarget = construct_handle<VulkanRenderTarget>(mHandleMap, rth, mContext,
-            width, height, color.level, colorTexture, depth.level, depthTexture);
+            width, height, color.level, color.layer, colorTexture,
+            depth.level, depth.layer, depthTexture);
     mDisposer.createDisposable(renderTarget, [this, rth] () {
         destruct_handle<VulkanRenderTarget>(mHandleMap, rth);
     });
@@ -428,6 +444,48 @@ void VulkanDriver::destroyRenderTarget(Handle<HwRenderTarget> rth) {
     }
 }
 
+bool VulkanDriver::growTimerQueryPools() {
+    if (!mTimestampsSupported) {
+        return false;
+    }
+    const uint32_t first = uint32_t(mTimestampPools.size()) * TIMER_QUERIES_PER_POOL;
+    if (first >= MAX_TIMER_QUERIES) {
+        if (!mTimerQueriesExhausted) {
+            mTimerQueriesExhausted = true;
+            utils::slog.w << "Out of timer queries, " << MAX_TIMER_QUERIES
+                    << " are in use. New queries won't report a result." << utils::io::endl;
+        }
+        return false;
+    }
+    const VkQueryPoolCreateInfo queryPoolInfo {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = TIMER_QUERIES_PER_POOL * 2,
+    };
+    VkQueryPool pool;
+    VkResult result = vkCreateQueryPool(mContext.device, &queryPoolInfo, VKALLOC, &pool);
+    ASSERT_POSTCONDITION(result == VK_SUCCESS, "vkCreateQueryPool error.");
+    mTimestampPools.push_back(pool);
+    for (uint32_t i = first + TIMER_QUERIES_PER_POOL; i > first; i--) {
+        mFreeTimerQueries.push_back(i - 1);
+    }
+    return true;
+}
+
+void VulkanDriver::createTimerQueryR(Handle<HwTimerQuery> tqh, int) {
+    // When we run out of timestamps (or they're not supported), the query never has a result.
+    if (mFreeTimerQueries.empty() && !growTimerQueryPools()) {
+        construct_handle<VulkanTimerQuery>(mHandleMap, tqh,
+                VkQueryPool(VK_NULL_HANDLE), VulkanTimerQuery::INVALID_INDEX, 0u);
+        return;
+    }
+    const uint32_t index = mFreeTimerQueries.back();
+    mFreeTimerQueries.pop_back();
+    construct_handle<VulkanTimerQuery>(mHandleMap, tqh,
+            mTimestampPools[index / TIMER_QUERIES_PER_POOL], index,
+            (index % TIMER_QUERIES_PER_POOL) * 2);
+}
+
 void VulkanDriver::createFenceR(Handle<HwFence> fh, int) {
     // We prefer the fence to be created inside a frame, otherwise there's no command buffer.
     assert(mContext.currentCommands != nullptr && "Fences should be created within a frame.");
@@ -505,6 +563,10 @@ Handle<HwFence> VulkanDriver::createFenceS() noexcept {
     return alloc_handle<VulkanFence, HwFence>();
 }
 
+Handle<HwTimerQuery> VulkanDriver::createTimerQueryS() noexcept {
+    return alloc_handle<VulkanTimerQuery, HwTimerQuery>();
+}
+
 Handle<HwSwapChain> VulkanDriver::createSwapChainS() noexcept {
     return alloc_handle<VulkanSwapChain, HwSwapChain>();
 }
@@ -539,6 +601,7 @@ void VulkanDriver::destroySwapChain(Handle<HwSwapChain> sch) {
         waitForIdle(mContext);
         for (SwapContext& swapContext : surfaceContext.swapContexts) {
             mDisposer.release(swapContext.commands.resources);
+            mRecorder.releaseFrame(swapContext.commands.cmdbuffer);
             vkFreeCommandBuffers(mContext.device, mContext.commandPool, 1,
                     &swapContext.commands.cmdbuffer);
             swapContext.commands.fence.reset();
@@ -585,6 +648,51 @@ int64_t VulkanDriver::getStreamTimestamp(Handle<HwStream> sh) {
 void VulkanDriver::updateStreams(CommandStream* driver) {
 }
 
+void VulkanDriver::destroyTimerQuery(Handle<HwTimerQuery> tqh) {
+    if (tqh) {
+        auto* tq = handle_cast<VulkanTimerQuery>(mHandleMap, tqh);
+        if (tq->index != VulkanTimerQuery::INVALID_INDEX) {
+            mFreeTimerQueries.push_back(tq->index);
+            mTimerQueriesExhausted = false;
+        }
+        destruct_handle<VulkanTimerQuery>(mHandleMap, tqh);
+    }
+}
+
+bool VulkanDriver::getTimerQueryValue(Handle<HwTimerQuery> tqh, uint64_t* elapsedTime) {
+    auto* tq = handle_cast<VulkanTimerQuery>(mHandleMap, tqh);
+    std::unique_lock<utils::Mutex> lock(tq->mutex);
+    if (!tq->fence) {
+        return false;
+    }
+
+    // Only read the timestamps once the command buffer has completed, otherwise we could read
+    // the results of a previous use of the query.
+    std::shared_ptr<VulkanCmdFence> cmdfence = tq->fence;
+    {
+        std::unique_lock<utils::Mutex> fenceLock(cmdfence->mutex);
+        if (!cmdfence->submitted) {
+            return false;
+        }
+    }
+    if (vkGetFenceStatus(mContext.device, cmdfence->fence) != VK_SUCCESS) {
+        return false;
+    }
+
+    uint64_t timestamps[2];
+    VkResult result = vkGetQueryPoolResults(mContext.device, tq->pool, tq->slot, 2,
+            sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        return false;
+    }
+
+    // Each result is only returned once, so that a recycled query never reports a stale value.
+    tq->fence.reset();
+    const float period = mContext.physicalDeviceProperties.limits.timestampPeriod;
+    *elapsedTime = uint64_t(double(timestamps[1] - timestamps[0]) * period);
+    return true;
+}
+
 void VulkanDriver::destroyFence(Handle<HwFence> fh) {
     destruct_handle<VulkanFence>(mHandleMap, fh);
 }
@@ -706,7 +814,16 @@ bool VulkanDriver::canGenerateMipmaps() {
 void VulkanDriver::loadUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& data) {
     if (data.size > 0) {
         auto* buffer = handle_cast<VulkanUniformBuffer>(mHandleMap, ubh);
-        buffer->loadFromCpu(data.buffer, (uint32_t) data.size);
+        buffer->loadFromCpu(data.buffer, 0, (uint32_t) data.size);
+        scheduleDestroy(std::move(data));
+    }
+}
+
+void VulkanDriver::updateUniformBuffer(Handle<HwUniformBuffer> ubh, BufferDescriptor&& data,
+        uint32_t byteOffset) {
+    if (data.size > 0) {
+        auto* buffer = handle_cast<VulkanUniformBuffer>(mHandleMap, ubh);
+        buffer->loadFromCpu(data.buffer, byteOffset, (uint32_t) data.size);
         scheduleDestroy(std::move(data));
     }
 }
@@ -721,7 +838,6 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
     assert(mContext.currentCommands);
     assert(mContext.currentSurface);
     VulkanSurfaceContext& surface = *mContext.currentSurface;
-    const SwapContext& swapContext = surface.swapContexts[surface.currentSwapIndex];
     mCurrentRenderTarget = handle_cast<VulkanRenderTarget>(mHandleMap, rth);
     VulkanRenderTarget* rt = mCurrentRenderTarget;
     const VkExtent2D extent = rt->getExtent();
@@ -788,7 +904,7 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
 
     rt->transformClientRectToPlatform(&renderPassInfo.renderArea);
 
-    VkClearValue clearValues[2] = {};
+    VkClearValue* clearValues = mPendingRenderPass.clearValues;
     if (hasColor) {
         VkClearValue& clearValue = clearValues[renderPassInfo.clearValueCount++];
         clearValue.color.float32[0] = params.clearColor.r;
@@ -802,9 +918,6 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
     }
     renderPassInfo.pClearValues = &clearValues[0];
 
-    vkCmdBeginRenderPass(swapContext.commands.cmdbuffer, &renderPassInfo,
-            VK_SUBPASS_CONTENTS_INLINE);
-
     VkViewport viewport = mContext.viewport = {
             .x = (float) params.viewport.left,
             .y = (float) params.viewport.bottom,
@@ -819,10 +932,13 @@ void VulkanDriver::beginRenderPass(Handle<HwRenderTarget> rth, const RenderPassP
     };
 
     mCurrentRenderTarget->transformClientRectToPlatform(&scissor);
-    vkCmdSetScissor(swapContext.commands.cmdbuffer, 0, 1, &scissor);
-
     mCurrentRenderTarget->transformClientRectToPlatform(&viewport);
-    vkCmdSetViewport(swapContext.commands.cmdbuffer, 0, 1, &viewport);
+
+    // Nothing is recorded yet, see endRenderPass().
+    mPendingRenderPass.info = renderPassInfo;
+    mPendingRenderPass.viewport = viewport;
+    mPendingRenderPass.scissor = scissor;
+    mDrawCalls.clear();
 
     mContext.currentRenderPass = renderPassInfo;
 }
@@ -831,7 +947,10 @@ void VulkanDriver::endRenderPass(int) {
     assert(mContext.currentCommands);
     assert(mContext.currentSurface);
     assert(mCurrentRenderTarget);
-    vkCmdEndRenderPass(mContext.currentCommands->cmdbuffer);
+    mRecorder.recordRenderPass(mContext.currentCommands->cmdbuffer, mPendingRenderPass.info,
+            mPendingRenderPass.viewport, mPendingRenderPass.scissor,
+            mDrawCalls.data(), mDrawCalls.size(), mStateTracker);
+    mDrawCalls.clear();
     mCurrentRenderTarget = VK_NULL_HANDLE;
     mContext.currentRenderPass.renderPass = VK_NULL_HANDLE;
 }
@@ -868,10 +987,24 @@ void VulkanDriver::makeCurrent(Handle<HwSwapChain> drawSch, Handle<HwSwapChain>
 }
 
 void VulkanDriver::commit(Handle<HwSwapChain> sch) {
+    SYSTRACE_CONTEXT();
+
     // Tell Vulkan we're done appending to the command buffer.
     ASSERT_POSTCONDITION(mContext.currentCommands,
             "Vulkan driver requires at least one frame before a commit.");
 
+    // Report how many binds were filtered out by the state tracker during this frame.
+    UTILS_UNUSED VulkanStateTracker::Stats const& stats = mStateTracker.getStats();
+    SYSTRACE_VALUE32("vk.pipelineBinds", stats.pipelineBinds);
+    SYSTRACE_VALUE32("vk.pipelineSkips", stats.pipelineSkips);
+    SYSTRACE_VALUE32("vk.descriptorBinds", stats.descriptorBinds);
+    SYSTRACE_VALUE32("vk.descriptorSkips", stats.descriptorSkips);
+    SYSTRACE_VALUE32("vk.vertexBufferBinds", stats.vertexBufferBinds);
+    SYSTRACE_VALUE32("vk.vertexBufferSkips", stats.vertexBufferSkips);
+    SYSTRACE_VALUE32("vk.indexBufferBinds", stats.indexBufferBinds);
+    SYSTRACE_VALUE32("vk.indexBufferSkips", stats.indexBufferSkips);
+    mStateTracker.resetStats();
+
     // Finalize the command buffer and set the cmdbuffer pointer to null.
     VkResult result = vkEndCommandBuffer(mContext.currentCommands->cmdbuffer);
     ASSERT_POSTCONDITION(result == VK_SUCCESS, "vkEndCommandBuffer error.");
@@ -943,6 +1076,8 @@ void VulkanDriver::pushGroupMarker(char const* string,  size_t len) {
     constexpr float MARKER_COLOR[] = { 0.0f, 1.0f, 0.0f, 1.0f };
     ASSERT_POSTCONDITION(mContext.currentCommands,
             "Markers can only be inserted within a beginFrame / endFrame.");
+    // Note that draw calls are only recorded in endRenderPass(), so markers issued within a
+    // render pass end up right before it in the command buffer.
     if (mContext.debugMarkersSupported) {
         VkDebugMarkerMarkerInfoEXT markerInfo = {};
         markerInfo.sType = VK_STRUCTURE_TYPE_DEBUG_MARKER_MARKER_INFO_EXT;
@@ -960,6 +1095,32 @@ void VulkanDriver::popGroupMarker(int) {
     }
 }
 
+void VulkanDriver::beginTimerQuery(Handle<HwTimerQuery> tqh) {
+    ASSERT_POSTCONDITION(mContext.currentCommands,
+            "Timer queries can only be issued within a beginFrame / endFrame.");
+    auto* tq = handle_cast<VulkanTimerQuery>(mHandleMap, tqh);
+    if (tq->index == VulkanTimerQuery::INVALID_INDEX) {
+        return;
+    }
+    VkCommandBuffer cmdbuffer = mContext.currentCommands->cmdbuffer;
+    vkCmdResetQueryPool(cmdbuffer, tq->pool, tq->slot, 2);
+    vkCmdWriteTimestamp(cmdbuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, tq->pool, tq->slot);
+}
+
+void VulkanDriver::endTimerQuery(Handle<HwTimerQuery> tqh) {
+    ASSERT_POSTCONDITION(mContext.currentCommands,
+            "Timer queries can only be issued within a beginFrame / endFrame.");
+    auto* tq = handle_cast<VulkanTimerQuery>(mHandleMap, tqh);
+    if (tq->index == VulkanTimerQuery::INVALID_INDEX) {
+        return;
+    }
+    VkCommandBuffer cmdbuffer = mContext.currentCommands->cmdbuffer;
+    vkCmdWriteTimestamp(cmdbuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, tq->pool,
+            tq->slot + 1);
+    std::unique_lock<utils::Mutex> lock(tq->mutex);
+    tq->fence = mContext.currentCommands->fence;
+}
+
 void VulkanDriver::startCapture(int) {
 
 }
@@ -1049,7 +1210,6 @@ void VulkanDriver::blit(TargetBufferFlags buffers,
 void VulkanDriver::draw(PipelineState pipelineState, Handle<HwRenderPrimitive> rph) {
     VulkanCommandBuffer* commands = mContext.currentCommands;
     ASSERT_POSTCONDITION(commands, "Draw calls can occur only within a beginFrame / endFrame.");
-    VkCommandBuffer cmdbuffer = commands->cmdbuffer;
     const VulkanRenderPrimitive& prim = *handle_cast<VulkanRenderPrimitive>(mHandleMap, rph);
 
     Handle<HwProgram> programHandle = pipelineState.program;
@@ -1174,44 +1334,41 @@ void VulkanDriver::draw(PipelineState pipelineState, Handle<HwRenderPrimitive> r
             .extent = { (uint32_t)right - x, (uint32_t)top - y }
     };
     rt->transformClientRectToPlatform(&scissor);
-    vkCmdSetScissor(cmdbuffer, 0, 1, &scissor);
-
-    // Bind new descriptor sets if they need to change.
-    VkDescriptorSet descriptors[2];
-    VkPipelineLayout pipelineLayout;
-    if (mBinder.getOrCreateDescriptors(descriptors, &pipelineLayout)) {
-        vkCmdBindDescriptorSets(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 2,
-                descriptors, 0, nullptr);
-    }
-
-    // Bind the pipeline if it changed. This can happen, for example, if the raster state changed.
-    // Creating a new pipeline is slow, so we should consider using pipeline cache objects.
-    VkPipeline pipeline;
-    if (mBinder.getOrCreatePipeline(&pipeline)) {
-        vkCmdBindPipeline(cmdbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
-    }
-
-    // Next bind the vertex buffers and index buffer. One potential performance improvement is to
-    // avoid rebinding these if they are already bound, but since we do not (yet) support subranges
-    // it would be rare for a client to make consecutive draw calls with the same render primitive.
-    vkCmdBindVertexBuffers(cmdbuffer, 0, (uint32_t) prim.buffers.size(),
-            prim.buffers.data(), prim.offsets.data());
-    vkCmdBindIndexBuffer(cmdbuffer, prim.indexBuffer->buffer->getGpuBuffer(), 0,
-            prim.indexBuffer->indexType);
 
-    // Finally, make the actual draw call. TODO: support subranges
-    const uint32_t indexCount = prim.count;
-    const uint32_t instanceCount = 1;
-    const uint32_t firstIndex = prim.offset / prim.indexBuffer->elementSize;
-    const int32_t vertexOffset = 0;
-    const uint32_t firstInstId = 1;
-    vkCmdDrawIndexed(cmdbuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstId);
+    // Resolve the descriptor sets and the pipeline now, since the binder and its caches can only
+    // be used from the driver thread. The state tracker will filter out the binds that wouldn't
+    // change anything, e.g. when the binder's state was modified and then restored between two
+    // draw calls. Creating a new pipeline is slow, so we should consider using pipeline caches.
+    mDrawCalls.emplace_back();
+    VulkanDrawCall& call = mDrawCalls.back();
+    call.scissor = scissor;
+    mBinder.getOrCreateDescriptors(call.descriptors, &call.pipelineLayout);
+    mBinder.getOrCreatePipeline(&call.pipeline);
+
+    // The vertex and index buffers are skipped when consecutive draw calls use the same render
+    // primitive (or primitives sharing the same buffers).
+    const uint32_t bufferCount = (uint32_t) prim.buffers.size();
+    ASSERT_PRECONDITION(bufferCount <= VulkanDrawCall::MAX_VERTEX_BUFFER_COUNT,
+            "Too many vertex buffers: count = %d, capacity = %d.",
+            bufferCount, VulkanDrawCall::MAX_VERTEX_BUFFER_COUNT);
+    call.vertexBufferCount = bufferCount;
+    std::copy_n(prim.buffers.data(), bufferCount, call.vertexBuffers);
+    std::copy_n(prim.offsets.data(), bufferCount, call.vertexBufferOffsets);
+    call.indexBuffer = prim.indexBuffer->buffer->getGpuBuffer();
+    call.indexType = prim.indexBuffer->indexType;
+
+    // The draw call itself is recorded in endRenderPass(). TODO: support subranges
+    call.indexCount = prim.count;
+    call.firstIndex = prim.offset / prim.indexBuffer->elementSize;
 }
 
 #ifndef NDEBUG
 void VulkanDriver::debugCommand(const char* methodName) {
     static const std::set<utils::StaticString> OUTSIDE_COMMANDS = {
         "loadUniformBuffer",
+        "updateUniformBuffer",
+        "beginTimerQuery",
+        "endTimerQuery",
         "updateVertexBuffer",
         "updateIndexBuffer",
         "update2DImage",
@@ -18,11 +18,13 @@
 #define TNT_FILAMENT_DRIVER_VULKANDRIVER_H
 
 #include "VulkanBinder.h"
+#include "VulkanCommandRecorder.h"
 #include "VulkanDisposer.h"
 #include "VulkanContext.h"
 #include "VulkanFboCache.h"
 #include "VulkanSamplerCache.h"
 #include "VulkanStagePool.h"
+#include "VulkanStateTracker.h"
 #include "VulkanUtility.h"
 
 #include "private/backend/Driver.h"
@@ -145,6 +147,8 @@ private:
 
     VulkanContext mContext = {};
     VulkanBinder mBinder;
+    VulkanStateTracker mStateTracker;
+    VulkanCommandRecorder mRecorder;
     VulkanDisposer mDisposer;
     VulkanStagePool mStagePool;
     VulkanFboCache mFramebufferCache;
@@ -152,6 +156,28 @@ private:
     VulkanRenderTarget* mCurrentRenderTarget = nullptr;
     VulkanSamplerGroup* mSamplerBindings[VulkanBinder::SAMPLER_BINDING_COUNT] = {};
     VkDebugReportCallbackEXT mDebugCallback = VK_NULL_HANDLE;
+
+    // The render pass is begun in endRenderPass(), once all of its draw calls are known, so that
+    // large passes can be recorded in parallel into secondary command buffers.
+    struct PendingRenderPass {
+        VkRenderPassBeginInfo info;
+        VkClearValue clearValues[2];
+        VkViewport viewport;
+        VkRect2D scissor;
+    };
+    PendingRenderPass mPendingRenderPass = {};
+    std::vector<VulkanDrawCall> mDrawCalls;
+
+    // Pools of timestamps used by timer queries, each query uses two consecutive entries.
+    // The renderer times up to 32 passes per frame and keeps them for up to ~10 frames, so pools
+    // are allocated on demand, TIMER_QUERIES_PER_POOL queries at a time, up to MAX_TIMER_QUERIES.
+    static constexpr uint32_t TIMER_QUERIES_PER_POOL = 128;
+    static constexpr uint32_t MAX_TIMER_QUERIES = TIMER_QUERIES_PER_POOL * 8;
+    bool growTimerQueryPools();
+    bool mTimestampsSupported = false;
+    bool mTimerQueriesExhausted = false;
+    std::vector<VkQueryPool> mTimestampPools;
+    std::vector<uint32_t> mFreeTimerQueries;
 };
 
 } // namespace backend
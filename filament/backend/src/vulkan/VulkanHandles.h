@@ -45,8 +45,10 @@ struct VulkanTexture;
 struct VulkanRenderTarget : private HwRenderTarget {
 
     // Creates an offscreen render target.
-    VulkanRenderTarget(VulkanContext& context, uint32_t w, uint32_t h, uint32_t colorLevel,
-            VulkanTexture* color, uint32_t depthLevel, VulkanTexture* depth);
+    // For array textures, the layer selects which layer of the texture is rendered into.
+    VulkanRenderTarget(VulkanContext& context, uint32_t w, uint32_t h,
+            uint32_t colorLevel, uint32_t colorLayer, VulkanTexture* color,
+            uint32_t depthLevel, uint32_t depthLayer, VulkanTexture* depth);
 
     // Creates a special "default" render target (i.e. associated with the swap chain)
     explicit VulkanRenderTarget(VulkanContext& context) : HwRenderTarget(0, 0), mContext(context),
@@ -96,7 +98,7 @@ struct VulkanUniformBuffer : public HwUniformBuffer {
     VulkanUniformBuffer(VulkanContext& context, VulkanStagePool& stagePool, uint32_t numBytes,
             backend::BufferUsage usage);
     ~VulkanUniformBuffer();
-    void loadFromCpu(const void* cpuData, uint32_t numBytes);
+    void loadFromCpu(const void* cpuData, uint32_t byteOffset, uint32_t numBytes);
     VkBuffer getGpuBuffer() const { return mGpuBuffer; }
 private:
     VulkanContext& mContext;
@@ -160,6 +162,21 @@ struct VulkanFence : public HwFence {
     std::shared_ptr<VulkanCmdFence> fence;
 };
 
+// A timer query uses a pair of consecutive timestamps in one of the driver's query pools, index is
+// the query's global index and slot its first timestamp within the pool. The fence of the command
+// buffer that wrote them tells us when the result can be read back; it is set on the driver thread
+// and consumed on the user thread, hence the mutex.
+struct VulkanTimerQuery : public HwTimerQuery {
+    VulkanTimerQuery(VkQueryPool pool, uint32_t index, uint32_t slot)
+            : pool(pool), index(index), slot(slot) {}
+    static constexpr uint32_t INVALID_INDEX = ~0u;
+    const VkQueryPool pool;
+    const uint32_t index;
+    const uint32_t slot;
+    utils::Mutex mutex;
+    std::shared_ptr<VulkanCmdFence> fence;
+};
+
 } // namespace filament
 } // namespace backend
 
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vulkan/VulkanStateTracker.h"
+
+#include <utils/Panic.h>
+
+#include <algorithm>
+
+namespace filament {
+namespace backend {
+
+void VulkanStateTracker::reset(VkCommandBuffer cmdbuffer) noexcept {
+    mCmdBuffer = cmdbuffer;
+    mPipeline = VK_NULL_HANDLE;
+    mPipelineLayout = VK_NULL_HANDLE;
+    mDescriptors[0] = VK_NULL_HANDLE;
+    mDescriptors[1] = VK_NULL_HANDLE;
+    mVertexBufferCount = 0;
+    mIndexBuffer = VK_NULL_HANDLE;
+}
+
+bool VulkanStateTracker::bindPipeline(VkPipeline pipeline) noexcept {
+    if (mPipeline == pipeline) {
+        mStats.pipelineSkips++;
+        return false;
+    }
+    mPipeline = pipeline;
+    mStats.pipelineBinds++;
+    vkCmdBindPipeline(mCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    return true;
+}
+
+bool VulkanStateTracker::bindDescriptorSets(VkPipelineLayout layout,
+        VkDescriptorSet const descriptors[2]) noexcept {
+    if (mPipelineLayout == layout &&
+            mDescriptors[0] == descriptors[0] && mDescriptors[1] == descriptors[1]) {
+        mStats.descriptorSkips++;
+        return false;
+    }
+    mPipelineLayout = layout;
+    mDescriptors[0] = descriptors[0];
+    mDescriptors[1] = descriptors[1];
+    mStats.descriptorBinds++;
+    vkCmdBindDescriptorSets(mCmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 2,
+            descriptors, 0, nullptr);
+    return true;
+}
+
+bool VulkanStateTracker::bindVertexBuffers(uint32_t count,
+        VkBuffer const* buffers, VkDeviceSize const* offsets) noexcept {
+    ASSERT_PRECONDITION(count <= MAX_VERTEX_BUFFER_COUNT,
+            "Too many vertex buffers: count = %d, capacity = %d.",
+            count, MAX_VERTEX_BUFFER_COUNT);
+    if (mVertexBufferCount == count &&
+            std::equal(buffers, buffers + count, mVertexBuffers) &&
+            std::equal(offsets, offsets + count, mVertexBufferOffsets)) {
+        mStats.vertexBufferSkips++;
+        return false;
+    }
+    mVertexBufferCount = count;
+    std::copy_n(buffers, count, mVertexBuffers);
+    std::copy_n(offsets, count, mVertexBufferOffsets);
+    mStats.vertexBufferBinds++;
+    vkCmdBindVertexBuffers(mCmdBuffer, 0, count, buffers, offsets);
+    return true;
+}
+
+bool VulkanStateTracker::bindIndexBuffer(VkBuffer buffer, VkIndexType indexType) noexcept {
+    if (mIndexBuffer == buffer && mIndexType == indexType) {
+        mStats.indexBufferSkips++;
+        return false;
+    }
+    mIndexBuffer = buffer;
+    mIndexType = indexType;
+    mStats.indexBufferBinds++;
+    vkCmdBindIndexBuffer(mCmdBuffer, buffer, 0, indexType);
+    return true;
+}
+
+} // namespace backend
+} // namespace filament
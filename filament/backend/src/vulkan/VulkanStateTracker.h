@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DRIVER_VULKANSTATETRACKER_H
+#define TNT_FILAMENT_DRIVER_VULKANSTATETRACKER_H
+
+#include "VulkanBinder.h"
+
+#include <bluevk/BlueVK.h>
+
+namespace filament {
+namespace backend {
+
+// VulkanStateTracker remembers what was last bound into a command buffer and filters out
+// vkCmdBind* calls that would not change anything. This is common because RenderPass sorts its
+// commands by material, so consecutive draws often share the same pipeline and descriptor sets,
+// and draws of the same primitive share the same vertex and index buffers.
+//
+// The tracker must be reset whenever the command buffer changes, since bindings are not shared
+// across command buffers.
+class VulkanStateTracker {
+public:
+    static constexpr uint32_t MAX_VERTEX_BUFFER_COUNT = VulkanBinder::VERTEX_ATTRIBUTE_COUNT;
+
+    struct Stats {
+        uint32_t pipelineBinds = 0;
+        uint32_t pipelineSkips = 0;
+        uint32_t descriptorBinds = 0;
+        uint32_t descriptorSkips = 0;
+        uint32_t vertexBufferBinds = 0;
+        uint32_t vertexBufferSkips = 0;
+        uint32_t indexBufferBinds = 0;
+        uint32_t indexBufferSkips = 0;
+    };
+
+    // Forgets all bindings, the next bind calls will all be issued.
+    void reset(VkCommandBuffer cmdbuffer) noexcept;
+
+    // Each of these issues the corresponding vkCmdBind* only if the state differs from what is
+    // currently bound. They return true if a Vulkan call was made.
+    bool bindPipeline(VkPipeline pipeline) noexcept;
+    bool bindDescriptorSets(VkPipelineLayout layout, VkDescriptorSet const descriptors[2]) noexcept;
+    bool bindVertexBuffers(uint32_t count,
+            VkBuffer const* buffers, VkDeviceSize const* offsets) noexcept;
+    bool bindIndexBuffer(VkBuffer buffer, VkIndexType indexType) noexcept;
+
+    Stats const& getStats() const noexcept { return mStats; }
+    void resetStats() noexcept { mStats = {}; }
+
+    // Accumulates the stats of a tracker used on another thread, e.g. for a secondary buffer.
+    void addStats(Stats const& rhs) noexcept {
+        mStats.pipelineBinds += rhs.pipelineBinds;
+        mStats.pipelineSkips += rhs.pipelineSkips;
+        mStats.descriptorBinds += rhs.descriptorBinds;
+        mStats.descriptorSkips += rhs.descriptorSkips;
+        mStats.vertexBufferBinds += rhs.vertexBufferBinds;
+        mStats.vertexBufferSkips += rhs.vertexBufferSkips;
+        mStats.indexBufferBinds += rhs.indexBufferBinds;
+        mStats.indexBufferSkips += rhs.indexBufferSkips;
+    }
+
+private:
+    VkCommandBuffer mCmdBuffer = VK_NULL_HANDLE;
+    VkPipeline mPipeline = VK_NULL_HANDLE;
+    VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
+    VkDescriptorSet mDescriptors[2] = {};
+    uint32_t mVertexBufferCount = 0;
+    VkBuffer mVertexBuffers[MAX_VERTEX_BUFFER_COUNT] = {};
+    VkDeviceSize mVertexBufferOffsets[MAX_VERTEX_BUFFER_COUNT] = {};
+    VkBuffer mIndexBuffer = VK_NULL_HANDLE;
+    VkIndexType mIndexType = VK_INDEX_TYPE_UINT16;
+    Stats mStats;
+};
+
+} // namespace backend
+} // namespace filament
+
+#endif // TNT_FILAMENT_DRIVER_VULKANSTATETRACKER_H
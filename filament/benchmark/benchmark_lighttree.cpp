@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PerformanceCounters.h"
+
+#include <benchmark/benchmark.h>
+
+#include "details/LightTree.h"
+
+#include <math/scalar.h>
+#include <math/vec4.h>
+
+#include <vector>
+#include <random>
+
+#include <math.h>
+
+using namespace filament;
+using namespace filament::details;
+using namespace filament::math;
+
+class LightTreeFixture : public benchmark::Fixture {
+protected:
+    // similar to the froxel grid of a 1080p viewport
+    static constexpr size_t FROXEL_COUNT_X = 24;
+    static constexpr size_t FROXEL_COUNT_Y = 14;
+    static constexpr size_t FROXEL_COUNT_Z = 16;
+    static constexpr float Z_NEAR = 5.0f;
+    static constexpr float Z_FAR = 100.0f;
+
+    std::vector<float4> froxels;
+    std::vector<float4> lights;
+    LightTree tree;
+
+public:
+    void SetUp(const ::benchmark::State& state) override {
+        const float tanHalfFov = std::tan(float(F_PI / 8.0));   // 45 degrees fov
+
+        // bounding spheres of the froxels, with exponentially distributed slices
+        froxels.clear();
+        for (size_t iz = 0; iz < FROXEL_COUNT_Z; iz++) {
+            const float z0 = Z_NEAR * std::pow(Z_FAR / Z_NEAR, float(iz) / FROXEL_COUNT_Z);
+            const float z1 = Z_NEAR * std::pow(Z_FAR / Z_NEAR, float(iz + 1) / FROXEL_COUNT_Z);
+            const float z = (z0 + z1) * 0.5f;
+            const float2 halfSize = float2{ 16.0f / 9.0f, 1.0f } * (z1 * tanHalfFov);
+            const float2 cellSize = 2.0f * halfSize / float2{ FROXEL_COUNT_X, FROXEL_COUNT_Y };
+            const float radius = length(float3{ cellSize * 0.5f, (z1 - z0) * 0.5f });
+            for (size_t iy = 0; iy < FROXEL_COUNT_Y; iy++) {
+                for (size_t ix = 0; ix < FROXEL_COUNT_X; ix++) {
+                    const float2 xy = -halfSize + (float2{ ix, iy } + 0.5f) * cellSize;
+                    froxels.push_back({ xy, -z, radius });
+                }
+            }
+        }
+
+        // small lights scattered in the view frustum
+        std::default_random_engine gen; // NOLINT
+        std::uniform_real_distribution<float> rand(0.0f, 1.0f);
+        lights.resize(size_t(state.range(0)));
+        for (float4& light : lights) {
+            const float z = Z_NEAR + rand(gen) * (Z_FAR - Z_NEAR);
+            const float h = z * tanHalfFov;
+            light = {
+                    (rand(gen) * 2.0f - 1.0f) * h * (16.0f / 9.0f),
+                    (rand(gen) * 2.0f - 1.0f) * h,
+                    -z,
+                    0.5f + rand(gen) * 2.5f };
+        }
+
+        tree.build(lights.data(), lights.size());
+    }
+};
+
+BENCHMARK_DEFINE_F(LightTreeFixture, build)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            tree.build(lights.data(), lights.size());
+        }
+        benchmark::ClobberMemory();
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * lights.size());
+    }
+}
+
+BENCHMARK_DEFINE_F(LightTreeFixture, treeQuery)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            size_t count = 0;
+            for (float4 const& froxel : froxels) {
+                tree.intersect(froxel, [&count](LightTree::index_type) { count++; });
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * froxels.size());
+    }
+}
+
+BENCHMARK_DEFINE_F(LightTreeFixture, bruteForceQuery)(benchmark::State& state) {
+    {
+        PerformanceCounters pc(state);
+        for (auto _ : state) {
+            size_t count = 0;
+            for (float4 const& froxel : froxels) {
+                for (float4 const& light : lights) {
+                    const float3 d = light.xyz - froxel.xyz;
+                    const float r = light.w + froxel.w;
+                    count += dot(d, d) < r * r ? 1 : 0;
+                }
+            }
+            benchmark::DoNotOptimize(count);
+        }
+        pc.stop();
+        state.SetItemsProcessed(state.iterations() * froxels.size());
+    }
+}
+
+BENCHMARK_REGISTER_F(LightTreeFixture, build)->Arg(256)->Arg(1024)->Arg(4096);
+BENCHMARK_REGISTER_F(LightTreeFixture, treeQuery)->Arg(256)->Arg(1024)->Arg(4096);
+BENCHMARK_REGISTER_F(LightTreeFixture, bruteForceQuery)->Arg(256)->Arg(1024)->Arg(4096);
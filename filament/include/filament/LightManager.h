@@ -136,6 +136,10 @@ class FLightManager;
  *    On the other hand, a scene can contain hundreds of non overlapping lights without
  *    incurring a significant overhead.
  *
+ * @warning At most 256 point and spot lights can be visible at once. A scene can contain many
+ * more, and they are all culled against the view, but past 256 visible lights, the ones farthest
+ * from the camera plane are dropped and don't light the scene.
+ *
  */
 class UTILS_PUBLIC LightManager : public FilamentAPI {
     struct BuilderDetails;
@@ -172,6 +176,14 @@ public:
         SPOT,           //!< Physically correct spot light.
     };
 
+    //! How the view frustum is split between the shadow cascades of a directional light.
+    enum class CascadeSplitScheme : uint8_t {
+        UNIFORM,        //!< All cascades have the same depth.
+        LOGARITHMIC,    //!< The depth of cascades grows geometrically with the distance.
+        PRACTICAL,      //!< Blend of UNIFORM and LOGARITHMIC, see ShadowOptions::cascadeSplitLambda.
+        CUSTOM,         //!< Splits are set by ShadowOptions::cascadeSplitPositions.
+    };
+
     /**
      * Control the quality / performance of the shadow map associated to this light
      */
@@ -232,6 +244,31 @@ public:
          * Setting this value correctly is essential for LISPSM shadow-maps.
          */
         float polygonOffsetSlope = 2.0f;
+
+        /**
+         * Number of shadow cascades to use for directional lights, between 1 and 4.
+         * The view frustum, from the camera near plane to shadowFar, is split in as many slices
+         * and each slice gets its own mapSize x mapSize shadow map, stored in a texture array.
+         * This gives much more resolution close to the camera than a single shadow map with
+         * the same number of texels.
+         */
+        uint8_t shadowCascades = 1;
+
+        /** How the view frustum is split between the cascades. */
+        CascadeSplitScheme cascadeSplitScheme = CascadeSplitScheme::PRACTICAL;
+
+        /**
+         * Used with CascadeSplitScheme::PRACTICAL, blends between the uniform (0.0) and the
+         * logarithmic (1.0) split schemes.
+         */
+        float cascadeSplitLambda = 0.5f;
+
+        /**
+         * Used with CascadeSplitScheme::CUSTOM, positions of the splits between cascades as a
+         * fraction of the distance between the camera near plane and shadowFar. Values must be
+         * increasing and between 0 and 1. Only the first shadowCascades - 1 values are used.
+         */
+        float cascadeSplitPositions[3] = { 0.125f, 0.25f, 0.50f };
     };
 
     //! Use Builder to construct a Light object instance
@@ -250,6 +250,21 @@ public:
          */
         Builder& morphing(bool enable) noexcept;
 
+        /**
+         * Declares that the vertex positions of this renderable are quantized, i.e. normalized
+         * to [-1, 1] within the given box, typically with a normalized \c SHORT4 attribute.
+         *
+         * The renderer maps them back to model space by folding this transform into the
+         * world-from-model matrix, which costs nothing in the vertex shader. Normals and tangents
+         * are not affected. This can't be used with skinning or morphing.
+         *
+         * The bounding box of the renderable is still specified in model space.
+         *
+         * @param bounds the bounds the positions are normalized to, an empty box disables the
+         *               quantization (default).
+         */
+        Builder& positionQuantization(const Box& bounds) noexcept;
+
         /**
          * Sets an ordering index for blended primitives that all live at the same Z value.
          *
@@ -272,6 +287,8 @@ public:
          * it is first destroyed as if destroy(utils::Entity e) was called. In case of error,
          * the existing component is unmodified.
          *
+         * An Engine can hold at most 65535 Renderable components.
+         *
          * @exception utils::PostConditionPanic if a runtime error occurred, such as running out of
          *            memory or other resources.
          * @exception utils::PreConditionPanic if a parameter to a builder function was invalid.
@@ -376,6 +393,13 @@ public:
      */
     const Box& getAxisAlignedBoundingBox(Instance instance) const noexcept;
 
+    /**
+     * Gets the box the vertex positions are normalized to, empty if they are not quantized.
+     *
+     * \see Builder::positionQuantization()
+     */
+    const Box& getPositionQuantization(Instance instance) const noexcept;
+
     /**
      * Gets the immutable number of primitives in the given renderable.
      */
@@ -406,6 +430,9 @@ public:
     /**
      * Changes the active range of indices or topology for the given primitive.
      *
+     * A primitive with a count of zero is skipped entirely, which can be used to turn off
+     * parts of a renderable without rebuilding it.
+     *
      * \see Builder::geometry()
      */
     void setGeometryAt(Instance instance, size_t primitiveIndex,
@@ -26,6 +26,7 @@
 
 #include <backend/PresentCallable.h>
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace filament {
@@ -68,6 +69,49 @@ class PixelBufferDescriptor;
  */
 class UTILS_PUBLIC Renderer : public FilamentAPI {
 public:
+    /**
+     * GPU time spent in a single pass of a frame.
+     */
+    struct PassTiming {
+        const char* name;       //!< name of the pass, a static string owned by filament
+        float gpuTimeMs;        //!< time spent by the GPU executing this pass, in milliseconds
+    };
+
+    /**
+     * GPU timings of all the passes executed during a frame.
+     *
+     * @see getPassTimingReport()
+     */
+    struct PassTimingReport {
+        static constexpr size_t MAX_PASS_COUNT = 32;
+        uint32_t frameId;                   //!< frame these timings belong to
+        size_t count;                       //!< number of valid entries in passes
+        PassTiming passes[MAX_PASS_COUNT];  //!< timings, in execution order
+    };
+
+    /**
+     * CPU time spent in each phase of a frame, in milliseconds.
+     *
+     * Phases that run on the application thread are summed over all the Views rendered during
+     * the frame. Backend phases are measured on the render thread, excluding the time it spent
+     * waiting for commands.
+     *
+     * @see getFrameStatistics()
+     */
+    struct FrameStatistics {
+        static constexpr size_t MAX_FRAME_COUNT = 16; //!< number of frames kept in the history
+        uint32_t frameId;               //!< frame these statistics belong to
+        float scenePrepareMs;           //!< gathering the scene's renderables and lights
+        float cullingMs;                //!< camera and shadow culling, visibility partitioning
+        float froxelizationMs;          //!< assigning lights to froxels (runs in a job)
+        float commandGenerationMs;      //!< generating the render passes' commands
+        float commandSortMs;            //!< sorting the render passes' commands
+        float driverRecordingMs;        //!< recording the render passes into the command stream
+        float backendExecutionMs;       //!< executing the frame's commands on the render thread
+        float swapMs;                   //!< presenting the swap chain on the render thread
+        float cpuFrameMs;               //!< application thread, from beginFrame() to endFrame()
+    };
+
      /**
       * Get the Engine that created this Renderer.
       *
@@ -419,6 +463,37 @@ public:
      * getUserTime()
      */
     void resetUserTime();
+
+    /**
+     * Returns the GPU time spent in each pass of the most recent frame for which timings are
+     * available.
+     *
+     * GPU timings are measured asynchronously, so the report typically lags a few frames behind
+     * the current frame. A report with a count of zero is returned when no timings are available
+     * yet, or when the backend doesn't support timer queries.
+     *
+     * All the passes executed between beginFrame() and endFrame() are reported, including the
+     * passes of each View rendered during that frame. Passes beyond MAX_PASS_COUNT are ignored.
+     *
+     * @return The per-pass GPU timings of a recent frame.
+     */
+    PassTimingReport getPassTimingReport() const noexcept;
+
+    /**
+     * Retrieves the CPU phase breakdown of the most recent frames.
+     *
+     * Statistics are always collected, they're cheap enough to be enabled in production. A frame
+     * is available once the render thread is done with it, so the history typically lags a frame
+     * or two behind the current frame.
+     *
+     * @param out   Array of at least count FrameStatistics, filled with the most recent frame
+     *              first.
+     * @param count Maximum number of frames to retrieve, at most FrameStatistics::MAX_FRAME_COUNT
+     *              frames are available.
+     *
+     * @return The number of frames written into out.
+     */
+    size_t getFrameStatistics(FrameStatistics* out, size_t count) const noexcept;
 };
 
 } // namespace filament
@@ -111,11 +111,30 @@ public:
         float scaleRate = 0.125f;                       //!< rate at which the scale will change
         float targetFrameTimeMilli = 1000.0f / 60.0f;   //!< desired frame time, or budget.
         float headRoomRatio = 0.0f;                     //!< additional headroom for the GPU
-        uint8_t history = 9;                            //!< history size
+        uint8_t history = 9;                            //!< median filter size, 3 to 128 frames
         bool enabled = false;                           //!< enable or disable dynamic resolution
         bool homogeneousScaling = false;                //!< set to true to force homogeneous scaling
     };
 
+    /**
+     * Statistics about the dynamic resolution controller.
+     *
+     * Frame times are measured on the GPU when the backend supports timer queries, in which case
+     * they lag a few frames behind. Otherwise they're measured on the CPU, from the start of
+     * the frame to when the GPU is done with it.
+     *
+     * @see getDynamicResolutionStatistics
+     */
+    struct DynamicResolutionStatistics {
+        math::float2 scale = math::float2(1.0f);    //!< scale factors chosen for the last frame
+        float lastFrameTimeMilli = 0.0f;            //!< last frame time fed to the controller
+        float medianFrameTimeMilli = 0.0f;          //!< 50th percentile of the recent frame times
+        float p90FrameTimeMilli = 0.0f;             //!< 90th percentile of the recent frame times
+        float p99FrameTimeMilli = 0.0f;             //!< 99th percentile of the recent frame times
+        uint32_t sampleCount = 0;                   //!< number of recent frame times, up to 128
+        bool gpuFrameTime = false;                  //!< whether frame times come from the GPU
+    };
+
     enum class QualityLevel : int8_t {
         LOW,
         MEDIUM,
@@ -224,15 +243,19 @@ public:
     /**
      * Sets whether this view is rendered with or without a depth pre-pass.
      *
-     * NOTE: this setting is ignored and will be removed in future versions of Filament.
-     *
      * By default, the system picks the most appropriate strategy, this method lets the
-     * application override that strategy.
+     * application override that strategy. Currently the default is to not use a depth pre-pass.
      *
-     * When the depth pre-pass is enabled, the renderer will first draw all objects in the
+     * When the depth pre-pass is enabled, the renderer will first draw all opaque objects in the
      * depth buffer from front to back, and then draw the objects again but sorted to minimize
-     * state changes. With the depth pre-pass disabled, objects are drawn only once, but it may
-     * result in more state changes or more overdraw.
+     * state changes, with an equal depth test and without writing depth, so that each pixel is
+     * shaded only once. With the depth pre-pass disabled, objects are drawn only once, but it
+     * may result in more state changes or more overdraw.
+     *
+     * When ambient occlusion is enabled and multi-sampling is disabled, the depth pass used by
+     * ambient occlusion is rendered at full resolution and also used as the depth pre-pass, so
+     * the pre-pass is free. Ambient occlusion is still computed at the resolution set in
+     * AmbientOcclusionOptions, and upsampled with a depth-aware filter.
      *
      * The best strategy may depend on the scene and/or GPU.
      *
@@ -404,6 +427,53 @@ public:
      */
     void setShadowsEnabled(bool enabled) noexcept;
 
+    /**
+     * Statistics of the shadow map cache.
+     *
+     * @see setShadowCachingEnabled()
+     */
+    struct ShadowCacheStats {
+        uint32_t renderedFrameCount = 0;    //!< number of frames the shadow map was rendered
+        uint32_t cachedFrameCount = 0;      //!< number of frames the shadow map was reused
+    };
+
+    /**
+     * Enables or disables caching of the shadow map. Disabled by default.
+     *
+     * When enabled, the shadow map is only rendered again when the light's frustum or the
+     * visible shadow casters change. Shadow casters are considered changed when they're added,
+     * removed, transformed, or when their morphing weights or level of detail change. Skinned
+     * shadow casters are always considered changed.
+     *
+     * The light's frustum depends on the camera, so the shadow map is typically reused only
+     * while the camera doesn't move. ShadowOptions::stable helps with small camera motions
+     * since the light's frustum then only changes when the camera moves by a shadow texel.
+     *
+     * @param enabled true enables shadow map caching, false disables it.
+     *
+     * @warning Changes to the vertices, indices or materials of shadow casters are not detected,
+     *          invalidateShadowCache() must be called after such changes.
+     *
+     * @see invalidateShadowCache(), getShadowCacheStats(), LightManager::ShadowOptions::stable
+     */
+    void setShadowCachingEnabled(bool enabled) noexcept;
+
+    /**
+     * Forces the shadow map to be rendered again on the next frame.
+     *
+     * @see setShadowCachingEnabled()
+     */
+    void invalidateShadowCache() noexcept;
+
+    /**
+     * Returns how many times the shadow map was rendered or reused since it was created.
+     *
+     * @return A ShadowCacheStats structure.
+     *
+     * @see setShadowCachingEnabled()
+     */
+    ShadowCacheStats getShadowCacheStats() const noexcept;
+
     /**
      * Specifies an offscreen render target to render into.
      *
@@ -514,6 +584,15 @@ public:
      */
     DynamicResolutionOptions getDynamicResolutionOptions() const noexcept;
 
+    /**
+     * Returns the scale factors chosen by dynamic resolution for the last rendered frame, along
+     * with statistics about the recent frame times. When dynamic resolution is disabled,
+     * the scale is always 1.
+     *
+     * @return the dynamic resolution statistics of this view
+     */
+    DynamicResolutionStatistics getDynamicResolutionStatistics() const noexcept;
+
     /**
      * Sets the rendering quality for this view. Refer to RenderQuality for more
      * information about the different settings available.
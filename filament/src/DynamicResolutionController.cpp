@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "details/DynamicResolutionController.h"
+
+#include <utils/compiler.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace filament {
+namespace details {
+
+DynamicResolutionController::DynamicResolutionController() noexcept = default;
+
+void DynamicResolutionController::setOptions(DynamicResolutionOptions const& options) noexcept {
+    mOptions = options;
+    reset();
+}
+
+void DynamicResolutionController::reset() noexcept {
+    mHead = 0;
+    mCount = 0;
+    mIntegral = 0.0f;
+    mPreviousError = 0.0f;
+    mAreaScale = 1.0f;
+}
+
+float DynamicResolutionController::getLastFrameTime() const noexcept {
+    return mCount ? mHistory[(mHead + MAX_HISTORY - 1) % MAX_HISTORY] : 0.0f;
+}
+
+size_t DynamicResolutionController::getRecent(float* out, size_t n) const noexcept {
+    n = std::min(n, mCount);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = mHistory[(mHead + MAX_HISTORY - 1 - i) % MAX_HISTORY];
+    }
+    return n;
+}
+
+float DynamicResolutionController::getPercentile(float p) const noexcept {
+    std::array<float, MAX_HISTORY> sorted; // NOLINT -- it's initialized below
+    const size_t size = getRecent(sorted.data(), MAX_HISTORY);
+    if (!size) {
+        return 0.0f;
+    }
+    // nearest-rank percentile
+    const float clamped = std::min(std::max(p, 0.0f), 1.0f);
+    const size_t rank = std::min(size - 1, size_t(std::ceil(clamped * size)) - (clamped > 0));
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + size);
+    return sorted[rank];
+}
+
+float DynamicResolutionController::update(float frameTimeMilli) noexcept {
+    DynamicResolutionOptions const& options = mOptions;
+
+    mHistory[mHead] = frameTimeMilli;
+    mHead = (mHead + 1) % MAX_HISTORY;
+    mCount = std::min(mCount + 1, size_t(MAX_HISTORY));
+
+    if (UTILS_UNLIKELY(mCount < 3)) {
+        // don't make any decision if we don't have enough data
+        return mAreaScale;
+    }
+
+    // apply a median filter to get a good representation of the frame time of the last
+    // N frames.
+    std::array<float, MAX_HISTORY> median; // NOLINT -- it's initialized below
+    const size_t size = getRecent(median.data(), std::max(size_t(options.history), size_t(1)));
+    std::nth_element(median.begin(), median.begin() + size / 2, median.begin() + size);
+    const float filteredFrameTime = median[size / 2];
+
+    // error normalized by the target, positive when we have time to spare
+    const float target = options.targetFrameTimeMilli * (1.0f - options.headRoomRatio);
+    const float error = (target - filteredFrameTime) / target;
+
+    // the integral term is what holds the scale in steady state, clamp it to the range of
+    // scales we can actually apply to avoid wind-up.
+    const float minArea = options.minScale.x * options.minScale.y;
+    const float maxArea = options.maxScale.x * options.maxScale.y;
+    const float ki = options.scaleRate;
+    mIntegral += ki * error;
+    mIntegral = std::min(std::max(mIntegral, minArea - 1.0f), maxArea - 1.0f);
+
+    const float derivative = error - mPreviousError;
+    mPreviousError = error;
+
+    const float output = 1.0f + PROPORTIONAL_GAIN * error + mIntegral
+            + DERIVATIVE_GAIN * derivative;
+    mAreaScale = std::min(std::max(output, minArea), maxArea);
+    return mAreaScale;
+}
+
+} // namespace details
+} // namespace filament
@@ -353,16 +353,33 @@ void FEngine::prepare() {
     // UBOs that are visible only. It's not such a big issue because the actual upload() is
     // skipped is the UBO hasn't changed. Still we could have a lot of these.
     FEngine::DriverApi& driver = getDriverApi();
+
+    // All the modified uniforms are staged into a single command-stream allocation, instead of
+    // one allocation (and a full copy of the UBO) per material instance.
+    size_t size = 0;
+    for (auto& materialInstanceList : mMaterialInstances) {
+        for (auto& item : materialInstanceList.second) {
+            size += item->getUniformCommitSize();
+        }
+    }
+    for (auto& material : mMaterials) {
+        size += material->getDefaultInstance()->getUniformCommitSize();
+    }
+
+    char* staging = size ? static_cast<char*>(driver.allocate(size)) : nullptr;
+    UTILS_UNUSED_IN_RELEASE char const* const end = staging + size;
+
     for (auto& materialInstanceList : mMaterialInstances) {
         for (auto& item : materialInstanceList.second) {
-            item->commit(driver);
+            staging += item->commit(driver, staging);
         }
     }
 
     // Commit default material instances.
     for (auto& material : mMaterials) {
-        material->getDefaultInstance()->commit(driver);
+        staging += material->getDefaultInstance()->commit(driver, staging);
     }
+    assert(staging == end);
 }
 
 void FEngine::gc() {
@@ -781,7 +798,9 @@ void* FEngine::streamAlloc(size_t size, size_t alignment) noexcept {
 bool FEngine::execute() {
 
     // wait until we get command buffers to be executed (or thread exit requested)
+    const auto waitBegin = std::chrono::steady_clock::now();
     auto buffers = mCommandBufferQueue.waitForCommands();
+    mDriverIdleTime += std::chrono::steady_clock::now() - waitBegin;
     if (UTILS_UNLIKELY(buffers.empty())) {
         return false;
     }
@@ -119,7 +119,7 @@ public:
 
     duration getLastFrameTime() const noexcept {
         std::unique_lock<std::mutex> lock(mLock);
-        FrameInfo const& info = mFrameInfoHistory.front();
+        FrameInfo const& info = mFrameInfoHistory.back();
         return info.laps[FrameInfo::FINISH] - info.laps[FrameInfo::START];
     }
 
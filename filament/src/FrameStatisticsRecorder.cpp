@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "details/FrameStatisticsRecorder.h"
+
+#include "details/Engine.h"
+
+#include "private/backend/CommandStream.h"
+
+#include <algorithm>
+
+namespace filament {
+namespace details {
+
+using namespace backend;
+
+FrameStatisticsRecorder::FrameStatisticsRecorder(FEngine& engine) noexcept
+        : mEngine(engine) {
+}
+
+void FrameStatisticsRecorder::beginFrame(DriverApi& driver, uint32_t frameId) noexcept {
+    mPhases.fill({});
+    mFrameBegin = clock::now();
+    mFrameId = frameId;
+    mInFrame = true;
+
+    driver.queueCommand([this]() {
+        mBackend.begin = clock::now();
+        mBackend.idleAtBegin = mEngine.getDriverIdleTime();
+    });
+}
+
+void FrameStatisticsRecorder::beginSwap(DriverApi& driver) noexcept {
+    if (!mInFrame) {
+        return;
+    }
+    driver.queueCommand([this]() {
+        mBackend.swap = clock::now();
+        mBackend.idleAtSwap = mEngine.getDriverIdleTime();
+    });
+}
+
+void FrameStatisticsRecorder::endFrame(DriverApi& driver) noexcept {
+    if (!mInFrame) {
+        return;
+    }
+    mInFrame = false;
+
+    const uint32_t frameId = mFrameId;
+    driver.queueCommand([this, frameId]() {
+        BackendTimestamps const& backend = mBackend;
+        const clock::time_point end = clock::now();
+        const clock::duration idle = backend.idleAtSwap - backend.idleAtBegin;
+        const clock::duration execution = (backend.swap - backend.begin) - idle;
+        // we don't expect to wait for commands during the swap, since it's the last command
+        // of the frame.
+        publishBackendPhases(frameId,
+                toMilliseconds(std::max(execution, clock::duration::zero())),
+                toMilliseconds(end - backend.swap));
+    });
+
+    std::array<clock::duration, PHASE_COUNT> const& phases = mPhases;
+    FrameStatistics stats{};
+    stats.frameId             = frameId;
+    stats.scenePrepareMs      = toMilliseconds(phases[size_t(Phase::SCENE_PREPARE)]);
+    stats.cullingMs           = toMilliseconds(phases[size_t(Phase::CULLING)]);
+    stats.froxelizationMs     = toMilliseconds(phases[size_t(Phase::FROXELIZATION)]);
+    stats.commandGenerationMs = toMilliseconds(phases[size_t(Phase::COMMAND_GENERATION)]);
+    stats.commandSortMs       = toMilliseconds(phases[size_t(Phase::COMMAND_SORT)]);
+    stats.driverRecordingMs   = toMilliseconds(phases[size_t(Phase::DRIVER_RECORDING)]);
+    stats.cpuFrameMs          = toMilliseconds(clock::now() - mFrameBegin);
+    publishApplicationPhases(stats);
+}
+
+FrameStatisticsRecorder::Entry& FrameStatisticsRecorder::getEntry(uint32_t frameId) noexcept {
+    Entry& entry = mHistory[frameId % FrameStatistics::MAX_FRAME_COUNT];
+    if (entry.stats.frameId != frameId) {
+        entry = {};
+        entry.stats.frameId = frameId;
+    }
+    return entry;
+}
+
+void FrameStatisticsRecorder::publishApplicationPhases(FrameStatistics const& stats) noexcept {
+    std::lock_guard<std::mutex> guard(mLock);
+    Entry& entry = getEntry(stats.frameId);
+    const float backendExecutionMs = entry.stats.backendExecutionMs;
+    const float swapMs = entry.stats.swapMs;
+    entry.stats = stats;
+    entry.stats.backendExecutionMs = backendExecutionMs;
+    entry.stats.swapMs = swapMs;
+    entry.published |= APPLICATION_PHASES;
+}
+
+void FrameStatisticsRecorder::publishBackendPhases(uint32_t frameId,
+        float backendExecutionMs, float swapMs) noexcept {
+    std::lock_guard<std::mutex> guard(mLock);
+    Entry& entry = getEntry(frameId);
+    entry.stats.backendExecutionMs = backendExecutionMs;
+    entry.stats.swapMs = swapMs;
+    entry.published |= BACKEND_PHASES;
+}
+
+size_t FrameStatisticsRecorder::getHistory(FrameStatistics* out, size_t count) const noexcept {
+    std::array<FrameStatistics, FrameStatistics::MAX_FRAME_COUNT> complete; // NOLINT
+    size_t size = 0;
+    {
+        std::lock_guard<std::mutex> guard(mLock);
+        for (Entry const& entry : mHistory) {
+            if (entry.published == (APPLICATION_PHASES | BACKEND_PHASES)) {
+                complete[size++] = entry.stats;
+            }
+        }
+    }
+
+    // frame ids wrap around after ~800 days at 60 fps, we don't bother
+    std::sort(complete.begin(), complete.begin() + size,
+            [](FrameStatistics const& lhs, FrameStatistics const& rhs) {
+                return lhs.frameId > rhs.frameId;
+            });
+
+    count = std::min(count, size);
+    std::copy_n(complete.begin(), count, out);
+    return count;
+}
+
+} // namespace details
+} // namespace filament
@@ -24,7 +24,6 @@
 #include <filament/Viewport.h>
 
 #include <utils/Allocator.h>
-#include <utils/BinaryTreeArray.h>
 #include <utils/Systrace.h>
 
 #include <math/mat4.h>
@@ -534,8 +533,14 @@ void Froxelizer::froxelizeLights(FEngine& engine,
         CameraInfo const& UTILS_RESTRICT camera,
         const FScene::LightSoa& UTILS_RESTRICT lightData) noexcept {
     // note: this is called asynchronously
-    froxelizeLoop(engine, camera, lightData);
-    froxelizeAssignRecordsCompress();
+    const size_t lightCount = lightData.size() - FScene::DIRECTIONAL_LIGHTS_COUNT;
+    if (engine.debug.lighting.light_tree && lightCount >= LIGHT_TREE_MIN_LIGHT_COUNT) {
+        froxelizeLightTree(engine, camera, lightData);
+        froxelizeAssignRecordsFromLists();
+    } else {
+        froxelizeLoop(engine, camera, lightData);
+        froxelizeAssignRecordsCompress();
+    }
 
 #ifndef NDEBUG
     if (lightData.size()) {
@@ -749,6 +754,168 @@ out_of_memory:
     ;
 }
 
+void Froxelizer::froxelizeLightTree(FEngine& engine,
+        const CameraInfo& UTILS_RESTRICT camera,
+        const FScene::LightSoa& UTILS_RESTRICT lightData) noexcept {
+    SYSTRACE_CALL();
+
+    auto& lcm = engine.getLightManager();
+    auto const* UTILS_RESTRICT spheres      = lightData.data<FScene::POSITION_RADIUS>();
+    auto const* UTILS_RESTRICT directions   = lightData.data<FScene::DIRECTION>();
+    auto const* UTILS_RESTRICT instances    = lightData.data<FScene::LIGHT_INSTANCE>();
+
+    // The lights UBO, and therefore the record buffer, can't reference more than
+    // CONFIG_MAX_LIGHT_COUNT lights. FScene::prepareDynamicLights() already dropped the farthest
+    // ones, the larger index space of the light tree only matters once that limit is raised.
+    const size_t count = std::min(lightData.size() - FScene::DIRECTIONAL_LIGHTS_COUNT,
+            CONFIG_MAX_LIGHT_COUNT);
+    static_assert(CONFIG_MAX_LIGHT_COUNT <= LightTree::MAX_LIGHT_COUNT,
+            "the light tree can't reference all lights");
+
+    mLightParams.resize(count);
+    mLightSpheres.resize(count);
+    const mat3f& vn = camera.view.upperLeft();
+    for (size_t i = 0; i < count; i++) {
+        const size_t j = i + FScene::DIRECTIONAL_LIGHTS_COUNT;
+        FLightManager::Instance li = instances[j];
+        LightParams& light = mLightParams[i];
+        light = {
+                .position = (camera.view * float4{ spheres[j].xyz, 1 }).xyz, // to view-space
+                .cosSqr = lcm.getCosOuterSquared(li),   // spot only
+                .axis = vn * directions[j],             // spot only
+                .invSin = lcm.getSinInverse(li),        // spot only
+                .radius = spheres[j].w,
+        };
+        // lights fully behind LightFar don't light anything (z values are negative), a negative
+        // radius keeps them out of the tree.
+        const bool behindLightFar = light.position.z + light.radius < -mZLightFar;
+        mLightSpheres[i] = { light.position, behindLightFar ? -1.0f : light.radius };
+    }
+
+    mLightTree.build(mLightSpheres.data(), count);
+
+    mFroxelLightLists.resize(FROXEL_BUFFER_ENTRY_COUNT_MAX);
+
+    // each slice is processed by its own job, and writes its own record list
+    JobSystem& js = engine.getJobSystem();
+    auto parent = js.createJob();
+    for (size_t iz = 0, c = mFroxelCountZ; iz < c; iz++) {
+        js.run(jobs::createJob(js, parent, &Froxelizer::froxelizeSliceWithLightTree, this, iz));
+    }
+    js.runAndWait(parent);
+}
+
+void Froxelizer::froxelizeSliceWithLightTree(size_t iz) noexcept {
+    assert(iz < mSliceRecords.size());
+
+    LightParams const* const UTILS_RESTRICT lights = mLightParams.data();
+    float4 const* const UTILS_RESTRICT boundingSpheres = mBoundingSpheres;
+    FroxelLightList* const UTILS_RESTRICT lists = mFroxelLightLists.data();
+    std::vector<LightTree::index_type>& records = mSliceRecords[iz];
+    records.clear();
+
+    // We have a limitation of 255 spot + 255 point lights per froxel.
+    LightTree::index_type spots[255];
+
+    const size_t sliceSize = size_t(mFroxelCountX) * mFroxelCountY;
+    for (size_t fi = iz * sliceSize, fc = fi + sliceSize; fi < fc; fi++) {
+        const float4 froxel = boundingSpheres[fi];
+        const size_t offset = records.size();
+        size_t spotCount = 0;
+        mLightTree.intersect(froxel,
+                [&records, &spotCount, &spots, &froxel, lights, offset](LightTree::index_type l) {
+            LightParams const& light = lights[l];
+            if (light.invSin != std::numeric_limits<float>::infinity()) {
+                if (spotCount < 255 && sphereConeIntersectionFast(froxel,
+                        light.position, light.axis, light.invSin, light.cosSqr)) {
+                    spots[spotCount++] = l;
+                }
+            } else if (records.size() - offset < 255) {
+                records.push_back(l);
+            }
+        });
+        const size_t pointCount = records.size() - offset;
+        records.insert(records.end(), spots, spots + spotCount);
+        lists[fi] = { uint32_t(offset), uint8_t(pointCount), uint8_t(spotCount) };
+    }
+}
+
+void Froxelizer::froxelizeAssignRecordsFromLists() noexcept {
+
+    SYSTRACE_CALL();
+
+    FroxelEntry* const UTILS_RESTRICT froxels = mFroxelBufferUser.data();
+    RecordBufferType* const UTILS_RESTRICT froxelRecords = mRecordBufferUser.data();
+    FroxelLightList const* const UTILS_RESTRICT lists = mFroxelLightLists.data();
+
+    const size_t froxelCountX = mFroxelCountX;
+    const size_t sliceSize = froxelCountX * mFroxelCountY;
+    auto remap = [stride = sliceSize](size_t i) -> size_t {
+        if (SUPPORTS_REMAPPED_FROXELS) {
+            i = (i % stride) * FEngine::CONFIG_FROXEL_SLICE_COUNT + (i / stride);
+        }
+        return i;
+    };
+
+    auto getLights = [this, lists, sliceSize](size_t i) {
+        return mSliceRecords[i / sliceSize].data() + lists[i].offset;
+    };
+
+    auto sameLights = [lists, &getLights](size_t i, size_t j) {
+        FroxelLightList const& a = lists[i];
+        FroxelLightList const& b = lists[j];
+        return a.pointLightCount == b.pointLightCount && a.spotLightCount == b.spotLightCount &&
+               std::equal(getLights(i), getLights(i) + a.pointLightCount + a.spotLightCount,
+                       getLights(j));
+    };
+
+    size_t offset = 0;
+    for (size_t i = 0, c = getFroxelCount(); i < c; i++) {
+        FroxelLightList const& list = lists[i];
+        const size_t lightCount = list.pointLightCount + list.spotLightCount;
+        if (!lightCount) {
+            froxels[remap(i)].u32 = 0;
+            continue;
+        }
+
+        // reuse the records of the froxel on the left or of the one above, if they have the
+        // same lights. The tree is always traversed in the same order, so identical light sets
+        // produce identical lists.
+        if (i > 0 && sameLights(i, i - 1)) {
+            froxels[remap(i)].u32 = froxels[remap(i - 1)].u32;
+            continue;
+        }
+        if (i >= froxelCountX && sameLights(i, i - froxelCountX)) {
+            froxels[remap(i)].u32 = froxels[remap(i - froxelCountX)].u32;
+            continue;
+        }
+
+        if (UTILS_UNLIKELY(offset + lightCount >= RECORD_BUFFER_ENTRY_COUNT)) {
+#ifndef NDEBUG
+            slog.d << "out of space: " << i << ", at " << offset << io::endl;
+#endif
+            do {
+                froxels[remap(i++)].u32 = 0;
+            } while (i < c);
+            break;
+        }
+
+        LightTree::index_type const* const lights = getLights(i);
+        for (size_t k = 0; k < lightCount; k++) {
+            froxelRecords[offset + k] = RecordBufferType(lights[k]);
+        }
+
+        // note: initializer list for union cannot have more than one element
+        FroxelEntry entry;
+        entry.offset = uint16_t(offset);
+        entry.pointLightCount = list.pointLightCount;
+        entry.spotLightCount = list.spotLightCount;
+        froxels[remap(i)].u32 = entry.u32;
+
+        offset += lightCount;
+    }
+}
+
 static inline float2 project(mat4f const& p, float3 const& v) noexcept {
     const float vx = v[0];
     const float vy = v[1];
@@ -899,57 +1066,5 @@ void Froxelizer::froxelizePointAndSpotLight(
     }
 }
 
-/*
- *
- * lightTree            output the light tree structure there (must be large enough to hold a complete tree)
- * lightList            list if lights
- * lightData            scene's light data SoA
- * lightRecordsOffset   offset in the record buffer where to find the light list
- */
-void Froxelizer::computeLightTree(
-        LightTreeNode* lightTree,
-        utils::Slice<RecordBufferType> const& lightList,
-        const FScene::LightSoa& lightData,
-        size_t lightRecordsOffset) noexcept {
-
-    // number of lights in this record
-    const size_t count = lightList.size();
-
-    // the width of the tree is the next power-of-two (if not already a power of two)
-    const size_t w = 1u << (log2i(count) + (utils::popcount(count) == 1 ? 0 : 1));
-
-    // height of the tree
-    const size_t h = log2i(w) + 1u;
-
-    auto const* UTILS_RESTRICT zrange = lightData.data<FScene::SCREEN_SPACE_Z_RANGE>() + 1;
-    BinaryTreeArray::traverse(h,
-            [lightTree, lightRecordsOffset, zrange, indices = lightList.data(), count]
-            (size_t index, size_t col, size_t next) {
-                // indices[] cannot be accessed past 'col'
-                const float min = (col < count) ? zrange[indices[col]].x : 1.0f;
-                const float max = (col < count) ? zrange[indices[col]].y : 0.0f;
-                lightTree[index] = {
-                        .min = min,
-                        .max = max,
-                        .next = uint16_t(next),
-                        .offset = uint16_t(lightRecordsOffset + col),
-                        .isLeaf = 1,
-                        .count = 1,
-                        .reserved = 0,
-                };
-            },
-            [lightTree](size_t index, size_t l, size_t r, size_t next) {
-                lightTree[index] = {
-                        .min = std::min(lightTree[l].min, lightTree[r].min),
-                        .max = std::max(lightTree[l].max, lightTree[r].max),
-                        .next = uint16_t(next),
-                        .offset = 0,
-                        .isLeaf = 0,
-                        .count = 0,
-                        .reserved = 0,
-                };
-            });
-}
-
 } // namespace details
 } // namespace filament
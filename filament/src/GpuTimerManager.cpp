@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "details/GpuTimerManager.h"
+
+#include "private/backend/CommandStream.h"
+
+#include <algorithm>
+
+#include <assert.h>
+
+namespace filament {
+namespace details {
+
+using namespace backend;
+
+GpuTimerManager::GpuTimerManager() noexcept = default;
+
+GpuTimerManager::~GpuTimerManager() noexcept {
+    assert(mFreeQueries.empty() && mPendingFrames.empty());
+}
+
+void GpuTimerManager::terminate(DriverApi& driver) noexcept {
+    for (Frame& frame : mPendingFrames) {
+        releaseFrame(driver, frame, false);
+    }
+    mPendingFrames.clear();
+    releaseFrame(driver, mCurrentFrame, false);
+    for (TimerQueryHandle query : mFreeQueries) {
+        driver.destroyTimerQuery(query);
+    }
+    mFreeQueries.clear();
+}
+
+void GpuTimerManager::beginFrame(uint32_t frameId) noexcept {
+    assert(!mInFrame);
+    mInFrame = true;
+    mCurrentFrame.frameId = frameId;
+    mCurrentFrame.passes.clear();
+    mCurrentView = nullptr;
+}
+
+void GpuTimerManager::beginView(void const* view) noexcept {
+    assert(!mInPass);
+    mCurrentView = view;
+}
+
+void GpuTimerManager::beginPass(DriverApi& driver, const char* name) noexcept {
+    // passes executed outside of a frame (e.g. in tests) are not timed, nor are the ones that
+    // don't fit in the report.
+    if (!mInFrame || mCurrentFrame.passes.size() >= PassTimingReport::MAX_PASS_COUNT) {
+        return;
+    }
+    assert(!mInPass);
+    TimerQueryHandle query = obtainQuery(driver);
+    mCurrentFrame.passes.push_back({ name, mCurrentView, query, -1 });
+    driver.beginTimerQuery(query);
+    mInPass = true;
+}
+
+void GpuTimerManager::endPass(DriverApi& driver) noexcept {
+    if (mInPass) {
+        driver.endTimerQuery(mCurrentFrame.passes.back().query);
+        mInPass = false;
+    }
+}
+
+void GpuTimerManager::endFrame() noexcept {
+    assert(mInFrame && !mInPass);
+    mInFrame = false;
+    mCurrentView = nullptr;
+    if (!mCurrentFrame.passes.empty()) {
+        mPendingFrames.push_back(std::move(mCurrentFrame));
+        mCurrentFrame = {};
+    }
+}
+
+void GpuTimerManager::update(DriverApi& driver, uint32_t lastFinishedFrameId) noexcept {
+    auto& frames = mPendingFrames;
+    while (!frames.empty()) {
+        Frame& frame = frames.front();
+        // frame ids wrap around, compare their distance instead
+        if (int32_t(lastFinishedFrameId - frame.frameId) < 0) {
+            break;
+        }
+
+        bool complete = true;
+        for (Pass& pass : frame.passes) {
+            uint64_t elapsed;
+            if (pass.elapsed < 0 && driver.getTimerQueryValue(pass.query, &elapsed)) {
+                pass.elapsed = int64_t(elapsed);
+            }
+            complete = complete && pass.elapsed >= 0;
+        }
+
+        if (!complete && int32_t(lastFinishedFrameId - frame.frameId) < int32_t(MAX_FRAME_LATENCY)) {
+            // try again next time, later frames can't be complete before this one
+            break;
+        }
+
+        if (complete) {
+            PassTimingReport& report = mReport;
+            report.frameId = frame.frameId;
+            report.count = frame.passes.size();
+            mViewTimes.clear();
+            for (size_t i = 0, c = frame.passes.size(); i < c; i++) {
+                Pass const& pass = frame.passes[i];
+                const float gpuTimeMs = float(double(pass.elapsed) * 1e-6);
+                report.passes[i].name = pass.name;
+                report.passes[i].gpuTimeMs = gpuTimeMs;
+                auto pos = std::find_if(mViewTimes.begin(), mViewTimes.end(),
+                        [&pass](ViewTime const& viewTime) { return viewTime.view == pass.view; });
+                if (pos == mViewTimes.end()) {
+                    pos = mViewTimes.insert(pos, { pass.view, 0.0f });
+                }
+                pos->gpuTimeMs += gpuTimeMs;
+            }
+        }
+
+        releaseFrame(driver, frame, complete);
+        frames.pop_front();
+    }
+}
+
+bool GpuTimerManager::getViewTime(void const* view,
+        uint32_t* frameId, float* gpuTimeMs) const noexcept {
+    for (ViewTime const& viewTime : mViewTimes) {
+        if (viewTime.view == view) {
+            *frameId = mReport.frameId;
+            *gpuTimeMs = viewTime.gpuTimeMs;
+            return true;
+        }
+    }
+    return false;
+}
+
+TimerQueryHandle GpuTimerManager::obtainQuery(DriverApi& driver) noexcept {
+    if (mFreeQueries.empty()) {
+        return driver.createTimerQuery();
+    }
+    TimerQueryHandle query = mFreeQueries.back();
+    mFreeQueries.pop_back();
+    return query;
+}
+
+void GpuTimerManager::releaseFrame(DriverApi& driver, Frame& frame, bool complete) noexcept {
+    for (Pass const& pass : frame.passes) {
+        if (complete) {
+            mFreeQueries.push_back(pass.query);
+        } else {
+            // a late result could still show up, so this query can't be recycled
+            driver.destroyTimerQuery(pass.query);
+        }
+    }
+    frame.passes.clear();
+}
+
+} // namespace details
+} // namespace filament
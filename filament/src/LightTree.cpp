@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "details/LightTree.h"
+
+#include <utils/Systrace.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <assert.h>
+
+using namespace filament::math;
+
+namespace filament {
+namespace details {
+
+LightTree::LightTree() noexcept = default;
+
+LightTree::~LightTree() noexcept = default;
+
+void LightTree::build(float4 const* spheres, size_t count) noexcept {
+    SYSTRACE_CALL();
+
+    assert(count <= MAX_LIGHT_COUNT);
+
+    mSpheres = spheres;
+    mIndices.clear();
+    mNodes.clear();
+
+    for (size_t i = 0; i < count; i++) {
+        if (spheres[i].w >= 0) {
+            mIndices.push_back(index_type(i));
+        }
+    }
+
+    if (!mIndices.empty()) {
+        // a binary tree with n leaves has 2n-1 nodes
+        mNodes.reserve(2 * (mIndices.size() + LEAF_SIZE - 1) / LEAF_SIZE);
+        buildNode(0, mIndices.size());
+    }
+}
+
+void LightTree::buildNode(size_t begin, size_t end) noexcept {
+    float4 const* const UTILS_RESTRICT spheres = mSpheres;
+    index_type* const UTILS_RESTRICT indices = mIndices.data();
+
+    const size_t index = mNodes.size();
+    mNodes.emplace_back();
+
+    float3 boxMin(std::numeric_limits<float>::max());
+    float3 boxMax(std::numeric_limits<float>::lowest());
+    float3 centerMin(std::numeric_limits<float>::max());
+    float3 centerMax(std::numeric_limits<float>::lowest());
+    for (size_t i = begin; i < end; i++) {
+        const float4 s = spheres[indices[i]];
+        boxMin = min(boxMin, s.xyz - s.w);
+        boxMax = max(boxMax, s.xyz + s.w);
+        centerMin = min(centerMin, s.xyz);
+        centerMax = max(centerMax, s.xyz);
+    }
+
+    const size_t count = end - begin;
+    if (count <= LEAF_SIZE) {
+        mNodes[index] = {
+                .min = boxMin,
+                .next = uint32_t(index + 1),
+                .max = boxMax,
+                .offset = uint16_t(begin),
+                .count = uint16_t(count)
+        };
+        return;
+    }
+
+    // split at the median of the lights' centers, along the axis they're the most spread on
+    const float3 extent = centerMax - centerMin;
+    const size_t axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 :
+                        (extent.y >= extent.z) ? 1 : 2;
+    const size_t middle = begin + count / 2;
+    std::nth_element(indices + begin, indices + middle, indices + end,
+            [spheres, axis](index_type lhs, index_type rhs) {
+                return spheres[lhs][axis] < spheres[rhs][axis];
+            });
+
+    buildNode(begin, middle);
+    buildNode(middle, end);
+
+    // note: don't keep a reference to the node across the recursion, mNodes could be resized
+    mNodes[index] = {
+            .min = boxMin,
+            .next = uint32_t(mNodes.size()),
+            .max = boxMax,
+            .offset = 0,
+            .count = 0
+    };
+}
+
+} // namespace details
+} // namespace filament
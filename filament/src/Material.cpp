@@ -76,6 +76,9 @@ Material* Material::Builder::build(Engine& engine) {
     FEngine::assertValid(engine, __PRETTY_FUNCTION__);
     MaterialParser* materialParser = FMaterial::createParser(
             upcast(engine).getBackend(), mImpl->mPayload, mImpl->mSize);
+    if (!materialParser) {
+        return nullptr;
+    }
 
     uint32_t v;
     materialParser->getShaderModels(&v);
@@ -94,6 +97,7 @@ Material* Material::Builder::build(Engine& engine) {
         }
         slog.e << "Compiled material contains shader models 0x"
                 << io::hex << shaderModels.getValue() << io::dec << "." << io::endl;
+        delete materialParser;
         return nullptr;
     }
 
@@ -481,6 +485,7 @@ MaterialParser* FMaterial::createParser(backend::Backend backend, const void* da
 
     bool materialOK = materialParser->parse();
     if (!ASSERT_POSTCONDITION_NON_FATAL(materialOK, "could not parse the material package")) {
+        delete materialParser;
         return nullptr;
     }
 
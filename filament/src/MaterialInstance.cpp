@@ -121,15 +121,26 @@ void FMaterialInstance::initParameters(FMaterial const* material) {
 }
 
 void FMaterialInstance::commitSlow(DriverApi& driver) const {
-    // update uniforms if needed
+    // update uniforms if needed, only the modified ranges are uploaded
     if (mUniforms.isDirty()) {
-        driver.loadUniformBuffer(mUbHandle, mUniforms.toBufferDescriptor(driver));
+        mUniforms.uploadDirtyRanges(driver, mUbHandle);
     }
     if (mSamplers.isDirty()) {
         driver.updateSamplerGroup(mSbHandle, std::move(mSamplers.toCommandStream()));
     }
 }
 
+size_t FMaterialInstance::commitSlow(DriverApi& driver, void* staging) const {
+    size_t size = 0;
+    if (mUniforms.isDirty()) {
+        size = mUniforms.uploadDirtyRanges(driver, mUbHandle, staging);
+    }
+    if (mSamplers.isDirty()) {
+        driver.updateSamplerGroup(mSbHandle, std::move(mSamplers.toCommandStream()));
+    }
+    return size;
+}
+
 template<typename T>
 inline void FMaterialInstance::setParameter(const char* name, T value) noexcept {
     ssize_t offset = mMaterial->getUniformInterfaceBlock().getUniformOffset(name, 0);
@@ -94,16 +94,17 @@ ChunkContainer const& MaterialParser::getChunkContainer() const noexcept {
 
 bool MaterialParser::parse() noexcept {
     ChunkContainer& cc = getChunkContainer();
-    if (cc.parse()) {
-        if (!cc.hasChunk(mImpl.mMaterialTag) || !cc.hasChunk(mImpl.mDictionaryTag)) {
-            return false;
-        }
-        if (!DictionaryReader::unflatten(cc, mImpl.mDictionaryTag, mImpl.mBlobDictionary)) {
-            return false;
-        }
-        if (!mImpl.mMaterialChunk.readIndex(mImpl.mMaterialTag)) {
-            return false;
-        }
+    if (!cc.parse()) {
+        return false;
+    }
+    if (!cc.hasChunk(mImpl.mMaterialTag) || !cc.hasChunk(mImpl.mDictionaryTag)) {
+        return false;
+    }
+    if (!DictionaryReader::unflatten(cc, mImpl.mDictionaryTag, mImpl.mBlobDictionary)) {
+        return false;
+    }
+    if (!mImpl.mMaterialChunk.readIndex(mImpl.mMaterialTag)) {
+        return false;
     }
     return true;
 }
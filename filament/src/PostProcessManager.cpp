@@ -25,6 +25,7 @@
 #include "details/Camera.h"
 #include "details/Material.h"
 #include "details/MaterialInstance.h"
+#include "details/Texture.h"
 #include "generated/resources/materials.h"
 
 #include <private/filament/SibGenerator.h>
@@ -33,6 +34,8 @@
 
 #include <utils/Log.h>
 
+#include <cmath>
+
 namespace filament {
 
 using namespace utils;
@@ -112,6 +115,8 @@ void PostProcessManager::init() noexcept {
     mSSAO = PostProcessMaterial(mEngine, MATERIALS_SAO_DATA, MATERIALS_SAO_SIZE);
     mMipmapDepth = PostProcessMaterial(mEngine, MATERIALS_MIPMAPDEPTH_DATA, MATERIALS_MIPMAPDEPTH_SIZE);
     mBlur = PostProcessMaterial(mEngine, MATERIALS_BLUR_DATA, MATERIALS_BLUR_SIZE);
+    mBilateralUpsample = PostProcessMaterial(mEngine,
+            MATERIALS_BILATERALUPSAMPLE_DATA, MATERIALS_BILATERALUPSAMPLE_SIZE);
     mBlit = PostProcessMaterial(mEngine, MATERIALS_BLIT_DATA, MATERIALS_BLIT_SIZE);
     mTonemapping = PostProcessMaterial(mEngine, MATERIALS_TONEMAPPING_DATA, MATERIALS_TONEMAPPING_SIZE);
     mFxaa = PostProcessMaterial(mEngine, MATERIALS_FXAA_DATA, MATERIALS_FXAA_SIZE);
@@ -161,6 +166,7 @@ void PostProcessManager::terminate(DriverApi& driver) noexcept {
     mSSAO.terminate(mEngine);
     mMipmapDepth.terminate(mEngine);
     mBlur.terminate(mEngine);
+    mBilateralUpsample.terminate(mEngine);
     mBlit.terminate(mEngine);
     mTonemapping.terminate(mEngine);
     mFxaa.terminate(mEngine);
@@ -197,7 +203,10 @@ FrameGraphId <FrameGraphTexture> PostProcessManager::toneMapping(FrameGraph& fg,
                 auto const& color = resources.getTexture(data.input);
 
                 FMaterialInstance* pInstance = mTonemapping.getMaterialInstance();
-                pInstance->setParameter("colorBuffer", color, {});
+                pInstance->setParameter("colorBuffer", color, {
+                        .filterMag = SamplerMagFilter::LINEAR,
+                        .filterMin = SamplerMinFilter::LINEAR
+                });
                 pInstance->setParameter("dithering", dithering);
                 pInstance->setParameter("fxaa", fxaa);
                 pInstance->commit(driver);
@@ -366,7 +375,8 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::dynamicScaling(FrameGraph& f
 
 FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderPass& pass,
         filament::Viewport const& svp, CameraInfo const& cameraInfo,
-        View::AmbientOcclusionOptions const& options) noexcept {
+        View::AmbientOcclusionOptions const& options,
+        FrameGraphId<FrameGraphTexture>* outDepth) noexcept {
 
     FEngine& engine = mEngine;
     Handle<HwRenderPrimitive> fullScreenRenderPrimitive = engine.getFullScreenRenderPrimitive();
@@ -375,7 +385,14 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderP
      * SSAO depth pass -- automatically culled if not used
      */
 
-    FrameGraphId<FrameGraphTexture> depth = depthPass(fg, pass, svp.width, svp.height, options);
+    // sanitize a bit the user provided scaling factor
+    const float resolution = std::min(std::abs(options.resolution), 1.0f);
+
+    // When the depth buffer is shared with the caller, it's rendered at full resolution
+    const bool sharedDepth = outDepth != nullptr;
+
+    FrameGraphId<FrameGraphTexture> depth = depthPass(fg, pass, svp.width, svp.height,
+            sharedDepth ? 1.0f : resolution);
 
     /*
      * create depth mipmap chain
@@ -387,6 +404,14 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderP
         depth = mipmapPass(fg, depth, level);
     }
 
+    // The AO buffer and the blur passes use the size of the level of the depth pyramid closest
+    // to the requested resolution, e.g. level 1 for 0.5.
+    uint8_t depthLevel = 0;
+    if (sharedDepth && resolution > 0.0f) {
+        const float level = std::round(-std::log2(resolution));
+        depthLevel = uint8_t(std::min(float(levelCount - 1), level));
+    }
+
     /*
      * Our main SSAO pass
      */
@@ -407,7 +432,8 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderP
                 data.depth = builder.sample(depth);
 
                 data.ssao = builder.createTexture("SSAO Buffer", {
-                        .width = desc.width, .height = desc.height,
+                        .width = uint32_t(FTexture::valueForLevel(depthLevel, desc.width)),
+                        .height = uint32_t(FTexture::valueForLevel(depthLevel, desc.height)),
                         .format = TextureFormat::R8 });
 
                 // Here we use the depth test to skip pixels at infinity (i.e. the skybox)
@@ -419,7 +445,7 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderP
                 data.depth = builder.sample(data.depth);
 
                 data.rt = builder.createRenderTarget("SSAO Target",
-                        { .attachments = { data.ssao, data.depth }
+                        { .attachments = { data.ssao, { data.depth, depthLevel } }
                         }, TargetBufferFlags::COLOR);
             },
             [=](FrameGraphPassResources const& resources,
@@ -434,7 +460,9 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderP
                         0.5f * cameraInfo.projection[1].y * desc.height);
 
                 FMaterialInstance* const pInstance = mSSAO.getMaterialInstance();
-                pInstance->setParameter("depth", depth, {});
+                pInstance->setParameter("depth", depth, {
+                        .filterMin = SamplerMinFilter::NEAREST_MIPMAP_NEAREST
+                });
                 pInstance->setParameter("resolution",
                         float4{ desc.width, desc.height, 1.0f / desc.width, 1.0f / desc.height });
                 pInstance->setParameter("radius", data.options.radius);
@@ -443,7 +471,8 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderP
                 pInstance->setParameter("bias", data.options.bias);
                 pInstance->setParameter("power", data.options.power);
                 pInstance->setParameter("intensity", std::max(0.0f, data.options.intensity));
-                pInstance->setParameter("maxLevel", uint32_t(levelCount - 1));
+                pInstance->setParameter("maxLevel", uint32_t(levelCount - 1 - depthLevel));
+                pInstance->setParameter("depthLevel", uint32_t(depthLevel));
                 pInstance->commit(driver);
 
                 PipelineState pipeline;
@@ -466,16 +495,27 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::ssao(FrameGraph& fg, RenderP
      */
 
     // horizontal separable blur pass
-    ssao = blurPass(fg, ssao, depth, {1, 0});
+    ssao = blurPass(fg, ssao, depth, depthLevel, {1, 0});
 
     // vertical separable blur pass
-    ssao = blurPass(fg, ssao, depth, {0, 1});
+    ssao = blurPass(fg, ssao, depth, depthLevel, {0, 1});
+
+    /*
+     * Upsample to the resolution of the depth buffer
+     */
+
+    if (depthLevel > 0) {
+        ssao = bilateralUpsamplePass(fg, ssao, depth, depthLevel);
+    }
+
+    if (outDepth) {
+        *outDepth = depth;
+    }
     return ssao;
 }
 
 FrameGraphId<FrameGraphTexture> PostProcessManager::depthPass(FrameGraph& fg, RenderPass const& pass,
-        uint32_t width, uint32_t height,
-        View::AmbientOcclusionOptions const& options) noexcept {
+        uint32_t width, uint32_t height, float scale) noexcept {
 
     // SSAO depth pass -- automatically culled if not used
     struct DepthPassData {
@@ -483,8 +523,6 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::depthPass(FrameGraph& fg, Re
         FrameGraphRenderTargetHandle rt;
     };
 
-    // sanitize a bit the user provided scaling factor
-    const float scale = std::min(std::abs(options.resolution), 1.0f);
     width  = std::ceil(width * scale);
     height = std::ceil(height * scale);
 
@@ -565,7 +603,7 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::mipmapPass(FrameGraph& fg,
 
 FrameGraphId<FrameGraphTexture> PostProcessManager::blurPass(FrameGraph& fg,
         FrameGraphId<FrameGraphTexture> input,
-        FrameGraphId<FrameGraphTexture> depth, math::int2 axis) noexcept {
+        FrameGraphId<FrameGraphTexture> depth, uint8_t depthLevel, math::int2 axis) noexcept {
 
     Handle<HwRenderPrimitive> fullScreenRenderPrimitive = mEngine.getFullScreenRenderPrimitive();
 
@@ -594,7 +632,7 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::blurPass(FrameGraph& fg,
                 depth = builder.read(depth);
                 data.blurred = builder.write(data.blurred);
                 data.rt = builder.createRenderTarget("Blurred target",
-                        { .attachments = { data.blurred, depth }
+                        { .attachments = { data.blurred, { depth, depthLevel } }
                         }, TargetBufferFlags::NONE);
             },
             [=](FrameGraphPassResources const& resources,
@@ -611,6 +649,7 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::blurPass(FrameGraph& fg,
                 pInstance->setParameter("depth", depth, {});
                 pInstance->setParameter("axis", axis);
                 pInstance->setParameter("oneOverEdgeDistance", 1.0f / 0.1f);
+                pInstance->setParameter("depthLevel", uint32_t(depthLevel));
                 pInstance->setParameter("resolution",
                         float4{ desc.width, desc.height, 1.0f / desc.width, 1.0f / desc.height });
                 pInstance->commit(driver);
@@ -630,4 +669,67 @@ FrameGraphId<FrameGraphTexture> PostProcessManager::blurPass(FrameGraph& fg,
     return blurPass.getData().blurred;
 }
 
+FrameGraphId<FrameGraphTexture> PostProcessManager::bilateralUpsamplePass(FrameGraph& fg,
+        FrameGraphId<FrameGraphTexture> input,
+        FrameGraphId<FrameGraphTexture> depth, uint8_t depthLevel) noexcept {
+
+    Handle<HwRenderPrimitive> fullScreenRenderPrimitive = mEngine.getFullScreenRenderPrimitive();
+
+    struct UpsamplePassData {
+        FrameGraphId<FrameGraphTexture> input;
+        FrameGraphId<FrameGraphTexture> depth;
+        FrameGraphId<FrameGraphTexture> upsampled;
+        FrameGraphRenderTargetHandle rt;
+    };
+
+    auto& upsamplePass = fg.addPass<UpsamplePassData>("Bilateral Upsample Pass",
+            [&](FrameGraph::Builder& builder, UpsamplePassData& data) {
+
+                auto const& inputDesc = builder.getDescriptor(input);
+                auto const& depthDesc = builder.getDescriptor(depth);
+
+                data.input = builder.sample(input);
+                data.depth = builder.sample(depth);
+
+                data.upsampled = builder.createTexture("Upsampled output", {
+                        .width = depthDesc.width, .height = depthDesc.height,
+                        .format = inputDesc.format });
+
+                // Same as the SSAO pass, we use the depth test to skip pixels at infinity and
+                // clear the buffer because blended objects will read from it.
+                data.upsampled = builder.write(data.upsampled);
+                data.depth = builder.read(data.depth);
+                data.rt = builder.createRenderTarget("Upsampled target",
+                        { .attachments = { data.upsampled, data.depth }
+                        }, TargetBufferFlags::COLOR);
+            },
+            [=](FrameGraphPassResources const& resources,
+                    UpsamplePassData const& data, DriverApi& driver) {
+                auto ssao = resources.getTexture(data.input);
+                auto depth = resources.getTexture(data.depth);
+                auto upsampled = resources.getRenderTarget(data.rt);
+
+                FMaterialInstance* const pInstance = mBilateralUpsample.getMaterialInstance();
+                pInstance->setParameter("ssao", ssao, {});
+                pInstance->setParameter("depth", depth, {});
+                pInstance->setParameter("depthLevel", uint32_t(depthLevel));
+                pInstance->setParameter("oneOverEdgeDistance", 1.0f / 0.1f);
+                pInstance->commit(driver);
+
+                PipelineState pipeline;
+                pipeline.program = mBilateralUpsample.getProgram();
+                pipeline.rasterState = mBilateralUpsample.getMaterial()->getRasterState();
+                pipeline.rasterState.depthFunc = RasterState::DepthFunc::G;
+                pipeline.scissor = pInstance->getScissor();
+
+                upsampled.params.clearColor = 1.0f;
+                driver.beginRenderPass(upsampled.target, upsampled.params);
+                pInstance->use(driver);
+                driver.draw(pipeline, fullScreenRenderPrimitive);
+                driver.endRenderPass();
+            });
+
+    return upsamplePass.getData().upsampled;
+}
+
 } // namespace filament
@@ -57,10 +57,15 @@ public:
             FrameGraphId <FrameGraphTexture> input,
             backend::TextureFormat outFormat) noexcept;
 
+    // If outDepth is not null, the SSAO depth pass is rendered at the resolution of svp so that
+    // it can be reused by the caller, and outDepth receives it. The AO itself is still computed
+    // at the resolution set in the options, from the matching level of the depth pyramid, and
+    // then upsampled with a bilateral filter.
     FrameGraphId<FrameGraphTexture> ssao(FrameGraph& fg, details::RenderPass& pass,
             filament::Viewport const& svp,
             details::CameraInfo const& cameraInfo,
-            View::AmbientOcclusionOptions const& options) noexcept;
+            View::AmbientOcclusionOptions const& options,
+            FrameGraphId<FrameGraphTexture>* outDepth = nullptr) noexcept;
 
     backend::Handle<backend::HwTexture> getNoSSAOTexture() const {
         return mNoSSAOTexture;
@@ -70,14 +75,19 @@ private:
     details::FEngine& mEngine;
 
     FrameGraphId<FrameGraphTexture> depthPass(FrameGraph& fg, details::RenderPass const& pass,
-            uint32_t width, uint32_t height, View::AmbientOcclusionOptions const& options) noexcept;
+            uint32_t width, uint32_t height, float scale) noexcept;
 
     FrameGraphId<FrameGraphTexture> mipmapPass(FrameGraph& fg,
             FrameGraphId<FrameGraphTexture> input, size_t level) noexcept;
 
+    // depthLevel is the level of the depth pyramid that has the size of input
     FrameGraphId<FrameGraphTexture> blurPass(FrameGraph& fg,
             FrameGraphId<FrameGraphTexture> input,
-            FrameGraphId<FrameGraphTexture> depth, math::int2 axis) noexcept;
+            FrameGraphId<FrameGraphTexture> depth, uint8_t depthLevel, math::int2 axis) noexcept;
+
+    FrameGraphId<FrameGraphTexture> bilateralUpsamplePass(FrameGraph& fg,
+            FrameGraphId<FrameGraphTexture> input,
+            FrameGraphId<FrameGraphTexture> depth, uint8_t depthLevel) noexcept;
 
     class PostProcessMaterial {
     public:
@@ -107,6 +117,7 @@ private:
     PostProcessMaterial mSSAO;
     PostProcessMaterial mMipmapDepth;
     PostProcessMaterial mBlur;
+    PostProcessMaterial mBilateralUpsample;
     PostProcessMaterial mBlit;
     PostProcessMaterial mTonemapping;
     PostProcessMaterial mFxaa;
@@ -63,6 +63,14 @@ void RenderPass::setRenderFlags(RenderPass::RenderFlags flags) noexcept {
     mFlags = flags;
 }
 
+void RenderPass::setVisibilityMask(Culler::result_type mask) noexcept {
+    mVisibilityMask = mask;
+}
+
+void RenderPass::setFrameStatistics(FrameStatisticsRecorder* recorder) noexcept {
+    mFrameStatistics = recorder;
+}
+
 void RenderPass::overridePolygonOffset(backend::PolygonOffset* polygonOffset) noexcept {
     if ((mPolygonOffsetOverride = (polygonOffset != nullptr))) {
         mPolygonOffset = *polygonOffset;
@@ -83,10 +91,14 @@ RenderPass::Command* RenderPass::newCommandBuffer() noexcept {
 RenderPass::Command* RenderPass::appendCommands(CommandTypeFlags const commandTypeFlags) noexcept {
     SYSTRACE_CONTEXT();
 
+    FrameStatisticsRecorder::Scope stats(mFrameStatistics,
+            FrameStatisticsRecorder::Phase::COMMAND_GENERATION);
+
     FEngine& engine = mEngine;
     JobSystem& js = engine.getJobSystem();
     GrowingSlice<Command>& commands = mCommands;
     const RenderFlags renderFlags = mFlags;
+    const Culler::result_type visibilityMask = mVisibilityMask;
     CameraInfo const& camera = mCamera;
     utils::Range<uint32_t> vr = mVisibleRenderables;
     if (UTILS_UNLIKELY(vr.empty())) {
@@ -112,10 +124,11 @@ RenderPass::Command* RenderPass::appendCommands(CommandTypeFlags const commandTy
     // we extract camera position/forward outside of the loop, because these are not cheap.
     const float3 cameraPosition(camera.getPosition());
     const float3 cameraForwardVector(camera.getForwardVector());
-    auto work = [commandTypeFlags, curr, &soa, renderFlags, cameraPosition, cameraForwardVector]
+    auto work = [commandTypeFlags, curr, &soa, renderFlags, visibilityMask,
+            cameraPosition, cameraForwardVector]
             (uint32_t startIndex, uint32_t indexCount) {
         RenderPass::generateCommands(commandTypeFlags, curr,
-                soa, { startIndex, startIndex + indexCount }, renderFlags,
+                soa, { startIndex, startIndex + indexCount }, renderFlags, visibilityMask,
                 cameraPosition, cameraForwardVector);
     };
 
@@ -158,6 +171,9 @@ RenderPass::Command* RenderPass::appendCustomCommand(Pass pass, CustomCommand cu
 RenderPass::Command* RenderPass::sortCommands() noexcept {
     SYSTRACE_NAME("sort and trim commands");
 
+    FrameStatisticsRecorder::Scope stats(mFrameStatistics,
+            FrameStatisticsRecorder::Phase::COMMAND_SORT);
+
     GrowingSlice<Command>& commands = mCommands;
 
     std::sort(commands.begin(), commands.end());
@@ -177,6 +193,9 @@ void RenderPass::execute(const char* name,
         backend::Handle<backend::HwRenderTarget> renderTarget,
         backend::RenderPassParams params) const noexcept {
 
+    FrameStatisticsRecorder::Scope stats(mFrameStatistics,
+            FrameStatisticsRecorder::Phase::DRIVER_RECORDING);
+
     FEngine& engine = mEngine;
     Command const* const first = mCommands.begin();
     Command const* const last = mCommands.end();
@@ -305,6 +324,15 @@ void RenderPass::setupColorCommand(Command& cmdDraw, bool hasDepthPass,
     cmdDraw.primitive.rasterState.depthWrite =
             skipDepthWrite ? false : cmdDraw.primitive.rasterState.depthWrite;
 
+    // and if the material uses the regular depth test, only the fragments that made it to
+    // the depth buffer are shaded, this guarantees zero overdraw for these objects.
+    // This relies on the depth and color variants computing the exact same position, which is
+    // why the vertex shaders declare gl_Position as invariant.
+    const RasterState::DepthFunc depthFunc = cmdDraw.primitive.rasterState.depthFunc;
+    cmdDraw.primitive.rasterState.depthFunc =
+            (skipDepthWrite && depthFunc == RasterState::DepthFunc::LE) ?
+            RasterState::DepthFunc::E : depthFunc;
+
     // we keep "RasterState::colorWrite" to the value set by material (could be disabled)
 }
 
@@ -312,6 +340,7 @@ void RenderPass::setupColorCommand(Command& cmdDraw, bool hasDepthPass,
 UTILS_NOINLINE
 void RenderPass::generateCommands(uint32_t commandTypeFlags, Command* const commands,
         FScene::RenderableSoa const& soa, Range<uint32_t> range, RenderFlags renderFlags,
+        Culler::result_type visibilityMask,
         float3 cameraPosition, float3 cameraForward) noexcept {
 
     // generateCommands() writes both the draw and depth commands simultaneously such that
@@ -339,15 +368,15 @@ void RenderPass::generateCommands(uint32_t commandTypeFlags, Command* const comm
     switch (commandTypeFlags & CommandTypeFlags::COLOR_AND_DEPTH) {
         case CommandTypeFlags::COLOR:
             generateCommandsImpl<CommandTypeFlags::COLOR>(commandTypeFlags, curr,
-                    soa, range, renderFlags, cameraPosition, cameraForward);
+                    soa, range, renderFlags, visibilityMask, cameraPosition, cameraForward);
             break;
         case CommandTypeFlags::DEPTH:
             generateCommandsImpl<CommandTypeFlags::DEPTH>(commandTypeFlags, curr,
-                    soa, range, renderFlags, cameraPosition, cameraForward);
+                    soa, range, renderFlags, visibilityMask, cameraPosition, cameraForward);
             break;
         case CommandTypeFlags::COLOR_AND_DEPTH:
             generateCommandsImpl<CommandTypeFlags::COLOR_AND_DEPTH>(commandTypeFlags, curr,
-                    soa, range, renderFlags, cameraPosition, cameraForward);
+                    soa, range, renderFlags, visibilityMask, cameraPosition, cameraForward);
             break;
     }
 }
@@ -358,7 +387,7 @@ UTILS_NOINLINE
 void RenderPass::generateCommandsImpl(uint32_t extraFlags,
         Command* UTILS_RESTRICT curr,
         FScene::RenderableSoa const& UTILS_RESTRICT soa, Range<uint32_t> range,
-        RenderFlags renderFlags,
+        RenderFlags renderFlags, Culler::result_type visibilityMask,
         float3 cameraPosition, float3 cameraForward) noexcept {
 
     // generateCommands() writes both the draw and depth commands simultaneously such that
@@ -371,12 +400,15 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
     const bool depthContainsShadowCasters = bool(extraFlags & CommandTypeFlags::DEPTH_CONTAINS_SHADOW_CASTERS);
     const bool depthFilterTranslucentObjects = bool(extraFlags & CommandTypeFlags::DEPTH_FILTER_TRANSLUCENT_OBJECTS);
     const bool depthFilterAlphaMaskedObjects = bool(extraFlags & CommandTypeFlags::DEPTH_FILTER_ALPHA_MASKED_OBJECTS);
+    const bool hasDepthPrepass = depthPass || bool(extraFlags & CommandTypeFlags::DEPTH_PREPASS_DONE);
 
     auto const* const UTILS_RESTRICT soaWorldAABBCenter = soa.data<FScene::WORLD_AABB_CENTER>();
     auto const* const UTILS_RESTRICT soaReversedWinding = soa.data<FScene::REVERSED_WINDING_ORDER>();
     auto const* const UTILS_RESTRICT soaVisibility      = soa.data<FScene::VISIBILITY_STATE>();
     auto const* const UTILS_RESTRICT soaPrimitives      = soa.data<FScene::PRIMITIVES>();
     auto const* const UTILS_RESTRICT soaBonesUbh        = soa.data<FScene::BONES_UBH>();
+    auto const* const UTILS_RESTRICT soaInstances       = soa.data<FScene::RENDERABLE_INSTANCE>();
+    auto const* const UTILS_RESTRICT soaVisibleMask     = soa.data<FScene::VISIBLE_MASK>();
 
     const bool hasShadowing = renderFlags & HAS_SHADOWING;
     const bool viewInverseFrontFaces = renderFlags & HAS_INVERSE_FRONT_FACES;
@@ -430,8 +462,13 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
         // calculate the per-primitive face winding order inversion
         const bool inverseFrontFaces = viewInverseFrontFaces ^ soaReversedWinding[i];
 
+        // the per-renderable UBO is indexed by renderable instance, which Builder::build()
+        // keeps within 16 bits
+        assert(soaInstances[i].asValue() <= FRenderableManager::MAX_INSTANCE_COUNT);
+        const uint16_t uboIndex = (uint16_t)soaInstances[i].asValue();
+
         cmdColor.key = makeField(soaVisibility[i].priority, PRIORITY_MASK, PRIORITY_SHIFT);
-        cmdColor.primitive.index = (uint16_t)i;
+        cmdColor.primitive.index = uboIndex;
         cmdColor.primitive.perRenderableBones = soaBonesUbh[i];
         materialVariant.setShadowReceiver(soaVisibility[i].receiveShadows & hasShadowing);
         materialVariant.setSkinning(soaVisibility[i].skinning || soaVisibility[i].morphing);
@@ -442,7 +479,7 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
         cmdDepth.key |= uint64_t(CustomCommand::PASS);
         cmdDepth.key |= makeField(soaVisibility[i].priority, PRIORITY_MASK, PRIORITY_SHIFT);
         cmdDepth.key |= makeField(distanceBits, DISTANCE_BITS_MASK, DISTANCE_BITS_SHIFT);
-        cmdDepth.primitive.index = (uint16_t)i;
+        cmdDepth.primitive.index = uboIndex;
         cmdDepth.primitive.perRenderableBones = soaBonesUbh[i];
         cmdDepth.primitive.materialVariant.setSkinning(soaVisibility[i].skinning || soaVisibility[i].morphing);
         cmdDepth.primitive.rasterState.inverseFrontFaces = inverseFrontFaces;
@@ -450,6 +487,10 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
         const bool shadowCaster = soaVisibility[i].castShadows & hasShadowing;
         const bool writeDepthForShadowCasters = depthContainsShadowCasters & shadowCaster;
 
+        // commands are always written, but the ones filtered out by the visibility mask
+        // (e.g. casters outside of the current shadow cascade) are turned into sentinels
+        const bool filtered = !(soaVisibleMask[i] & visibilityMask);
+
         const Slice<FRenderPrimitive>& primitives = soaPrimitives[i];
 
         /*
@@ -461,7 +502,7 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
             if (colorPass) {
                 cmdColor.primitive.primitiveHandle = primitive.getHwHandle();
                 cmdColor.primitive.materialVariant = materialVariant;
-                RenderPass::setupColorCommand(cmdColor, depthPass, mi, inverseFrontFaces);
+                RenderPass::setupColorCommand(cmdColor, hasDepthPrepass, mi, inverseFrontFaces);
 
                 const bool blendPass = Pass(cmdColor.key & PASS_MASK) == Pass::BLENDED;
                 if (blendPass) {
@@ -499,10 +540,11 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
                     key |= makeField(1, BLEND_TWO_PASS_MASK, BLEND_TWO_PASS_SHIFT);
 
                     // handle the case where this primitive is empty / no-op
-                    key |= select(primitive.getPrimitiveType() == PrimitiveType::NONE);
+                    key |= select(primitive.isEmpty());
 
                     // correct for TransparencyMode::DEFAULT -- i.e. cancel the command
                     key |= select(mode == TransparencyMode::DEFAULT);
+                    key |= select(filtered);
 
                     *curr = cmdColor;
                     curr->key = key;
@@ -521,7 +563,7 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
                             SamplerCompareFunc::LE : cmdColor.primitive.rasterState.depthFunc;
                 } else {
                     // color pass, opaque objects...
-                    if (!depthPass) {
+                    if (!hasDepthPrepass) {
                         // ...without depth pre-pass:
                         // this will bucket objects by Z, front-to-back and then sort by material
                         // in each buckets. We use the top 10 bits of the distance, which
@@ -537,7 +579,8 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
 
                 *curr = cmdColor;
                 // handle the case where this primitive is empty / no-op
-                curr->key |= select(primitive.getPrimitiveType() == PrimitiveType::NONE);
+                curr->key |= select(primitive.isEmpty());
+                curr->key |= select(filtered);
                 ++curr;
             }
 
@@ -556,10 +599,10 @@ void RenderPass::generateCommandsImpl(uint32_t extraFlags,
                         & !(depthFilterAlphaMaskedObjects & rs.alphaToCoverage))
                                 | writeDepthForShadowCasters;
 
-                curr->key |= select(!issueDepth);
+                curr->key |= select(!issueDepth | filtered);
 
                 // handle the case where this primitive is empty / no-op
-                curr->key |= select(primitive.getPrimitiveType() == PrimitiveType::NONE);
+                curr->key |= select(primitive.isEmpty());
                 ++curr;
             }
         }
@@ -20,6 +20,7 @@
 #include <filament/Viewport.h>
 
 #include "details/Camera.h"
+#include "details/FrameStatisticsRecorder.h"
 #include "details/Material.h"
 #include "details/Scene.h"
 
@@ -30,6 +31,8 @@
 #include <utils/compiler.h>
 #include <utils/Slice.h>
 
+#include <limits>
+
 namespace utils {
 class JobSystem;
 }
@@ -109,10 +112,16 @@ public:
         DEPTH_FILTER_TRANSLUCENT_OBJECTS = 0x8,
         // alpha-tested objects are not rendered in the depth buffer
         DEPTH_FILTER_ALPHA_MASKED_OBJECTS = 0x10,
+        // the depth buffer already contains the opaque objects (e.g. it comes from the SSAO
+        // depth pass), the color pass doesn't need to generate the depth commands.
+        DEPTH_PREPASS_DONE = 0x20,
 
         // generate commands for color with depth pre-pass -- in this case, we want to put
         // objects that use alpha-testing or blending in the depth prepass.
         COLOR_WITH_DEPTH_PREPASS = DEPTH | COLOR | DEPTH_FILTER_TRANSLUCENT_OBJECTS | DEPTH_FILTER_ALPHA_MASKED_OBJECTS,
+        // generate commands for color when the depth pre-pass was rendered separately, this
+        // must be used with a depth buffer generated with the SSAO commands.
+        COLOR_AFTER_DEPTH_PREPASS = COLOR | DEPTH_PREPASS_DONE,
         // generate commands for shadow map
         SHADOW = DEPTH | DEPTH_CONTAINS_SHADOW_CASTERS,
         // generate commands for SSAO
@@ -223,7 +232,7 @@ public:
         backend::Handle<backend::HwRenderPrimitive> primitiveHandle;    // 4 bytes
         backend::Handle<backend::HwUniformBuffer> perRenderableBones;   // 4 bytes
         backend::RasterState rasterState;                               // 4 bytes
-        uint16_t index = 0;                                             // 2 bytes
+        uint16_t index = 0;                                             // 2 bytes (UBO index)
         Variant materialVariant;                                        // 1 byte
         uint8_t reserved = {};                                          // 1 byte
     };
@@ -256,6 +265,12 @@ public:
     void setCamera(const CameraInfo& camera) noexcept;
     void setRenderFlags(RenderFlags flags) noexcept;
 
+    // only renderables with at least one of these bits set in their VISIBLE_MASK are drawn
+    void setVisibilityMask(Culler::result_type mask) noexcept;
+
+    // where the time spent generating, sorting and recording commands is accounted, can be null
+    void setFrameStatistics(FrameStatisticsRecorder* recorder) noexcept;
+
     Command* newCommandBuffer() noexcept;
 
     // returns mCommands.end()
@@ -294,12 +309,13 @@ private:
 
     static inline void generateCommands(uint32_t commandTypeFlags, Command* commands,
             FScene::RenderableSoa const& soa, utils::Range<uint32_t> range, RenderFlags renderFlags,
+            Culler::result_type visibilityMask,
             math::float3 cameraPosition, math::float3 cameraForward) noexcept;
 
     template<uint32_t commandTypeFlags>
     static inline void generateCommandsImpl(uint32_t, Command* commands,
             FScene::RenderableSoa const& soa, utils::Range<uint32_t> range,
-            RenderFlags renderFlags,
+            RenderFlags renderFlags, Culler::result_type visibilityMask,
             math::float3 cameraPosition, math::float3 cameraForward) noexcept;
 
     static void setupColorCommand(Command& cmdDraw, bool hasDepthPass,
@@ -331,6 +347,10 @@ private:
     CameraInfo mCamera;
     // info about the scene features (e.g.: has shadows, lighting, etc...)
     RenderFlags mFlags{};
+    // renderables not matching this mask are skipped
+    Culler::result_type mVisibilityMask = std::numeric_limits<Culler::result_type>::max();
+    // CPU timings of this pass go there
+    FrameStatisticsRecorder* mFrameStatistics = nullptr;
     // whether to override the polygon offset setting
     bool mPolygonOffsetOverride = false;
     // value of the override
@@ -53,6 +53,7 @@ namespace details {
 FRenderer::FRenderer(FEngine& engine) :
         mEngine(engine),
         mFrameSkipper(engine, 2),
+        mFrameStatistics(engine),
         mFrameInfoManager(engine),
         mIsRGB8Supported(false),
         mPerRenderPassArena(engine.getPerRenderPassAllocator())
@@ -118,6 +119,7 @@ void FRenderer::terminate(FEngine& engine) {
     // shut down threads if we created any.
     DriverApi& driver = engine.getDriverApi();
     driver.destroyRenderTarget(mRenderTarget);
+    mGpuTimerManager.terminate(driver);
 
     // before we can destroy this Renderer's resources, we must make sure
     // that all pending commands have been executed (as they could reference data in this
@@ -132,6 +134,24 @@ void FRenderer::terminate(FEngine& engine) {
     }
 }
 
+FrameInfo::duration FRenderer::getFrameTime(FView& view) noexcept {
+    // Prefer the GPU timings when the backend supports them, they measure exactly the work that
+    // dynamic resolution scales, and only for this view. They're only updated once the GPU is
+    // done with a frame, so we return zero when there is no new measurement.
+    PassTimingReport const& report = mGpuTimerManager.getReport();
+    if (report.count > 0) {
+        uint32_t frameId;
+        float gpuTimeMs;
+        if (!mGpuTimerManager.getViewTime(&view, &frameId, &gpuTimeMs) ||
+                frameId == view.getLastTimedFrameId()) {
+            return {};
+        }
+        view.setLastTimedFrameId(frameId);
+        return FrameInfo::duration{ gpuTimeMs };
+    }
+    return mFrameInfoManager.getLastFrameTime();
+}
+
 void FRenderer::resetUserTime() {
     mUserEpoch = std::chrono::steady_clock::now();
 }
@@ -196,7 +216,8 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
     bool dithering = view.getDithering() == View::Dithering::TEMPORAL;
     bool fxaa = view.getAntiAliasing() == View::AntiAliasing::FXAA;
     uint8_t msaa = view.getSampleCount();
-    float2 scale = view.updateScale(mFrameInfoManager.getLastFrameTime());
+    mGpuTimerManager.beginView(&view);
+    float2 scale = view.updateScale(getFrameTime(view), mGpuTimerManager.getReport().count > 0);
     if (!hasPostProcess) {
         // dynamic scaling and FXAA are part of the post-process phase and can't happen if
         // it's disabled.
@@ -212,11 +233,15 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
         return;
     }
 
-    view.prepare(engine, driver, arena, svp, getShaderUserTime());
+    view.prepare(engine, driver, arena, svp, getShaderUserTime(), &mFrameStatistics);
 
     // start froxelization immediately, it has no dependencies
     JobSystem::Job* jobFroxelize = js.runAndRetain(js.createJob(nullptr,
-            [&engine, &view](JobSystem&, JobSystem::Job*) { view.froxelize(engine); }));
+            [&engine, &view, stats = &mFrameStatistics](JobSystem&, JobSystem::Job*) {
+                FrameStatisticsRecorder::Scope scope(stats,
+                        FrameStatisticsRecorder::Phase::FROXELIZATION);
+                view.froxelize(engine);
+            }));
 
     /*
      * Allocate command buffer
@@ -236,6 +261,7 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
     if (view.hasDynamicLighting())         renderFlags |= RenderPass::HAS_DYNAMIC_LIGHTING;
     if (view.isFrontFaceWindingInverted()) renderFlags |= RenderPass::HAS_INVERSE_FRONT_FACES;
     pass.setRenderFlags(renderFlags);
+    pass.setFrameStatistics(&mFrameStatistics);
 
     /*
      * Shadow pass
@@ -244,7 +270,9 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
     if (view.hasShadowing()) {
         // TODO: use the framegraph for the shadow passes
         RenderPass shadowMapPass = pass;
+        mGpuTimerManager.beginPass(driver, "Shadow Map");
         view.getShadowMap().render(driver, shadowMapPass, view);
+        mGpuTimerManager.endPass(driver);
         driver.flush(); // Kick the GPU since we're done with this render target
         engine.flush(); // Wake-up the driver thread
     }
@@ -299,26 +327,39 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
         pass.sortCommands();
     }
 
+    // With the depth pre-pass enabled, the SSAO depth pass doubles as the depth pre-pass of the
+    // color pass, as long as it has the same sample count. This saves a geometry pass. In that
+    // case the SSAO depth is rendered at full resolution, the AO is still computed at the
+    // resolution set in the options and then upsampled.
+    const bool ssaoDepthPrepass = useSSAO && msaa <= 1 &&
+            view.getDepthPrepass() == View::DepthPrepass::ENABLED;
+
     // SSAO pass -- automatically culled if not used
+    FrameGraphId<FrameGraphTexture> ssaoDepth;
     FrameGraphId<FrameGraphTexture> ssao = ppm.ssao(fg, pass, svp, cameraInfo,
-            view.getAmbientOcclusionOptions());
+            view.getAmbientOcclusionOptions(), ssaoDepthPrepass ? &ssaoDepth : nullptr);
 
     // --------------------------------------------------------------------------------------------
     // Color passes
 
     // TODO: ideally this should be a FrameGraph pass to participate to automatic culling
-    RenderPass::CommandTypeFlags commandType = getCommandType(view.getDepthPrepass());
+    RenderPass::CommandTypeFlags commandType =
+            getCommandType(view.getDepthPrepass(), ssaoDepthPrepass);
     pass.newCommandBuffer();
     pass.appendCommands(commandType);
     pass.sortCommands();
 
     // We use a framegraph pass to commit the View's uniforms and wait for froxelization to finish
     auto& prepareColorPasses = fg.addPass<PrepareColorPassesData>("Prepare Color Passes",
-            [useSSAO, ssao, msaa, hdrFormat, &svp]
+            [useSSAO, ssao, ssaoDepthPrepass, ssaoDepth, msaa, hdrFormat, &svp]
                     (FrameGraph::Builder& builder, PrepareColorPassesData& data) {
                 if (useSSAO) {
                     data.ssao = builder.sample(ssao);
                 }
+                if (ssaoDepthPrepass) {
+                    // the color pass uses the SSAO depth buffer
+                    data.depth = ssaoDepth;
+                }
                 data.svp = svp;
                 data.hdrFormat = hdrFormat;
                 data.msaa = msaa;
@@ -343,8 +384,10 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
 
     // FIXME: when the view doesn't ask for a clear, but it's drawn in an intermediate buffer
     //        that buffer needs to be cleared with transparent pixels if blending is enabled
+    // The depth buffer is cleared, unless it already contains the depth pre-pass.
     TargetBufferFlags clearFlags = (TargetBufferFlags(viewClearFlags) & TargetBufferFlags::COLOR)
-                                   | TargetBufferFlags::DEPTH;
+                                   | (ssaoDepthPrepass ? TargetBufferFlags::NONE
+                                                       : TargetBufferFlags::DEPTH);
 
     FrameGraphId<FrameGraphTexture> input;
     input = colorPass(fg, prepareColorPasses.getData(), pass, clearFlags, view.getClearColor());
@@ -361,13 +404,17 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
             TextureFormat::RGBA8 : getLdrFormat(translucent); // e.g. RGB8 or RGBA8
 
     if (hasPostProcess) {
+        // Tonemapping and dithering always happen in the same pass. Both the tonemapping and
+        // FXAA passes sample their input with bilinear filtering at the output's pixel centers,
+        // so the last of them also performs the upscaling, which saves the separate scaling
+        // pass and its full-resolution round trip to memory.
         if (toneMapping) {
             input = ppm.toneMapping(fg, input, ldrFormat, dithering, translucent, fxaa);
         }
         if (fxaa) {
             input = ppm.fxaa(fg, input, ldrFormat, !toneMapping || translucent);
         }
-        if (scaled) {
+        if (scaled && !toneMapping && !fxaa) {
             input = ppm.dynamicScaling(fg, msaa, scaled, blending, input, ldrFormat);
         }
     }
@@ -398,7 +445,7 @@ void FRenderer::renderJob(ArenaScope& arena, FView& view) {
     fg.compile();
     //fg.export_graphviz(slog.d);
 
-    fg.execute(engine, driver);
+    fg.execute(engine, driver, &mGpuTimerManager);
 
     commands.clear();
 
@@ -549,6 +596,12 @@ bool FRenderer::beginFrame(FSwapChain* swapChain, backend::FrameFinishedCallback
         return false;
     }
 
+    // the frame skipper guarantees that the GPU is done with the frame before the previous one,
+    // so its timer queries can be read back.
+    mGpuTimerManager.update(driver, mFrameId - 2);
+    mGpuTimerManager.beginFrame(mFrameId);
+    mFrameStatistics.beginFrame(driver, mFrameId);
+
     // latch the frame time
     std::chrono::duration<double> time{ getUserTime() };
     float h = float(time.count());
@@ -578,11 +631,14 @@ void FRenderer::endFrame() {
         frameInfoManager.endFrame();
     }
     mFrameSkipper.endFrame();
+    mGpuTimerManager.endFrame();
 
+    mFrameStatistics.beginSwap(driver);
     if (mSwapChain) {
         mSwapChain->commit(driver);
         mSwapChain = nullptr;
     }
+    mFrameStatistics.endFrame(driver);
 
     driver.endFrame(mFrameId);
 
@@ -667,10 +723,16 @@ Handle<HwRenderTarget> FRenderer::getRenderTarget(FView& view) const noexcept {
     return viewRenderTarget ? viewRenderTarget : mRenderTarget;
 }
 
-RenderPass::CommandTypeFlags FRenderer::getCommandType(View::DepthPrepass prepass) noexcept {
-    // We are universally disabling the depth prepass for multiple reasons: invariance artifacts
-    // on many platforms, insufficient / negative performance gains, and the complexity it incurs.
-    return RenderPass::COLOR;
+RenderPass::CommandTypeFlags FRenderer::getCommandType(View::DepthPrepass prepass,
+        bool depthPrepassDone) noexcept {
+    // The depth prepass is disabled unless explicitly requested for multiple reasons:
+    // invariance artifacts on some platforms and insufficient / negative performance gains
+    // with cheap shaders.
+    if (prepass != View::DepthPrepass::ENABLED) {
+        return RenderPass::COLOR;
+    }
+    return depthPrepassDone ? RenderPass::COLOR_AFTER_DEPTH_PREPASS
+                            : RenderPass::COLOR_WITH_DEPTH_PREPASS;
 }
 
 } // namespace details
@@ -723,4 +785,12 @@ void Renderer::resetUserTime() {
     upcast(this)->resetUserTime();
 }
 
+Renderer::PassTimingReport Renderer::getPassTimingReport() const noexcept {
+    return upcast(this)->getPassTimingReport();
+}
+
+size_t Renderer::getFrameStatistics(FrameStatistics* out, size_t count) const noexcept {
+    return upcast(this)->getFrameStatistics(out, count);
+}
+
 } // namespace filament
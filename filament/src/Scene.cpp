@@ -33,6 +33,8 @@
 
 #include <algorithm>
 
+#include <string.h>
+
 using namespace filament::math;
 using namespace utils;
 
@@ -120,18 +122,19 @@ void FScene::prepare(const mat4f& worldOriginTransform) {
 
             // we know there is enough space in the array
             sceneData.push_back_unsafe(
-                    ri,                       // RENDERABLE_INSTANCE
-                    worldTransform,           // WORLD_TRANSFORM
-                    reversedWindingOrder,     // REVERSED_WINDING_ORDER
-                    rcm.getVisibility(ri),    // VISIBILITY_STATE
-                    rcm.getBonesUbh(ri),      // BONES_UBH
-                    worldAABB.center,         // WORLD_AABB_CENTER
-                    0,                        // VISIBLE_MASK
-                    rcm.getMorphWeights(ri),  // MORPH_WEIGHTS
-                    rcm.getLayerMask(ri),     // LAYERS
-                    worldAABB.halfExtent,     // WORLD_AABB_EXTENT
-                    {},                       // PRIMITIVES
-                    0                         // SUMMED_PRIMITIVE_COUNT
+                    ri,                              // RENDERABLE_INSTANCE
+                    worldTransform,                  // WORLD_TRANSFORM
+                    reversedWindingOrder,            // REVERSED_WINDING_ORDER
+                    rcm.getVisibility(ri),           // VISIBILITY_STATE
+                    rcm.getBonesUbh(ri),             // BONES_UBH
+                    worldAABB.center,                // WORLD_AABB_CENTER
+                    0,                               // VISIBLE_MASK
+                    rcm.getMorphWeights(ri),         // MORPH_WEIGHTS
+                    rcm.getPositionQuantization(ri), // POSITION_QUANTIZATION
+                    rcm.getLayerMask(ri),            // LAYERS
+                    worldAABB.halfExtent,            // WORLD_AABB_EXTENT
+                    {},                              // PRIMITIVES
+                    0                                // SUMMED_PRIMITIVE_COUNT
             );
         }
 
@@ -171,21 +174,59 @@ void FScene::prepare(const mat4f& worldOriginTransform) {
     }
 }
 
-void FScene::updateUBOs(utils::Range<uint32_t> visibleRenderables, backend::Handle<backend::HwUniformBuffer> renderableUbh) noexcept {
+void FScene::updateUBOs(utils::Range<uint32_t> visibleRenderables,
+        UniformBuffer& renderableUb,
+        backend::Handle<backend::HwUniformBuffer> renderableUbh) noexcept {
     FEngine::DriverApi& driver = mEngine.getDriverApi();
-    const size_t size = visibleRenderables.size() * sizeof(PerRenderableUib);
 
-    // allocate space into the command stream directly
-    void* const buffer = driver.allocate(size);
+    // The per-renderable UBO is indexed by renderable instance (not by index in the SoA, which
+    // changes with visibility), and renderableUb holds a CPU copy of its content. This allows us to
+    // use the previously computed data as a cache and only update (and upload) the renderables
+    // whose inputs changed since the last frame -- in the common case of static objects,
+    // nothing is recomputed or uploaded.
 
     auto& sceneData = mRenderableData;
     for (uint32_t i : visibleRenderables) {
-        mat4f const& model = sceneData.elementAt<WORLD_TRANSFORM>(i);
-        const size_t offset = i * sizeof(PerRenderableUib);
+        mat4f const& world = sceneData.elementAt<WORLD_TRANSFORM>(i);
+        FRenderableManager::Visibility const visibility = sceneData.elementAt<VISIBILITY_STATE>(i);
+        float4 const& morphWeights = sceneData.elementAt<MORPH_WEIGHTS>(i);
+        const size_t offset = getRenderableUboIndex(sceneData, i) * sizeof(PerRenderableUib);
+        assert(offset + sizeof(PerRenderableUib) <= renderableUb.getSize());
+
+        // Note that we cast bools to uint32. Booleans are byte-sized in C++, but we need to
+        // initialize all 32 bits in the UBO field.
+        const uint32_t skinningEnabled = uint32_t(visibility.skinning);
+        const uint32_t morphingEnabled = uint32_t(visibility.morphing);
+
+        // Quantized positions are mapped back to model space by the world-from-model matrix.
+        // Normals are not quantized, so the normal matrix is still computed from the world
+        // transform.
+        mat4f model = world;
+        Box const& quantization = sceneData.elementAt<POSITION_QUANTIZATION>(i);
+        if (UTILS_UNLIKELY(!quantization.isEmpty())) {
+            model = world * mat4f::translation(quantization.center)
+                    * mat4f::scaling(quantization.halfExtent);
+        }
+
+        // Check if the cached data is still valid, we use a bitwise comparison which is cheaper and
+        // makes sure NaNs don't defeat the cache.
+        if (!memcmp(&renderableUb.getUniform<mat4f>(
+                        offset + offsetof(PerRenderableUib, worldFromModelMatrix)),
+                        &model, sizeof(mat4f)) &&
+            !memcmp(&renderableUb.getUniform<float4>(
+                        offset + offsetof(PerRenderableUib, morphWeights)),
+                        &morphWeights, sizeof(float4)) &&
+            renderableUb.getUniform<uint32_t>(
+                        offset + offsetof(PerRenderableUib, skinningEnabled)) == skinningEnabled &&
+            renderableUb.getUniform<uint32_t>(
+                        offset + offsetof(PerRenderableUib, morphingEnabled)) == morphingEnabled) {
+            continue;
+        }
+
+        void* const buffer = renderableUb.invalidateUniforms(offset, sizeof(PerRenderableUib));
 
         UniformBuffer::setUniform(buffer,
-                offset + offsetof(PerRenderableUib, worldFromModelMatrix),
-                model);
+                offsetof(PerRenderableUib, worldFromModelMatrix), model);
 
         // Using mat3f::getTransformForNormals handles non-uniform scaling, but DOESN'T guarantee that
         // the transformed normals will have unit-length, therefore they need to be normalized
@@ -198,28 +239,28 @@ void FScene::updateUBOs(utils::Range<uint32_t> visibleRenderables, backend::Hand
         //
         // Note: if the model matrix is known to be a rigid-transform, we could just use it directly.
 
-        mat3f m = mat3f::getTransformForNormals(model.upperLeft());
+        mat3f m = mat3f::getTransformForNormals(world.upperLeft());
         m *= mat3f(1.0f / std::sqrt(max(float3{length2(m[0]), length2(m[1]), length2(m[2])})));
 
         UniformBuffer::setUniform(buffer,
-                offset + offsetof(PerRenderableUib, worldFromModelNormalMatrix), m);
-
-        // Note that we cast bools to uint32. Booleans are byte-sized in C++, but we need to
-        // initialize all 32 bits in the UBO field.
+                offsetof(PerRenderableUib, worldFromModelNormalMatrix), m);
 
-        UniformBuffer::setUniform(buffer, offset + offsetof(PerRenderableUib, skinningEnabled),
-                uint32_t(sceneData.elementAt<VISIBILITY_STATE>(i).skinning));
+        UniformBuffer::setUniform(buffer,
+                offsetof(PerRenderableUib, skinningEnabled), skinningEnabled);
 
-        UniformBuffer::setUniform(buffer, offset + offsetof(PerRenderableUib, morphingEnabled),
-                uint32_t(sceneData.elementAt<VISIBILITY_STATE>(i).morphing));
+        UniformBuffer::setUniform(buffer,
+                offsetof(PerRenderableUib, morphingEnabled), morphingEnabled);
 
         UniformBuffer::setUniform(buffer,
-                offset + offsetof(PerRenderableUib, morphWeights), sceneData.elementAt<MORPH_WEIGHTS>(i));
+                offsetof(PerRenderableUib, morphWeights), morphWeights);
     }
 
-    // TODO: handle static objects separately
     mRenderableViewUbh = renderableUbh;
-    driver.loadUniformBuffer(renderableUbh, { buffer, size });
+
+    // upload only what changed
+    if (renderableUb.isDirty()) {
+        renderableUb.uploadDirtyRanges(driver, renderableUbh);
+    }
 }
 
 void FScene::terminate(FEngine& engine) {
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "details/ShadowCasterCuller.h"
+
+#include "components/RenderableManager.h"
+
+#include <utils/Systrace.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <math.h>
+
+using namespace filament::math;
+
+namespace filament {
+namespace details {
+
+ShadowCasterCuller::ShadowCasterCuller() noexcept = default;
+
+Aabb ShadowCasterCuller::toLightSpace(mat4f const& lightView,
+        float3 const& center, float3 const& extent) noexcept {
+    // the light's view matrix is a rigid transform, the extent of the transformed box is
+    // given by the absolute value of the rotation.
+    const float3 c = (lightView * float4{ center, 1 }).xyz;
+    const mat3f r = lightView.upperLeft();
+    const float3 e = abs(r[0]) * extent.x + abs(r[1]) * extent.y + abs(r[2]) * extent.z;
+    return { c - e, c + e };
+}
+
+void ShadowCasterCuller::getCellRange(float2 const& min, float2 const& max,
+        uint2& first, uint2& last) const noexcept {
+    const float2 lo{ 0.0f };
+    const float2 hi{ float(GRID_SIZE - 1) };
+    const float2 a = clamp((min - mGridOrigin) * mGridScale, lo, hi);
+    const float2 b = clamp((max - mGridOrigin) * mGridScale, lo, hi);
+    first = uint2{ uint32_t(a.x), uint32_t(a.y) };
+    last  = uint2{ uint32_t(b.x), uint32_t(b.y) };
+}
+
+void ShadowCasterCuller::buildReceivers(mat4f const& lightView,
+        FScene::RenderableSoa const& soa, uint8_t visibleLayers,
+        Culler::result_type receiverMask) noexcept {
+    SYSTRACE_CALL();
+
+    float3 const* const UTILS_RESTRICT worldAABBCenter = soa.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* const UTILS_RESTRICT worldAABBExtent = soa.data<FScene::WORLD_AABB_EXTENT>();
+    uint8_t const* const UTILS_RESTRICT layers = soa.data<FScene::LAYERS>();
+    auto const* const UTILS_RESTRICT visibility = soa.data<FScene::VISIBILITY_STATE>();
+    Culler::result_type const* const UTILS_RESTRICT visibleMask = soa.data<FScene::VISIBLE_MASK>();
+
+    auto isReceiver = [=](size_t i) {
+        FRenderableManager::Visibility const v = visibility[i];
+        return v.receiveShadows && (layers[i] & visibleLayers) &&
+               (!v.culling || (visibleMask[i] & receiverMask));
+    };
+
+    mLightView = lightView;
+    mFarthestReceiver.fill(std::numeric_limits<float>::infinity());
+
+    // first find the light-space xy bounds of all the receivers, that's our grid
+    Aabb bounds;
+    mHasReceivers = false;
+    for (size_t i = 0, c = soa.size(); i < c; i++) {
+        if (isReceiver(i)) {
+            const Aabb box = toLightSpace(lightView, worldAABBCenter[i], worldAABBExtent[i]);
+            bounds.min = min(bounds.min, box.min);
+            bounds.max = max(bounds.max, box.max);
+            mHasReceivers = true;
+        }
+    }
+    if (!mHasReceivers) {
+        return;
+    }
+
+    const float2 size = bounds.max.xy - bounds.min.xy;
+    mGridOrigin = bounds.min.xy;
+    mGridScale = float2{
+            size.x > 0 ? GRID_SIZE / size.x : 0.0f,
+            size.y > 0 ? GRID_SIZE / size.y : 0.0f };
+
+    // then record the farthest receiver in each cell
+    for (size_t i = 0, c = soa.size(); i < c; i++) {
+        if (isReceiver(i)) {
+            const Aabb box = toLightSpace(lightView, worldAABBCenter[i], worldAABBExtent[i]);
+            uint2 first, last;
+            getCellRange(box.min.xy, box.max.xy, first, last);
+            for (size_t y = first.y; y <= last.y; y++) {
+                for (size_t x = first.x; x <= last.x; x++) {
+                    float& farthest = mFarthestReceiver[x + y * GRID_SIZE];
+                    farthest = std::min(farthest, box.min.z);
+                }
+            }
+        }
+    }
+}
+
+size_t ShadowCasterCuller::cullCasters(FScene::RenderableSoa& soa,
+        Culler::result_type casterMask) const noexcept {
+    SYSTRACE_CALL();
+
+    float3 const* const UTILS_RESTRICT worldAABBCenter = soa.data<FScene::WORLD_AABB_CENTER>();
+    float3 const* const UTILS_RESTRICT worldAABBExtent = soa.data<FScene::WORLD_AABB_EXTENT>();
+    Culler::result_type* const UTILS_RESTRICT visibleMask = soa.data<FScene::VISIBLE_MASK>();
+
+    const float2 gridMin = mGridOrigin;
+    const float2 gridMax = mGridOrigin + float2{
+            mGridScale.x > 0 ? GRID_SIZE / mGridScale.x : 0.0f,
+            mGridScale.y > 0 ? GRID_SIZE / mGridScale.y : 0.0f };
+
+    size_t culled = 0;
+    for (size_t i = 0, c = soa.size(); i < c; i++) {
+        if (!(visibleMask[i] & casterMask)) {
+            continue;
+        }
+
+        bool shadowsReceiver = false;
+        if (mHasReceivers) {
+            const Aabb box = toLightSpace(mLightView, worldAABBCenter[i], worldAABBExtent[i]);
+            // the caster's extrusion away from the light must overlap the receivers' grid...
+            if (box.max.x >= gridMin.x && box.min.x <= gridMax.x &&
+                box.max.y >= gridMin.y && box.min.y <= gridMax.y) {
+                // ...and a receiver must be behind the caster's nearest point to the light
+                // (i.e. its highest z) in at least one of the cells it covers.
+                uint2 first, last;
+                getCellRange(box.min.xy, box.max.xy, first, last);
+                for (size_t y = first.y; y <= last.y && !shadowsReceiver; y++) {
+                    for (size_t x = first.x; x <= last.x; x++) {
+                        if (mFarthestReceiver[x + y * GRID_SIZE] <= box.max.z) {
+                            shadowsReceiver = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (!shadowsReceiver) {
+            visibleMask[i] &= ~casterMask;
+            culled++;
+        }
+    }
+    return culled;
+}
+
+} // namespace details
+} // namespace filament
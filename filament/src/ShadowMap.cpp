@@ -28,6 +28,10 @@
 
 #include <backend/DriverEnums.h>
 
+#include <math/scalar.h>
+
+#include <utils/Systrace.h>
+
 #include <limits>
 
 using namespace filament::math;
@@ -47,12 +51,15 @@ ShadowMap::ShadowMap(FEngine& engine) noexcept :
         mEngine(engine),
         mClipSpaceFlipped(engine.getBackend() == Backend::VULKAN ||
                           engine.getBackend() == Backend::METAL) {
-    mCamera = mEngine.createCamera(EntityManager::get().create());
+    for (Cascade& cascade : mCascades) {
+        cascade.camera = mEngine.createCamera(EntityManager::get().create());
+    }
     mDebugCamera = mEngine.createCamera(EntityManager::get().create());
     FDebugRegistry& debugRegistry = engine.getDebugRegistry();
     debugRegistry.registerProperty("d.shadowmap.focus_shadowcasters", &engine.debug.shadowmap.focus_shadowcasters);
     debugRegistry.registerProperty("d.shadowmap.far_uses_shadowcasters", &engine.debug.shadowmap.far_uses_shadowcasters);
     debugRegistry.registerProperty("d.shadowmap.checkerboard", &engine.debug.shadowmap.checkerboard);
+    debugRegistry.registerProperty("d.shadowmap.receiver_culling", &engine.debug.shadowmap.receiver_culling);
     if (ENABLE_LISPSM) {
         debugRegistry.registerProperty("d.shadowmap.lispsm", &engine.debug.shadowmap.lispsm);
         debugRegistry.registerProperty("d.shadowmap.dzn", &engine.debug.shadowmap.dzn);
@@ -61,12 +68,15 @@ ShadowMap::ShadowMap(FEngine& engine) noexcept :
 }
 
 ShadowMap::~ShadowMap() {
-    mEngine.destroy(mCamera->getEntity());
+    for (Cascade& cascade : mCascades) {
+        mEngine.destroy(cascade.camera->getEntity());
+    }
     mEngine.destroy(mDebugCamera->getEntity());
 }
 
 UTILS_NOINLINE
 void ShadowMap::fillWithDebugPattern(backend::DriverApi& driverApi) const noexcept {
+    // note: this only fills the first layer, i.e. the first cascade
     const size_t dim = mShadowMapDimension;
     size_t size = dim * dim;
     uint8_t* ptr = (uint8_t*)malloc(size);
@@ -86,19 +96,14 @@ void ShadowMap::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
 
     uint32_t dim = mShadowMapDimension;
     uint32_t currentDimension = mViewport.width + 2;
-    if (currentDimension == dim) {
+    if (currentDimension == dim && mLayerCount == mCascadeCount) {
         // nothing to do here.
         assert(mShadowMapHandle);
         return;
     }
 
-    // destroy the current rendertarget and texture
-    if (mShadowMapRenderTarget) {
-        driver.destroyRenderTarget(mShadowMapRenderTarget);
-    }
-    if (mShadowMapHandle) {
-        driver.destroyTexture(mShadowMapHandle);
-    }
+    // destroy the current rendertargets and texture
+    terminate(driver);
 
     // allocate new ones...
     // we set a viewport with a 1-texel border for when we index outside of the texture
@@ -127,13 +132,21 @@ void ShadowMap::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
             break;
     }
 
+    // each cascade is rendered in its own layer of a texture array, so that the shader can
+    // pick the cascade dynamically with a single sampler.
+    mLayerCount = mCascadeCount;
     mShadowMapHandle = driver.createTexture(
-            SamplerType::SAMPLER_2D, 1, format, 1, dim, dim, 1,
+            SamplerType::SAMPLER_2D_ARRAY, 1, format, 1, dim, dim, mLayerCount,
             TextureUsage::DEPTH_ATTACHMENT | TextureUsage::SAMPLEABLE);
 
-    mShadowMapRenderTarget = driver.createRenderTarget(
-            TargetBufferFlags::DEPTH, dim, dim, 1,
-            {}, { mShadowMapHandle }, {});
+    for (size_t i = 0; i < mLayerCount; i++) {
+        mCascades[i].renderTarget = driver.createRenderTarget(
+                TargetBufferFlags::DEPTH, dim, dim, 1,
+                {}, { mShadowMapHandle, 0, uint16_t(i) }, {});
+    }
+
+    // the content of the new shadow map is undefined
+    invalidateCache();
 
     sb.setSampler(PerViewSib::SHADOW_MAP, {
         mShadowMapHandle, {
@@ -144,12 +157,15 @@ void ShadowMap::prepare(DriverApi& driver, SamplerGroup& sb) noexcept {
             }});
 }
 
-void ShadowMap::render(DriverApi& driver, RenderPass& pass, FView& view) noexcept {
+void ShadowMap::render(DriverApi& driver, RenderPass const& pass, FView& view) noexcept {
+    SYSTRACE_CONTEXT();
+
     FEngine& engine = mEngine;
 
     if (UTILS_UNLIKELY(engine.debug.shadowmap.checkerboard)) {
         // TODO: eventually this will be handled as a optional pass in the framefraph
         fillWithDebugPattern(driver);
+        invalidateCache();
         return;
     }
 
@@ -167,37 +183,157 @@ void ShadowMap::render(DriverApi& driver, RenderPass& pass, FView& view) noexcep
     // the inset-by-1 rectangle.
     params.flags.ignoreScissor = true;
 
-    FCamera const& camera = getCamera();
-    details::CameraInfo cameraInfo = {
-            .projection         = mat4f{ camera.getProjectionMatrix() },
-            .cullingProjection  = mat4f{ camera.getCullingProjectionMatrix() },
-            .model              = camera.getModelMatrix(),
-            .view               = camera.getViewMatrix(),
-            .zn                 = camera.getNear(),
-            .zf                 = camera.getCullingFar(),
-    };
-    pass.setCamera(cameraInfo);
-
     FView::Range visibleRenderables = view.getVisibleShadowCasters();
-    pass.setGeometry(scene.getRenderableData(), visibleRenderables, scene.getRenderableUBO());
 
-    view.updatePrimitivesLod(engine, cameraInfo, scene.getRenderableData(), visibleRenderables);
-    view.prepareCamera(cameraInfo, viewport);
-    view.commitUniforms(driver);
+    size_t renderedCount = 0;
+    for (size_t i = 0, c = mCascadeCount; i < c; i++) {
+        Cascade& cascade = mCascades[i];
+        if (!cascade.hasVisibleShadows) {
+            // the shader can still select this cascade, just clear it so that it's fully lit
+            driver.beginRenderPass(cascade.renderTarget, params);
+            driver.endRenderPass();
+            cascade.cacheValid = false;
+            continue;
+        }
+
+        FCamera const& camera = *cascade.camera;
+        details::CameraInfo cameraInfo = {
+                .projection         = mat4f{ camera.getProjectionMatrix() },
+                .cullingProjection  = mat4f{ camera.getCullingProjectionMatrix() },
+                .model              = camera.getModelMatrix(),
+                .view               = camera.getViewMatrix(),
+                .zn                 = camera.getNear(),
+                .zf                 = camera.getCullingFar(),
+        };
+
+        // each cascade records its commands in a new command buffer, so that it only sorts and
+        // draws its own commands, not the ones of the previous cascades.
+        const Culler::result_type visibilityMask = FView::getShadowCascadeVisibilityMask(i);
+        RenderPass cascadePass(pass);
+        cascadePass.setCamera(cameraInfo);
+        cascadePass.setVisibilityMask(visibilityMask);
+        cascadePass.setGeometry(scene.getRenderableData(), visibleRenderables,
+                scene.getRenderableUBO());
+
+        view.updatePrimitivesLod(engine, cameraInfo, scene.getRenderableData(), visibleRenderables);
+
+        if (mCachingEnabled) {
+            // this must be done after the level of details have been selected
+            // the whole key is compared, so that a stale shadow map is never reused
+            const bool cacheable = computeCacheKey(mCacheKey, camera,
+                    scene.getRenderableData(), visibleRenderables, visibilityMask);
+            if (cascade.cacheValid && mCacheKey == cascade.cacheKey) {
+                continue;
+            }
+            std::swap(cascade.cacheKey, mCacheKey);
+            cascade.cacheValid = cacheable;
+        }
+        renderedCount++;
+
+        view.prepareCamera(cameraInfo, viewport);
+        view.commitUniforms(driver);
+
+        cascadePass.overridePolygonOffset(&mPolygonOffset);
+        cascadePass.newCommandBuffer();
+        cascadePass.appendCommands(RenderPass::SHADOW);
+        cascadePass.sortCommands();
+        // at most one command per primitive of the casters, whatever the cascade count
+        assert(visibleRenderables.empty() || cascadePass.getCommands().size() <=
+                FScene::getPrimitiveCount(scene.getRenderableData(), visibleRenderables.last));
+        cascadePass.execute("Shadow map Pass", cascade.renderTarget, params);
+    }
+
+    if (renderedCount) {
+        mCacheStats.renderedFrameCount++;
+    } else {
+        mCacheStats.cachedFrameCount++;
+    }
+    SYSTRACE_VALUE32("shadowMapCached", renderedCount ? 0 : 1);
+}
 
-    pass.overridePolygonOffset(&mPolygonOffset);
-    pass.appendCommands(RenderPass::SHADOW);
-    pass.sortCommands();
-    pass.execute("Shadow map Pass", getRenderTarget(), params);
+void ShadowMap::setCachingEnabled(bool enabled) noexcept {
+    mCachingEnabled = enabled;
+    invalidateCache();
+}
+
+void ShadowMap::invalidateCache() noexcept {
+    for (Cascade& cascade : mCascades) {
+        cascade.cacheValid = false;
+    }
+}
+
+bool ShadowMap::computeCacheKey(std::vector<uint32_t>& key, FCamera const& camera,
+        FScene::RenderableSoa const& renderableData, Range<uint32_t> casters,
+        Culler::result_type visibilityMask) const noexcept {
+    SYSTRACE_CALL();
+
+    auto const* UTILS_RESTRICT visibleMask = renderableData.data<FScene::VISIBLE_MASK>();
+    auto const* UTILS_RESTRICT instances  = renderableData.data<FScene::RENDERABLE_INSTANCE>();
+    auto const* UTILS_RESTRICT transforms = renderableData.data<FScene::WORLD_TRANSFORM>();
+    auto const* UTILS_RESTRICT bones      = renderableData.data<FScene::BONES_UBH>();
+    auto const* UTILS_RESTRICT morphing   = renderableData.data<FScene::MORPH_WEIGHTS>();
+    auto const* UTILS_RESTRICT primitives = renderableData.data<FScene::PRIMITIVES>();
+
+    struct {
+        mat4f projection;
+        mat4f view;
+        float polygonOffset[2];
+        uint32_t dimension;
+        uint32_t casterCount;
+    } light = {
+            .projection = mat4f{ camera.getProjectionMatrix() },
+            .view = camera.getViewMatrix(),
+            .polygonOffset = { mPolygonOffset.slope, mPolygonOffset.constant },
+            .dimension = mShadowMapDimension,
+            .casterCount = uint32_t(casters.size())
+    };
+    // the key is made of the raw words of the data, its storage is reused from frame to frame
+    auto append = [&key](auto const& data) {
+        static_assert(sizeof(data) % 4 == 0, "key data must be made of 32-bit words");
+        uint32_t const* const words = reinterpret_cast<uint32_t const*>(&data);
+        key.insert(key.end(), words, words + sizeof(data) / 4);
+    };
+    key.clear();
+    append(light);
+
+    // skinning can change the casters' geometry without us knowing about it
+    bool cacheable = true;
+    for (uint32_t i : casters) {
+        if (!(visibleMask[i] & visibilityMask)) {
+            // not in this cascade
+            continue;
+        }
+        struct {
+            uint64_t primitives;
+            uint32_t primitiveCount;
+            uint32_t instance;
+            mat4f transform;
+            float4 morphWeights;
+        } caster = {
+                .primitives = uint64_t(uintptr_t(primitives[i].data())),
+                .primitiveCount = uint32_t(primitives[i].size()),
+                .instance = instances[i].asValue(),
+                .transform = transforms[i],
+                .morphWeights = morphing[i]
+        };
+        append(caster);
+        cacheable = cacheable && !bones[i];
+    }
+    return cacheable;
 }
 
 void ShadowMap::terminate(DriverApi& driverApi) noexcept {
-    if (mShadowMapRenderTarget) {
-        driverApi.destroyRenderTarget(mShadowMapRenderTarget);
+    for (Cascade& cascade : mCascades) {
+        if (cascade.renderTarget) {
+            driverApi.destroyRenderTarget(cascade.renderTarget);
+            cascade.renderTarget.clear();
+        }
     }
     if (mShadowMapHandle) {
         driverApi.destroyTexture(mShadowMapHandle);
+        mShadowMapHandle.clear();
     }
+    mLayerCount = 0;
 }
 
 void ShadowMap::update(
@@ -215,33 +351,8 @@ void ShadowMap::update(
             .slope = params.options.polygonOffsetSlope,
             .constant = params.options.polygonOffsetConstant
     };
-    mat4f projection(camera.cullingProjection);
-    if (params.options.shadowFar > 0.0f) {
-        float n = camera.zn;
-        float f = params.options.shadowFar;
-        if (std::abs(projection[2].w) <= std::numeric_limits<float>::epsilon()) {
-            // perspective projection
-            projection[2].z =     (f + n) / (n - f);
-            projection[3].z = (2 * f * n) / (n - f);
-        } else {
-            // ortho projection
-            projection[2].z =    2.0f / (n - f);
-            projection[3].z = (f + n) / (n - f);
-        }
-    }
-
-    CameraInfo cameraInfo = {
-            .projection = projection,
-            .model = camera.model,
-            .view = camera.view,
-            .worldOrigin = camera.worldOrigin,
-            .zn = camera.zn,
-            .zf = camera.zf,
-            .frustum = Frustum(projection * camera.view)
-    };
-
     // debugging...
-    const float dz = cameraInfo.zf - cameraInfo.zn;
+    const float dz = camera.zf - camera.zn;
     float& dzn = mEngine.debug.shadowmap.dzn;
     float& dzf = mEngine.debug.shadowmap.dzf;
     if (dzn < 0)    dzn = std::max(0.0f, params.options.shadowNearHint - camera.zn) / dz;
@@ -250,14 +361,97 @@ void ShadowMap::update(
     else            params.options.shadowFarHint = dzf * dz + camera.zf;
 
 
+    mHasVisibleShadows = false;
+    mCascadeCount = 1;
+    mCascadeSplits = std::numeric_limits<float>::infinity();
+    for (Cascade& cascade : mCascades) {
+        cascade.hasVisibleShadows = false;
+    }
+
     using Type = FLightManager::Type;
     switch (lcm.getType(li)) {
         case Type::SUN:
-        case Type::DIRECTIONAL:
-            computeShadowCameraDirectional(
-                    lightData.elementAt<FScene::DIRECTION>(index), scene, cameraInfo, params,
-                    visibleLayers);
+        case Type::DIRECTIONAL: {
+            const float3 dir = lightData.elementAt<FScene::DIRECTION>(index);
+
+            /*
+             * Compute the light's model matrix
+             * (direction & position)
+             *
+             * The light's model matrix contains the light position and direction.
+             *
+             * For directional lights, we could choose any position; we pick the camera position
+             * so we have a fixed reference -- that's "not too far" from the scene.
+             */
+            const float3 lightPosition = camera.getPosition();
+            const mat4f M = mat4f::lookAt(lightPosition, lightPosition + dir, float3{ 0, 1, 0 });
+            const mat4f Mv = FCamera::rigidTransformInverse(M);
+            mLightView = Mv;
+
+            // Compute scene bounds in world space, as well as the light-space near/far planes.
+            // These don't depend on the cascade, so we only visit the scene once.
+            SceneBounds sceneBounds;
+            float2& nearFar = sceneBounds.lsNearFar;
+            nearFar = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max() };
+            visitScene(*scene, visibleLayers,
+                    [&sceneBounds, &Mv, &nearFar](Aabb caster) {
+                        Aabb& volume = sceneBounds.wsShadowCastersVolume;
+                        volume.min = min(volume.min, caster.min);
+                        volume.max = max(volume.max, caster.max);
+                        float2 nf = computeNearFar(Mv, caster);
+                        nearFar.x = std::max(nearFar.x, nf.x);  // near
+                        nearFar.y = std::min(nearFar.y, nf.y);  // far
+                    },
+                    [&sceneBounds](Aabb receiver) {
+                        Aabb& volume = sceneBounds.wsShadowReceiversVolume;
+                        volume.min = min(volume.min, receiver.min);
+                        volume.max = max(volume.max, receiver.max);
+                    }
+            );
+
+            if (sceneBounds.wsShadowCastersVolume.isEmpty() ||
+                sceneBounds.wsShadowReceiversVolume.isEmpty()) {
+                return;
+            }
+
+            const float n = camera.zn;
+            const float f = params.options.shadowFar > 0.0f ? params.options.shadowFar : camera.zf;
+            mCascadeCount = uint8_t(std::min(std::max(size_t(params.options.shadowCascades),
+                    size_t(1)), CONFIG_MAX_SHADOW_CASCADES));
+            mCascadeSplits = computeCascadeSplits(params.options, mCascadeCount, n, f);
+
+            for (size_t i = 0; i < mCascadeCount; i++) {
+                // restrict the camera's projection to this cascade's slice of the view frustum
+                const float zn = i ? mCascadeSplits[i - 1] : n;
+                const float zf = std::min(mCascadeSplits[i], f);
+                mat4f projection(camera.cullingProjection);
+                if (std::abs(projection[2].w) <= std::numeric_limits<float>::epsilon()) {
+                    // ortho projection
+                    projection[2].z =    2.0f / (zn - zf);
+                    projection[3].z = (zf + zn) / (zn - zf);
+                } else {
+                    // perspective projection
+                    projection[2].z =     (zf + zn) / (zn - zf);
+                    projection[3].z = (2 * zf * zn) / (zn - zf);
+                }
+
+                const CameraInfo cameraInfo = {
+                        .projection = projection,
+                        .model = camera.model,
+                        .view = camera.view,
+                        .worldOrigin = camera.worldOrigin,
+                        .zn = zn,
+                        .zf = zf,
+                        .frustum = Frustum(projection * camera.view)
+                };
+
+                Cascade& cascade = mCascades[i];
+                computeShadowCameraDirectional(cascade, i == 0 ? mDebugCamera : nullptr,
+                        dir, Mv, sceneBounds, cameraInfo, params);
+                mHasVisibleShadows = mHasVisibleShadows || cascade.hasVisibleShadows;
+            }
             break;
+        }
         case Type::FOCUSED_SPOT:
         case Type::SPOT:
             break;
@@ -266,46 +460,47 @@ void ShadowMap::update(
     }
 }
 
-void ShadowMap::computeShadowCameraDirectional(
-        float3 const& dir, FScene const* scene, CameraInfo const& camera,
-        FLightManager::ShadowParams const& params,
-        uint8_t visibleLayers) noexcept {
-
-    /*
-     * Compute the light's model matrix
-     * (direction & position)
-     *
-     * The light's model matrix contains the light position and direction.
-     *
-     * For directional lights, we could choose any position; we pick the camera position
-     * so we have a fixed reference -- that's "not too far" from the scene.
-     */
-    const float3 lightPosition = camera.getPosition();
-    const mat4f M = mat4f::lookAt(lightPosition, lightPosition + dir, float3{ 0, 1, 0 });
-    const mat4f Mv = FCamera::rigidTransformInverse(M);
-
+float4 ShadowMap::computeCascadeSplits(LightManager::ShadowOptions const& options,
+        size_t cascadeCount, float near, float far) noexcept {
+    float4 splits{ std::numeric_limits<float>::infinity() };
+    // the logarithmic scheme is undefined when near <= 0 (e.g. with an infinite or a
+    // reversed projection), in which case we fall back to uniform splits.
+    const bool hasLogarithmic = near > 0.0f && far > near;
+    for (size_t i = 1; i < cascadeCount; i++) {
+        const float t = float(i) / float(cascadeCount);
+        const float uniform = near + (far - near) * t;
+        const float logarithmic = hasLogarithmic ? near * std::pow(far / near, t) : uniform;
+        float split = uniform;
+        switch (options.cascadeSplitScheme) {
+            case LightManager::CascadeSplitScheme::UNIFORM:
+                split = uniform;
+                break;
+            case LightManager::CascadeSplitScheme::LOGARITHMIC:
+                split = logarithmic;
+                break;
+            case LightManager::CascadeSplitScheme::PRACTICAL:
+                split = mix(uniform, logarithmic, saturate(options.cascadeSplitLambda));
+                break;
+            case LightManager::CascadeSplitScheme::CUSTOM:
+                split = near + (far - near) * saturate(options.cascadeSplitPositions[i - 1]);
+                break;
+        }
+        // splits must be increasing
+        splits[i - 1] = i > 1 ? std::max(split, splits[i - 2]) : split;
+    }
+    // the last cascade ends at the far plane, but we leave it at +infinity so that
+    // everything past the shadow far plane selects it.
+    return splits;
+}
 
-    // Compute scene bounds in world space, as well as the light-space near/far planes
-    float2 nearFar = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max() };
-    Aabb wsShadowCastersVolume, wsShadowReceiversVolume;
-    visitScene(*scene, visibleLayers,
-            [&wsShadowCastersVolume, &Mv, &nearFar](Aabb caster) {
-                wsShadowCastersVolume.min = min(wsShadowCastersVolume.min, caster.min);
-                wsShadowCastersVolume.max = max(wsShadowCastersVolume.max, caster.max);
-                float2 nf = computeNearFar(Mv, caster);
-                nearFar.x = std::max(nearFar.x, nf.x);  // near
-                nearFar.y = std::min(nearFar.y, nf.y);  // far
-            },
-            [&wsShadowReceiversVolume](Aabb receiver) {
-                wsShadowReceiversVolume.min = min(wsShadowReceiversVolume.min, receiver.min);
-                wsShadowReceiversVolume.max = max(wsShadowReceiversVolume.max, receiver.max);
-            }
-    );
+void ShadowMap::computeShadowCameraDirectional(Cascade& cascade, FCamera* debugCamera,
+        float3 const& dir, mat4f const& Mv, SceneBounds const& sceneBounds,
+        CameraInfo const& camera, FLightManager::ShadowParams const& params) noexcept {
 
-    if (wsShadowCastersVolume.isEmpty() || wsShadowReceiversVolume.isEmpty()) {
-        mHasVisibleShadows = false;
-        return;
-    }
+    cascade.hasVisibleShadows = false;
+    float2 const& nearFar = sceneBounds.lsNearFar;
+    Aabb const& wsShadowCastersVolume = sceneBounds.wsShadowCastersVolume;
+    Aabb const& wsShadowReceiversVolume = sceneBounds.wsShadowReceiversVolume;
 
     // view frustum vertices in world-space
     float3 wsViewFrustumVertices[8];
@@ -357,7 +552,6 @@ void ShadowMap::computeShadowCameraDirectional(
 
     // if znear >= zfar, it means we don't have any shadow caster in front of a shadow receiver
     if (UTILS_UNLIKELY(znear >= zfar)) {
-        mHasVisibleShadows = false;
         return;
     }
 
@@ -381,8 +575,7 @@ void ShadowMap::computeShadowCameraDirectional(
         }
     }
 
-    mHasVisibleShadows = vertexCount >= 2;
-    if (mHasVisibleShadows) {
+    if (vertexCount >= 2) {
         // We can't use LISPSM in stable mode
         const bool USE_LISPSM = ENABLE_LISPSM && mEngine.debug.shadowmap.lispsm && !params.options.stable;
 
@@ -465,7 +658,6 @@ void ShadowMap::computeShadowCameraDirectional(
                            (lsLightFrustumBounds.min.y >= lsLightFrustumBounds.max.y))) {
             // this could happen if the only thing visible is a perfectly horizontal or
             // vertical thin line
-            mHasVisibleShadows = false;
             return;
         }
 
@@ -504,22 +696,25 @@ void ShadowMap::computeShadowCameraDirectional(
         // note: in texelSizeWorldSpace() below, we could use Mb * Mt * F * W because
         // L * Mp * Mv is a rigid transform (for directional lights)
         if (USE_LISPSM) {
-            mTexelSizeWs = texelSizeWorldSpace(Wp, MbMt * F);
+            cascade.texelSizeWs = texelSizeWorldSpace(Wp, MbMt * F);
         } else {
             // We know we're using an ortho projection
-            mTexelSizeWs = texelSizeWorldSpace(St.upperLeft());
+            cascade.texelSizeWs = texelSizeWorldSpace(St.upperLeft());
         }
-        mLightSpace = St;
+        cascade.lightSpace = St;
+        cascade.hasVisibleShadows = true;
 
         // We apply the constant bias in world space (as opposed to light-space) to account
         // for perspective and lispsm shadow maps. This also allows us to do this at zero-cost
         // by baking it in the shadow-map itself.
 
         const mat4f Sb = S * mat4f::translation(dir * params.options.constantBias);
-        mCamera->setCustomProjection(mat4(Sb), znear, zfar);
+        cascade.camera->setCustomProjection(mat4(Sb), znear, zfar);
 
-        // for the debug camera, we need to undo the world origin
-        mDebugCamera->setCustomProjection(mat4(Sb * camera.worldOrigin), znear, zfar);
+        if (debugCamera) {
+            // for the debug camera, we need to undo the world origin
+            debugCamera->setCustomProjection(mat4(Sb * camera.worldOrigin), znear, zfar);
+        }
     }
 }
 
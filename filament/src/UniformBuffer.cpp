@@ -16,6 +16,11 @@
 
 #include "UniformBuffer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <new>
+
 #include <stdlib.h>
 #include <string.h>
 
@@ -25,29 +30,42 @@ namespace filament {
 
 UniformBuffer::UniformBuffer(size_t size) noexcept
         : mBuffer(mStorage),
-          mSize(uint32_t(size)),
-          mSomethingDirty(true) {
+          mSize(uint32_t(size)) {
     if (UTILS_LIKELY(size > sizeof(mStorage))) {
         mBuffer = UniformBuffer::alloc(size);
     }
     memset(mBuffer, 0, size);
+    invalidate();
 }
 
 UniformBuffer::UniformBuffer(UniformBuffer&& rhs) noexcept
         : mBuffer(rhs.mBuffer),
           mSize(rhs.mSize),
-          mSomethingDirty(rhs.mSomethingDirty) {
+          mDirtyRangeCount(rhs.mDirtyRangeCount),
+          mDirtyRangeCapacity(rhs.mDirtyRangeCapacity),
+          mHeapDirtyRanges(rhs.mHeapDirtyRanges) {
+    if (!mHeapDirtyRanges) {
+        std::copy_n(rhs.mDirtyRanges, rhs.mDirtyRangeCount, mDirtyRanges);
+    }
     if (UTILS_LIKELY(rhs.isLocalStorage())) {
         mBuffer = mStorage;
         memcpy(mBuffer, rhs.mBuffer, mSize);
     }
     rhs.mBuffer = nullptr;
     rhs.mSize = 0;
+    rhs.mDirtyRangeCount = 0;
+    rhs.mDirtyRangeCapacity = MAX_DIRTY_RANGES;
+    rhs.mHeapDirtyRanges = nullptr;
 }
 
 UniformBuffer& UniformBuffer::operator=(UniformBuffer&& rhs) noexcept {
     if (this != &rhs) {
-        mSomethingDirty = rhs.mSomethingDirty;
+        mDirtyRangeCount = rhs.mDirtyRangeCount;
+        std::swap(mDirtyRangeCapacity, rhs.mDirtyRangeCapacity);
+        std::swap(mHeapDirtyRanges, rhs.mHeapDirtyRanges);
+        if (!mHeapDirtyRanges) {
+            std::copy_n(rhs.mDirtyRanges, rhs.mDirtyRangeCount, mDirtyRanges);
+        }
         if (UTILS_LIKELY(rhs.isLocalStorage())) {
             mBuffer = mStorage;
             mSize = rhs.mSize;
@@ -81,6 +99,136 @@ UniformBuffer& UniformBuffer::setUniforms(const UniformBuffer& rhs) noexcept {
     return *this;
 }
 
+void UniformBuffer::addDirtyRangeSlow(uint32_t begin, uint32_t end) noexcept {
+    DirtyRange* UTILS_RESTRICT ranges = getDirtyRanges();
+    size_t count = mDirtyRangeCount;
+
+    // find the insertion point, ranges are kept sorted by offset
+    size_t i = 0;
+    while (i < count && ranges[i].end < begin) {
+        i++;
+    }
+
+    if (i < count && ranges[i].begin <= end) {
+        // the new range touches range i, coalesce it and all the following ranges it reaches
+        ranges[i].begin = std::min(ranges[i].begin, begin);
+        ranges[i].end = std::max(ranges[i].end, end);
+        size_t j = i + 1;
+        while (j < count && ranges[j].begin <= ranges[i].end) {
+            ranges[i].end = std::max(ranges[i].end, ranges[j].end);
+            j++;
+        }
+        std::copy(ranges + j, ranges + count, ranges + i + 1);
+        count -= j - (i + 1);
+    } else {
+        if (UTILS_UNLIKELY(count == mDirtyRangeCapacity)) {
+            // we're out of ranges, merge the two ranges separated by the smallest gap, this
+            // minimizes the amount of clean data we'll upload.
+            size_t k = 0;
+            uint32_t gap = std::numeric_limits<uint32_t>::max();
+            for (size_t r = 0; r < count - 1; r++) {
+                if (ranges[r + 1].begin - ranges[r].end < gap) {
+                    gap = ranges[r + 1].begin - ranges[r].end;
+                    k = r;
+                }
+            }
+            // also consider the gaps with the new range
+            const uint32_t gapBefore = i > 0 ?
+                    begin - ranges[i - 1].end : std::numeric_limits<uint32_t>::max();
+            const uint32_t gapAfter = i < count ?
+                    ranges[i].begin - end : std::numeric_limits<uint32_t>::max();
+            if (std::min({ gap, gapBefore, gapAfter }) > MAX_MERGED_GAP) {
+                // all the ranges are far apart, merging any of them would upload too much clean
+                // data, track more ranges instead.
+                ranges = growDirtyRanges();
+            } else if (gapBefore < gap) {
+                // merge the new range into its predecessor
+                ranges[i - 1].end = end;
+                mDirtyRangeCount = uint32_t(count);
+                return;
+            } else if (gapAfter < gap) {
+                // merge the new range into its successor
+                ranges[i].begin = begin;
+                mDirtyRangeCount = uint32_t(count);
+                return;
+            } else {
+                ranges[k].end = ranges[k + 1].end;
+                std::copy(ranges + k + 2, ranges + count, ranges + k + 1);
+                count--;
+                if (k < i) {
+                    i--;
+                }
+            }
+        }
+        std::copy_backward(ranges + i, ranges + count, ranges + count + 1);
+        ranges[i] = { begin, end };
+        count++;
+    }
+    mDirtyRangeCount = uint32_t(count);
+}
+
+UniformBuffer::DirtyRange* UniformBuffer::growDirtyRanges() noexcept {
+    // there can't be more than one range per MAX_MERGED_GAP bytes, so this doesn't grow unbounded
+    const uint32_t capacity = mDirtyRangeCapacity * 2;
+    DirtyRange* const ranges = static_cast<DirtyRange*>(
+            UniformBuffer::alloc(capacity * sizeof(DirtyRange)));
+    std::copy_n(getDirtyRanges(), mDirtyRangeCount, ranges);
+    if (mHeapDirtyRanges) {
+        UniformBuffer::free(mHeapDirtyRanges, mDirtyRangeCapacity * sizeof(DirtyRange));
+    }
+    mHeapDirtyRanges = ranges;
+    mDirtyRangeCapacity = capacity;
+    return ranges;
+}
+
+size_t UniformBuffer::uploadDirtyRanges(backend::DriverApi& driver,
+        backend::UniformBufferHandle ubh) const noexcept {
+    const size_t size = getDirtySize();
+    if (UTILS_LIKELY(size <= MAX_COMMAND_STREAM_STAGING_SIZE)) {
+        return uploadDirtyRanges(driver, ubh, driver.allocate(size));
+    }
+
+    // The command stream has a limited size per frame, large uploads (e.g. a freshly created
+    // buffer) are staged in the heap instead. All the ranges share a single allocation, which
+    // holds a count of the commands still referencing it.
+    constexpr size_t headerSize = 16;
+    char* const block = static_cast<char*>(::malloc(headerSize + size));
+    new(block) std::atomic<uint32_t>(mDirtyRangeCount);
+    auto release = [](void*, size_t, void* user) {
+        if (static_cast<std::atomic<uint32_t>*>(user)->fetch_sub(1) == 1) {
+            ::free(user);
+        }
+    };
+
+    char* UTILS_RESTRICT p = block + headerSize;
+    char const* const UTILS_RESTRICT src = static_cast<char const*>(getBuffer());
+    DirtyRange const* const ranges = getDirtyRanges();
+    for (size_t i = 0, c = mDirtyRangeCount; i < c; i++) {
+        DirtyRange const& range = ranges[i];
+        memcpy(p, src + range.begin, range.size());
+        driver.updateUniformBuffer(ubh, { p, range.size(), release, block }, range.begin);
+        p += range.size();
+    }
+    clean();
+    return size;
+}
+
+size_t UniformBuffer::uploadDirtyRanges(backend::DriverApi& driver,
+        backend::UniformBufferHandle ubh, void* staging) const noexcept {
+    char* UTILS_RESTRICT p = static_cast<char*>(staging);
+    char const* const UTILS_RESTRICT src = static_cast<char const*>(getBuffer());
+    DirtyRange const* const ranges = getDirtyRanges();
+    for (size_t i = 0, c = mDirtyRangeCount; i < c; i++) {
+        DirtyRange const& range = ranges[i];
+        memcpy(p, src + range.begin, range.size());
+        // the data lives in the command stream, it doesn't need a callback
+        driver.updateUniformBuffer(ubh, { p, range.size() }, range.begin);
+        p += range.size();
+    }
+    clean();
+    return size_t(p - static_cast<char*>(staging));
+}
+
 void* UniformBuffer::alloc(size_t size) noexcept {
     // these allocations have a long life span
     return ::malloc(size);
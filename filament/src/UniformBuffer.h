@@ -62,14 +62,34 @@ public:
             // test not necessary but avoids a call to libc (and this is a common enough case)
             UniformBuffer::free(mBuffer, mSize);
         }
+        if (UTILS_UNLIKELY(mHeapDirtyRanges)) {
+            UniformBuffer::free(mHeapDirtyRanges, mDirtyRangeCapacity * sizeof(DirtyRange));
+        }
     }
 
     UniformBuffer& setUniforms(const UniformBuffer& rhs) noexcept;
 
+    // number of disjoint dirty ranges tracked before they get merged together
+    static constexpr size_t MAX_DIRTY_RANGES = 4;
+
+    // Ranges further apart than this are never merged, more ranges are allocated instead. This
+    // bounds the amount of clean data uploaded when a large buffer has scattered updates.
+    static constexpr size_t MAX_MERGED_GAP = 512;
+
+    // uploads larger than this are staged in the heap rather than in the command stream
+    static constexpr size_t MAX_COMMAND_STREAM_STAGING_SIZE = 64 * 1024;
+
+    // a range of modified bytes, [begin, end)
+    struct DirtyRange {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t size() const noexcept { return end - begin; }
+    };
+
     // invalidate a range of uniforms and return a pointer to it. offset and size given in bytes
     void* invalidateUniforms(size_t offset, size_t size) {
         assert(offset + size <= mSize);
-        mSomethingDirty = true;
+        addDirtyRange(uint32_t(offset), uint32_t(offset + size));
         return static_cast<char*>(mBuffer) + offset;
     }
 
@@ -84,10 +104,28 @@ public:
     size_t getSize() const noexcept { return mSize; }
 
     // return if any uniform has been changed
-    bool isDirty() const noexcept { return mSomethingDirty; }
+    bool isDirty() const noexcept { return mDirtyRangeCount != 0; }
 
     // mark the whole buffer as clean (no modified uniforms)
-    void clean() const noexcept { mSomethingDirty = false; }
+    void clean() const noexcept { mDirtyRangeCount = 0; }
+
+    // number of disjoint modified ranges, sorted by offset and never overlapping
+    size_t getDirtyRangeCount() const noexcept { return mDirtyRangeCount; }
+
+    DirtyRange const& getDirtyRange(size_t i) const noexcept {
+        assert(i < mDirtyRangeCount);
+        return getDirtyRanges()[i];
+    }
+
+    // total number of modified bytes, i.e. what needs to be uploaded
+    size_t getDirtySize() const noexcept {
+        DirtyRange const* const ranges = getDirtyRanges();
+        size_t size = 0;
+        for (size_t i = 0, c = mDirtyRangeCount; i < c; i++) {
+            size += ranges[i].size();
+        }
+        return size;
+    }
 
     /*
      * -----------------------------------------------
@@ -135,15 +173,21 @@ public:
     // The "x" symbols represent dummy words.
     template <typename T, typename = typename is_supported_type<T>::type>
     void setUniformArray(size_t offset, T const* UTILS_RESTRICT begin, size_t count) noexcept {
-        constexpr size_t stride = (sizeof(T) + 0xF) & ~0xF;
-        size_t arraySize = stride * count - stride + sizeof(T);
-        T* UTILS_RESTRICT p = static_cast<T*>(invalidateUniforms(offset, arraySize));
+        constexpr size_t stride = (getUniformSize<T>() + 0xF) & ~0xF;
+        size_t arraySize = stride * count - stride + getUniformSize<T>();
+        void* UTILS_RESTRICT p = invalidateUniforms(offset, arraySize);
         for (size_t i = 0; i < count; i++) {
-            *p = begin[i];
-            p = utils::pointermath::add(p, stride);
+            setUniform(p, i * stride, begin[i]);
         }
     }
 
+    // size in bytes of a uniform in the std140 layout, the columns of a mat3f are each padded
+    // to a vec4.
+    template <typename T, typename = typename is_supported_type<T>::type>
+    static constexpr size_t getUniformSize() noexcept {
+        return std::is_same<math::mat3f, T>::value ? sizeof(math::float4) * 3 : sizeof(T);
+    }
+
     template <typename T, typename = typename is_supported_type<T>::type>
     static void setUniform(void* addr, size_t offset, const T& v) noexcept {
         addr = static_cast<char*>(addr) + offset;
@@ -155,7 +199,7 @@ public:
     // (see specialization for mat3f below)
     template <typename T, typename = typename is_supported_type<T>::type>
     void setUniform(size_t offset, const T& v) noexcept {
-        setUniform(invalidateUniforms(offset, sizeof(T)), 0, v);
+        setUniform(invalidateUniforms(offset, getUniformSize<T>()), 0, v);
     }
 
     // get uniform of known types from the proper offset (e.g.: use offsetof())
@@ -183,6 +227,19 @@ public:
         return p;
     }
 
+    // Uploads only the modified ranges to the given GPU buffer and cleans the dirty bits.
+    // The data is staged into 'staging', which must be at least getDirtySize() bytes and must
+    // stay alive until the commands are executed (i.e. allocated from the command stream).
+    // Returns the number of bytes of 'staging' used.
+    size_t uploadDirtyRanges(backend::DriverApi& driver,
+            backend::UniformBufferHandle ubh, void* staging) const noexcept;
+
+    // Same as above, but allocates the staging memory from the command stream, or from the heap
+    // if there is more than MAX_COMMAND_STREAM_STAGING_SIZE bytes to upload.
+    // Returns the number of bytes uploaded.
+    size_t uploadDirtyRanges(backend::DriverApi& driver,
+            backend::UniformBufferHandle ubh) const noexcept;
+
 private:
 #if !defined(NDEBUG)
     friend utils::io::ostream& operator<<(utils::io::ostream& out, const UniformBuffer& rhs);
@@ -192,13 +249,41 @@ private:
 
     inline bool isLocalStorage() const noexcept { return mBuffer == mStorage; }
 
+    DirtyRange* getDirtyRanges() noexcept {
+        return UTILS_UNLIKELY(mHeapDirtyRanges) ? mHeapDirtyRanges : mDirtyRanges;
+    }
+
+    DirtyRange const* getDirtyRanges() const noexcept {
+        return UTILS_UNLIKELY(mHeapDirtyRanges) ? mHeapDirtyRanges : mDirtyRanges;
+    }
+
+    DirtyRange* growDirtyRanges() noexcept;
+
+    void addDirtyRange(uint32_t begin, uint32_t end) noexcept {
+        // fast path for the common case of updating the same (or adjacent) uniform repeatedly
+        const size_t count = mDirtyRangeCount;
+        if (count) {
+            DirtyRange& last = getDirtyRanges()[count - 1];
+            if (begin >= last.begin && begin <= last.end) {
+                last.end = std::max(last.end, end);
+                return;
+            }
+        }
+        addDirtyRangeSlow(begin, end);
+    }
+
+    void addDirtyRangeSlow(uint32_t begin, uint32_t end) noexcept;
+
     // TODO: we need a better to calculate this local storage.
     // Probably the better thing to do would be to use a special allocator.
     // Local storage is limited by the total size of a handle (128 byte for GL)
     char mStorage[96];
     void *mBuffer = nullptr;
     uint32_t mSize = 0;
-    mutable bool mSomethingDirty = false;
+    mutable uint32_t mDirtyRangeCount = 0;
+    uint32_t mDirtyRangeCapacity = MAX_DIRTY_RANGES;
+    DirtyRange mDirtyRanges[MAX_DIRTY_RANGES];
+    DirtyRange* mHeapDirtyRanges = nullptr; // used instead of mDirtyRanges once they're exhausted
 };
 
 // specialization for mat3f (which has a different alignment, see std140 layout rules)
@@ -19,6 +19,7 @@
 #include "details/Engine.h"
 #include "details/Culler.h"
 #include "details/DFG.h"
+#include "details/FrameStatisticsRecorder.h"
 #include "details/Froxelizer.h"
 #include "details/IndirectLight.h"
 #include "details/MaterialInstance.h"
@@ -58,6 +59,11 @@ static constexpr size_t VISIBLE_SHADOW_CASTER_BIT = 1u;
 static constexpr uint8_t VISIBLE_RENDERABLE = 1u << VISIBLE_RENDERABLE_BIT;
 static constexpr uint8_t VISIBLE_SHADOW_CASTER = 1u << VISIBLE_SHADOW_CASTER_BIT;
 static constexpr uint8_t VISIBLE_ALL = VISIBLE_RENDERABLE | VISIBLE_SHADOW_CASTER;
+// the following bits are set for the shadow casters of each directional shadow cascade
+static constexpr uint8_t VISIBLE_DIR_SHADOW_CASCADES =
+        ((1u << CONFIG_MAX_SHADOW_CASCADES) - 1u) << FView::VISIBLE_DIR_SHADOW_CASCADE_FIRST_BIT;
+static_assert(FView::VISIBLE_DIR_SHADOW_CASCADE_FIRST_BIT + CONFIG_MAX_SHADOW_CASCADES <=
+        sizeof(Culler::result_type) * 8, "too many shadow cascades for the visibility mask");
 
 FView::FView(FEngine& engine)
     : mFroxelizer(engine),
@@ -69,6 +75,8 @@ FView::FView(FEngine& engine)
     FDebugRegistry& debugRegistry = engine.getDebugRegistry();
     debugRegistry.registerProperty("d.view.camera_at_origin",
             &engine.debug.view.camera_at_origin);
+    debugRegistry.registerProperty("d.lighting.light_tree",
+            &engine.debug.lighting.light_tree);
 
     // set-up samplers
     mFroxelizer.getRecordBuffer().setSampler(PerViewSib::RECORDS, mPerViewSb);
@@ -113,8 +121,9 @@ void FView::setDynamicResolutionOptions(DynamicResolutionOptions const& options)
     if (dynamicResolution.enabled) {
         // if enabled, sanitize the parameters
 
-        // History can't be more than 32 frames (~0.5s)
-        dynamicResolution.history = std::min(dynamicResolution.history, uint8_t(MAX_FRAMETIME_HISTORY));
+        // History can't be more than 128 frames (~2s)
+        dynamicResolution.history = std::min(dynamicResolution.history,
+                uint8_t(DynamicResolutionController::MAX_HISTORY));
 
         // History must at least be 3 frames
         dynamicResolution.history = std::max(dynamicResolution.history, uint8_t(3));
@@ -142,9 +151,8 @@ void FView::setDynamicResolutionOptions(DynamicResolutionOptions const& options)
         dynamicResolution.maxScale = min(dynamicResolution.maxScale, float2(2.0f));
 
         // reset the history, so we start from a known (and current) state
-        mFrameTimeHistorySize = 0;
+        mDynamicResolutionController.setOptions(dynamicResolution);
         mScale = 1.0f;
-        mDynamicWorkloadScale = 1.0f;
     }
 }
 
@@ -152,57 +160,23 @@ void FView::setDynamicLightingOptions(float zLightNear, float zLightFar) noexcep
     mFroxelizer.setOptions(zLightNear, zLightFar);
 }
 
-// this is to avoid a call to memmove
-template<class InputIterator, class OutputIterator>
-static inline
-void move_backward(InputIterator first, InputIterator last, OutputIterator result) {
-    while (first != last) {
-        *--result = *--last;
-    }
-}
-
-float2 FView::updateScale(duration frameTime) noexcept {
+float2 FView::updateScale(duration frameTime, bool gpuFrameTime) noexcept {
     DynamicResolutionOptions const& options = mDynamicResolution;
     if (options.enabled) {
 
-        if (UTILS_UNLIKELY(frameTime.count() <= std::numeric_limits<float>::epsilon())) {
-            mScale = 1.0f;
-            return mScale;
+        if (gpuFrameTime != mGpuFrameTime) {
+            // the source of the measurements changed, start over
+            mGpuFrameTime = gpuFrameTime;
+            mDynamicResolutionController.reset();
         }
 
-        // keep an history of frame times
-        auto& history = mFrameTimeHistory;
-
-        // this is like doing { pop_back(); push_front(); }
-        details::move_backward(history.begin(), history.end() - 1, history.end());
-        history.front() = frameTime;
-        mFrameTimeHistorySize = std::min(++mFrameTimeHistorySize, size_t(MAX_FRAMETIME_HISTORY));
-
-        if (UTILS_UNLIKELY(mFrameTimeHistorySize < 3)) {
-            // don't make any decision if we don't have enough data
-            mScale = 1.0f;
+        if (frameTime.count() <= std::numeric_limits<float>::epsilon()) {
+            // no new measurement, keep the current scale
             return mScale;
         }
 
-        // apply a median filter to get a good representation of the frame time of the last
-        // N frames.
-        std::array<duration, MAX_FRAMETIME_HISTORY> median; // NOLINT -- it's initialized below
-        size_t size = std::min(mFrameTimeHistorySize, median.size());
-        std::uninitialized_copy_n(history.begin(), size, median.begin());
-        std::sort(median.begin(), median.begin() + size);
-        duration filteredFrameTime = median[size / 2];
-
-        // how much we need to scale the current workload to fit in our target, at this instant
-        const float targetWithHeadroom = options.targetFrameTimeMilli * (1 - options.headRoomRatio);
-        const float workloadScale = targetWithHeadroom / filteredFrameTime.count();
-
-        // low-pass: y += b * (x - y)
-        const float oneOverTau = options.scaleRate;
-        const float x = mScale.x * mScale.y * workloadScale;
-        mDynamicWorkloadScale += (1.0f - std::exp(-oneOverTau)) * (x - mDynamicWorkloadScale);
-
-        // scaling factor we need to apply on the whole surface
-        const float scale = mDynamicWorkloadScale;
+        // how much of the viewport area we can afford to render
+        const float scale = mDynamicResolutionController.update(frameTime.count());
 
         const float w = mViewport.width;
         const float h = mViewport.height;
@@ -243,9 +217,7 @@ float2 FView::updateScale(duration frameTime) noexcept {
         if (!--sLogCounter) {
             sLogCounter = 15;
             slog.d << frameTime.count()
-                   << ", " << filteredFrameTime.count()
-                   << ", " << workloadScale
-                   << ", " << mDynamicWorkloadScale
+                   << ", " << scale
                    << ", " << mScale.x
                    << ", " << mScale.y
                    << ", " << mScale.x * mScale.y
@@ -260,6 +232,22 @@ float2 FView::updateScale(duration frameTime) noexcept {
     return mScale;
 }
 
+View::DynamicResolutionStatistics FView::getDynamicResolutionStatistics() const noexcept {
+    DynamicResolutionController const& controller = mDynamicResolutionController;
+    if (!mDynamicResolution.enabled) {
+        return {};
+    }
+    return {
+            .scale = mScale,
+            .lastFrameTimeMilli = controller.getLastFrameTime(),
+            .medianFrameTimeMilli = controller.getPercentile(0.5f),
+            .p90FrameTimeMilli = controller.getPercentile(0.9f),
+            .p99FrameTimeMilli = controller.getPercentile(0.99f),
+            .sampleCount = uint32_t(controller.getSampleCount()),
+            .gpuFrameTime = mGpuFrameTime
+    };
+}
+
 void FView::setClearColor(float4 const& clearColor) noexcept {
     mClearColor = clearColor;
 }
@@ -296,21 +284,44 @@ void FView::prepareShadowing(FEngine& engine, backend::DriverApi& driver,
         ShadowMap& shadowMap = mDirectionalShadowMap;
         shadowMap.update(lightData, 0, mScene, mViewingCameraInfo, mVisibleLayers);
         if (shadowMap.hasVisibleShadows()) {
-            // Cull shadow casters
             UniformBuffer& u = mPerViewUb;
-            Frustum const& frustum = shadowMap.getCamera().getFrustum();
-            FView::prepareVisibleShadowCasters(engine.getJobSystem(), frustum, renderableData);
 
             // allocates shadowmap driver resources
             shadowMap.prepare(driver, mPerViewSb);
 
-            mat4f const& lightFromWorldMatrix = shadowMap.getLightSpaceMatrix();
-            u.setUniform(offsetof(PerViewUib, lightFromWorldMatrix), lightFromWorldMatrix);
-
-            const float texelSizeWorldSpace = shadowMap.getTexelSizeWorldSpace();
             const float normalBias = lcm.getShadowNormalBias(directionalLight);
-            u.setUniform(offsetof(PerViewUib, shadowBias),
-                    float3{ 0, normalBias * texelSizeWorldSpace, 0 });
+            float4 cascadeNormalBias{};
+            for (size_t i = 0, c = shadowMap.getCascadeCount(); i < c; i++) {
+                if (!shadowMap.hasVisibleShadows(i)) {
+                    continue;
+                }
+
+                // Cull shadow casters of this cascade
+                Frustum const& frustum = shadowMap.getCamera(i).getFrustum();
+                FView::prepareVisibleShadowCasters(engine.getJobSystem(), frustum,
+                        renderableData, i);
+
+                mat4f const& lightFromWorldMatrix = shadowMap.getLightSpaceMatrix(i);
+                u.setUniform(offsetof(PerViewUib, lightFromWorldMatrix) + i * sizeof(mat4f),
+                        lightFromWorldMatrix);
+
+                cascadeNormalBias[i] = normalBias * shadowMap.getTexelSizeWorldSpace(i);
+            }
+
+            if (engine.debug.shadowmap.receiver_culling) {
+                // Cull the shadow casters that can't shadow any visible receiver, this relies
+                // on the VISIBLE_RENDERABLE bit set by prepareVisibleRenderables().
+                ShadowCasterCuller& culler = mShadowCasterCuller;
+                culler.buildReceivers(shadowMap.getLightViewMatrix(), renderableData,
+                        mVisibleLayers, VISIBLE_RENDERABLE);
+                UTILS_UNUSED_IN_RELEASE const size_t culled =
+                        culler.cullCasters(renderableData, VISIBLE_DIR_SHADOW_CASCADES);
+                SYSTRACE_VALUE32("receiverCulledCasters", culled);
+            }
+
+            u.setUniform(offsetof(PerViewUib, shadowBias), float3{ 0, cascadeNormalBias[0], 0 });
+            u.setUniform(offsetof(PerViewUib, cascadeNormalBias), cascadeNormalBias);
+            u.setUniform(offsetof(PerViewUib, cascadeSplits), shadowMap.getCascadeSplits());
         }
     }
 }
@@ -406,7 +417,8 @@ void FView::prepareLighting(FEngine& engine, FEngine::DriverApi& driver, ArenaSc
 }
 
 void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& arena,
-        filament::Viewport const& viewport, float4 const& userTime) noexcept {
+        filament::Viewport const& viewport, float4 const& userTime,
+        FrameStatisticsRecorder* stats) noexcept {
     JobSystem& js = engine.getJobSystem();
 
     /*
@@ -478,7 +490,11 @@ void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& are
      * Gather all information needed to render this scene. Apply the world origin to all
      * objects in the scene.
      */
-    scene->prepare(worldOriginScene);
+    { // scope for frame statistics
+        FrameStatisticsRecorder::Scope scope(stats,
+                FrameStatisticsRecorder::Phase::SCENE_PREPARE);
+        scene->prepare(worldOriginScene);
+    }
 
     /*
      * Light culling: runs in parallel with Renderable culling (below)
@@ -495,6 +511,8 @@ void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& are
 
     { // all the operations in this scope must happen sequentially
 
+        FrameStatisticsRecorder::Scope culling(stats, FrameStatisticsRecorder::Phase::CULLING);
+
         Slice<Culler::result_type> cullingMask = renderableData.slice<FScene::VISIBLE_MASK>();
         std::uninitialized_fill(cullingMask.begin(), cullingMask.end(), 0);
 
@@ -508,7 +526,8 @@ void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& are
 
         /*
          * Shadowing: compute the shadow camera and cull shadow casters
-         * (this will set the VISIBLE_SHADOW_CASTER bit)
+         * (this will set the bits of each shadow cascade, VISIBLE_SHADOW_CASTER is derived
+         * from them in computeVisibilityMasks())
          */
 
         prepareShadowing(engine, driver, renderableData, scene->getLightData());
@@ -540,19 +559,38 @@ void FView::prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& are
         mVisibleShadowCasters = Range{ uint32_t(beginCasters - beginRenderables), iEnd };
         merged = Range{ 0, iEnd };
 
+        culling.stop();
+
         // update those UBOs
-        const size_t size = merged.size() * sizeof(PerRenderableUib);
+        // The UBO is indexed by renderable instance, so it must be able to hold the largest
+        // visible one (instance 0 is never used, but it's simpler to keep it).
+        uint32_t maxUboIndex = 0;
+        for (uint32_t i : merged) {
+            maxUboIndex = std::max(maxUboIndex, FScene::getRenderableUboIndex(renderableData, i));
+        }
+        const size_t size = (maxUboIndex + 1u) * sizeof(PerRenderableUib);
         if (mRenderableUBOSize < size) {
             // allocate 1/3 extra, with a minimum of 16 objects
-            const size_t count = std::max(size_t(16u), (4u * merged.size() + 2u) / 3u);
+            const size_t count = std::max(size_t(16u),
+                    (4u * (size / sizeof(PerRenderableUib)) + 2u) / 3u);
             mRenderableUBOSize = uint32_t(count * sizeof(PerRenderableUib));
             driver.destroyUniformBuffer(mRenderableUbh);
             mRenderableUbh = driver.createUniformBuffer(mRenderableUBOSize,
-                    backend::BufferUsage::STREAM);
+                    backend::BufferUsage::DYNAMIC);
+            // This invalidates all the cached per-renderable data. The new GPU buffer is
+            // uninitialized, so make sure no cached entry can match a renderable: the visible
+            // ones are all updated, and only those get uploaded, not the whole buffer.
+            mRenderableUb = UniformBuffer(mRenderableUBOSize);
+            void* const buffer = mRenderableUb.invalidate();
+            for (size_t offset = 0; offset < mRenderableUBOSize; offset += sizeof(PerRenderableUib)) {
+                UniformBuffer::setUniform(buffer,
+                        offset + offsetof(PerRenderableUib, skinningEnabled), ~0u);
+            }
+            mRenderableUb.clean();
         } else {
             // TODO: should we shrink the underlying UBO at some point?
         }
-        scene->updateUBOs(merged, mRenderableUbh);
+        scene->updateUBOs(merged, mRenderableUb, mRenderableUbh);
     }
 
     /*
@@ -595,9 +633,12 @@ void FView::computeVisibilityMasks(
         FRenderableManager::Visibility v = visibility[i];
         bool inVisibleLayer = layers[i] & visibleLayers;
         bool visRenderables   = (!v.culling || (mask & VISIBLE_RENDERABLE))    && inVisibleLayer;
-        bool visShadowCasters = (!v.culling || (mask & VISIBLE_SHADOW_CASTER)) && inVisibleLayer && v.castShadows;
+        bool visShadowCasters = (!v.culling || (mask & VISIBLE_DIR_SHADOW_CASCADES)) && inVisibleLayer && v.castShadows;
+        // keep track of which cascades each caster is visible in
+        Culler::result_type cascades = v.culling ? (mask & VISIBLE_DIR_SHADOW_CASCADES) : VISIBLE_DIR_SHADOW_CASCADES;
         visibleMask[i] = Culler::result_type(visRenderables) |
-                         Culler::result_type(visShadowCasters << 1u);
+                         Culler::result_type(visShadowCasters << 1u) |
+                         Culler::result_type(visShadowCasters ? cascades : 0u);
     }
 }
 
@@ -606,8 +647,9 @@ UTILS_NOINLINE
         FScene::RenderableSoa::iterator begin,
         FScene::RenderableSoa::iterator end,
         uint8_t mask) noexcept {
+    // the shadow cascades bits are ignored here
     return std::partition(begin, end, [mask](auto it) {
-        return it.template get<FScene::VISIBLE_MASK>() == mask;
+        return (it.template get<FScene::VISIBLE_MASK>() & VISIBLE_ALL) == mask;
     });
 }
 
@@ -689,9 +731,11 @@ void FView::prepareVisibleRenderables(JobSystem& js,
 
 UTILS_NOINLINE
 void FView::prepareVisibleShadowCasters(JobSystem& js,
-        Frustum const& lightFrustum, FScene::RenderableSoa& renderableData) noexcept {
+        Frustum const& lightFrustum, FScene::RenderableSoa& renderableData,
+        size_t cascade) noexcept {
     SYSTRACE_CALL();
-    FView::cullRenderables(js, renderableData, lightFrustum, VISIBLE_SHADOW_CASTER_BIT);
+    FView::cullRenderables(js, renderableData, lightFrustum,
+            VISIBLE_DIR_SHADOW_CASCADE_FIRST_BIT + cascade);
 }
 
 void FView::cullRenderables(JobSystem& js,
@@ -862,6 +906,18 @@ void View::setShadowsEnabled(bool enabled) noexcept {
     upcast(this)->setShadowsEnabled(enabled);
 }
 
+void View::setShadowCachingEnabled(bool enabled) noexcept {
+    upcast(this)->setShadowCachingEnabled(enabled);
+}
+
+void View::invalidateShadowCache() noexcept {
+    upcast(this)->invalidateShadowCache();
+}
+
+View::ShadowCacheStats View::getShadowCacheStats() const noexcept {
+    return upcast(this)->getShadowCacheStats();
+}
+
 void View::setRenderTarget(RenderTarget* renderTarget, TargetBufferFlags discard) noexcept {
     upcast(this)->setRenderTarget(upcast(renderTarget), discard);
 }
@@ -914,6 +970,10 @@ View::DynamicResolutionOptions View::getDynamicResolutionOptions() const noexcep
     return upcast(this)->getDynamicResolutionOptions();
 }
 
+View::DynamicResolutionStatistics View::getDynamicResolutionStatistics() const noexcept {
+    return upcast(this)->getDynamicResolutionStatistics();
+}
+
 void View::setRenderQuality(const RenderQuality& renderQuality) noexcept {
     upcast(this)->setRenderQuality(renderQuality);
 }
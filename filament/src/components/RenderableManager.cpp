@@ -40,6 +40,7 @@ struct RenderableManager::BuilderDetails {
     using Entry = RenderableManager::Builder::Entry;
     std::vector<Entry> mEntries;
     Box mAABB;
+    Box mPositionQuantization;
     uint8_t mLayerMask = 0x1;
     uint8_t mPriority = 0x4;
     bool mCulling : 1;
@@ -159,6 +160,12 @@ RenderableManager::Builder& RenderableManager::Builder::morphing(bool enable) no
     return *this;
 }
 
+RenderableManager::Builder& RenderableManager::Builder::positionQuantization(
+        const Box& bounds) noexcept {
+    mImpl->mPositionQuantization = bounds;
+    return *this;
+}
+
 RenderableManager::Builder& RenderableManager::Builder::blendOrder(size_t index, uint16_t blendOrder) noexcept {
     if (index < mImpl->mEntries.size()) {
         mImpl->mEntries[index].blendOrder = blendOrder;
@@ -175,6 +182,12 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
         return Error;
     }
 
+    if (!ASSERT_PRECONDITION_NON_FATAL(mImpl->mPositionQuantization.isEmpty() ||
+            (!mImpl->mSkinningBoneCount && !mImpl->mMorphingEnabled),
+            "position quantization can't be used with skinning or morphing")) {
+        return Error;
+    }
+
     for (size_t i = 0, c = mImpl->mEntries.size(); i < c; i++) {
         auto& entry = mImpl->mEntries[i];
 
@@ -233,6 +246,14 @@ RenderableManager::Builder::Result RenderableManager::Builder::build(Engine& eng
         return Error;
     }
 
+    FRenderableManager const& rm = upcast(engine).getRenderableManager();
+    if (!ASSERT_POSTCONDITION_NON_FATAL(rm.hasComponent(entity) ||
+            rm.getComponentCount() < FRenderableManager::MAX_INSTANCE_COUNT,
+            "[entity=%u] renderable count > %u", entity.getId(),
+            unsigned(FRenderableManager::MAX_INSTANCE_COUNT))) {
+        return Error;
+    }
+
     // we get here only if there was no POSTCONDITION errors.
     upcast(engine).createRenderable(*this, entity);
     return Success;
@@ -284,6 +305,7 @@ void FRenderableManager::create(
         setSkinning(ci, false);
         setMorphing(ci, builder->mMorphingEnabled);
         setMorphWeights(ci, {0, 0, 0, 0});
+        manager[ci].quantization = builder->mPositionQuantization;
 
         const size_t count = builder->mSkinningBoneCount;
         if (UTILS_UNLIKELY(count > 0 || builder->mMorphingEnabled)) {
@@ -585,6 +607,10 @@ const Box& RenderableManager::getAxisAlignedBoundingBox(Instance instance) const
     return upcast(this)->getAxisAlignedBoundingBox(instance);
 }
 
+const Box& RenderableManager::getPositionQuantization(Instance instance) const noexcept {
+    return upcast(this)->getPositionQuantization(instance);
+}
+
 size_t RenderableManager::getPrimitiveCount(Instance instance) const noexcept {
     return upcast(this)->getPrimitiveCount(instance, 0);
 }
@@ -76,6 +76,14 @@ public:
         return mManager.getInstance(e);
     }
 
+    // number of renderable components, instances are in the range [1, getComponentCount()]
+    size_t getComponentCount() const noexcept {
+        return mManager.getComponentCount();
+    }
+
+    // Instances index the per-renderable UBO, and RenderPass stores that index in 16 bits.
+    static constexpr size_t MAX_INSTANCE_COUNT = 0xFFFF;
+
     void create(const RenderableManager::Builder& builder, utils::Entity entity);
 
     void destroy(utils::Entity e) noexcept;
@@ -121,6 +129,8 @@ public:
     inline uint8_t getLayerMask(Instance instance) const noexcept;
     inline uint8_t getPriority(Instance instance) const noexcept;
     inline filament::math::float4 getMorphWeights(Instance instance) const noexcept;
+    // empty if the positions are not quantized
+    inline Box const& getPositionQuantization(Instance instance) const noexcept;
 
     inline backend::Handle<backend::HwUniformBuffer> getBonesUbh(Instance instance) const noexcept;
     inline uint32_t getBoneCount(Instance instance) const noexcept;
@@ -162,6 +172,7 @@ private:
         MORPH_WEIGHTS,      // user data
         VISIBILITY,         // user data
         PRIMITIVES,         // user data
+        QUANTIZATION,       // user data
         BONES,              // filament data, UBO storing a pointer to the bones information
     };
 
@@ -171,6 +182,7 @@ private:
             filament::math::float4,          // MORPH_WEIGHTS
             Visibility,                      // VISIBILITY
             utils::Slice<FRenderPrimitive>,  // PRIMITIVES
+            Box,                             // QUANTIZATION
             std::unique_ptr<Bones>           // BONES
     >;
 
@@ -191,6 +203,7 @@ private:
                 Field<MORPH_WEIGHTS> morphWeights;
                 Field<VISIBILITY>   visibility;
                 Field<PRIMITIVES>   primitives;
+                Field<QUANTIZATION> quantization;
                 Field<BONES>        bones;
             };
         };
@@ -311,6 +324,10 @@ Box const& FRenderableManager::getAABB(Instance instance) const noexcept {
     return mManager[instance].aabb;
 }
 
+Box const& FRenderableManager::getPositionQuantization(Instance instance) const noexcept {
+    return mManager[instance].quantization;
+}
+
 backend::Handle<backend::HwUniformBuffer> FRenderableManager::getBonesUbh(Instance instance) const noexcept {
     std::unique_ptr<Bones> const& bones = mManager[instance].bones;
     return bones ? bones->handle : backend::Handle<backend::HwUniformBuffer>{};
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DETAILS_DYNAMICRESOLUTIONCONTROLLER_H
+#define TNT_FILAMENT_DETAILS_DYNAMICRESOLUTIONCONTROLLER_H
+
+#include <filament/View.h>
+
+#include <array>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace details {
+
+/*
+ * Chooses the fraction of the viewport area to render, so that the measured frame time stays
+ * close to the target frame time minus the headroom.
+ *
+ * Frame times are median-filtered over the last `DynamicResolutionOptions::history` frames,
+ * then fed to a PID controller whose output is the area scale. The integral term is what
+ * holds the scale in steady state; it's clamped to the [minScale, maxScale] area range so it
+ * doesn't wind up when the scale saturates.
+ *
+ * The controller also keeps a longer history of raw frame times for percentile statistics.
+ */
+class DynamicResolutionController {
+public:
+    using DynamicResolutionOptions = View::DynamicResolutionOptions;
+
+    // maximum number of frame times kept, and maximum size of the median filter
+    static constexpr size_t MAX_HISTORY = 128;
+
+    // controller gains, relative to the frame time error normalized by the target. The integral
+    // gain is DynamicResolutionOptions::scaleRate.
+    static constexpr float PROPORTIONAL_GAIN = 0.25f;
+    static constexpr float DERIVATIVE_GAIN = 0.05f;
+
+    DynamicResolutionController() noexcept;
+
+    // options must have been sanitized already. This resets the controller.
+    void setOptions(DynamicResolutionOptions const& options) noexcept;
+
+    // forgets all the history and goes back to a scale of 1
+    void reset() noexcept;
+
+    // feeds a new frame time and returns the new area scale, i.e. the ratio of pixels to render
+    float update(float frameTimeMilli) noexcept;
+
+    // returns the area scale chosen by the last update()
+    float getAreaScale() const noexcept { return mAreaScale; }
+
+    // number of frame times in the history, at most MAX_HISTORY
+    size_t getSampleCount() const noexcept { return mCount; }
+
+    // most recent frame time, or 0 if there is none
+    float getLastFrameTime() const noexcept;
+
+    // returns the p-th percentile (p in [0, 1]) of the frame times in the history,
+    // or 0 if there is none.
+    float getPercentile(float p) const noexcept;
+
+private:
+    // copies the n most recent frame times into out, returns how many were copied
+    size_t getRecent(float* out, size_t n) const noexcept;
+
+    DynamicResolutionOptions mOptions;
+    std::array<float, MAX_HISTORY> mHistory{};  // ring buffer of frame times
+    size_t mHead = 0;                           // where the next frame time goes
+    size_t mCount = 0;
+    float mIntegral = 0.0f;
+    float mPreviousError = 0.0f;
+    float mAreaScale = 1.0f;
+};
+
+} // namespace details
+} // namespace filament
+
+#endif // TNT_FILAMENT_DETAILS_DYNAMICRESOLUTIONCONTROLLER_H
@@ -288,6 +288,11 @@ public:
 
     bool execute();
 
+    // time the driver thread spent waiting for commands, must be called on the driver thread
+    std::chrono::steady_clock::duration getDriverIdleTime() const noexcept {
+        return mDriverIdleTime;
+    }
+
     void getCapabilities(backend::RenderCapabilities& capabilities) noexcept;
 
 private:
@@ -348,6 +353,7 @@ private:
     std::thread mDriverThread;
     backend::CommandBufferQueue mCommandBufferQueue;
     DriverApi mCommandStream;
+    std::chrono::steady_clock::duration mDriverIdleTime{};
 
     LinearAllocatorArena mPerRenderPassAllocator;
     HeapAllocatorArena mHeapAllocator;
@@ -375,6 +381,7 @@ public:
             bool far_uses_shadowcasters = true;
             bool focus_shadowcasters = true;
             bool checkerboard = false;
+            bool receiver_culling = true;
             bool lispsm = true;
             float dzn = -1.0f;
             float dzf =  1.0f;
@@ -385,6 +392,9 @@ public:
         struct {
             bool camera_at_origin = true;
         } view;
+        struct {
+            bool light_tree = true;
+        } lighting;
          matdbg::DebugServer* server = nullptr;
     } debug;
 };
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DETAILS_FRAMESTATISTICSRECORDER_H
+#define TNT_FILAMENT_DETAILS_FRAMESTATISTICSRECORDER_H
+
+#include <filament/Renderer.h>
+
+#include "private/backend/DriverApiForward.h"
+
+#include <array>
+#include <chrono>
+#include <mutex>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace details {
+
+class FEngine;
+
+/*
+ * FrameStatisticsRecorder measures the CPU time spent in each phase of a frame.
+ *
+ * Application thread phases are accumulated with Scope objects between beginFrame() and
+ * endFrame(). Backend phases are timestamped by commands queued in the command stream, which
+ * run on the render thread; the time the render thread spends waiting for commands is
+ * subtracted.
+ *
+ * Each half of a frame is published independently into a small history indexed by frame id,
+ * a frame becomes visible once both halves are in.
+ */
+class FrameStatisticsRecorder {
+public:
+    using FrameStatistics = Renderer::FrameStatistics;
+    using clock = std::chrono::steady_clock;
+
+    enum class Phase : uint8_t {
+        SCENE_PREPARE,
+        CULLING,
+        FROXELIZATION,
+        COMMAND_GENERATION,
+        COMMAND_SORT,
+        DRIVER_RECORDING
+    };
+    static constexpr size_t PHASE_COUNT = 6;
+
+    // accumulates the time spent in its lifetime into a phase, the recorder can be null.
+    // Each phase must only be measured by one thread at a time.
+    class Scope {
+    public:
+        Scope(FrameStatisticsRecorder* recorder, Phase phase) noexcept
+                : mRecorder(recorder), mPhase(phase) {
+            if (recorder) {
+                mStart = clock::now();
+            }
+        }
+        ~Scope() noexcept { stop(); }
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        // ends the measurement before the end of the scope
+        void stop() noexcept {
+            if (mRecorder) {
+                mRecorder->mPhases[size_t(mPhase)] += clock::now() - mStart;
+                mRecorder = nullptr;
+            }
+        }
+
+    private:
+        FrameStatisticsRecorder* mRecorder;
+        Phase mPhase;
+        clock::time_point mStart;
+    };
+
+    explicit FrameStatisticsRecorder(FEngine& engine) noexcept;
+
+    FrameStatisticsRecorder(FrameStatisticsRecorder const&) = delete;
+    FrameStatisticsRecorder& operator=(FrameStatisticsRecorder const&) = delete;
+
+    // called on the application thread, before anything is recorded into the frame
+    void beginFrame(backend::DriverApi& driver, uint32_t frameId) noexcept;
+
+    // called on the application thread, right before the swap chain is committed
+    void beginSwap(backend::DriverApi& driver) noexcept;
+
+    // called on the application thread, after the swap chain is committed
+    void endFrame(backend::DriverApi& driver) noexcept;
+
+    // fills out with up to count frames, most recent first, returns how many were written
+    size_t getHistory(FrameStatistics* out, size_t count) const noexcept;
+
+    // publish each half of a frame's statistics. These are used internally, and by tests.
+    void publishApplicationPhases(FrameStatistics const& stats) noexcept;
+    void publishBackendPhases(uint32_t frameId, float backendExecutionMs, float swapMs) noexcept;
+
+private:
+    static constexpr uint8_t APPLICATION_PHASES = 0x1;
+    static constexpr uint8_t BACKEND_PHASES     = 0x2;
+
+    struct Entry {
+        FrameStatistics stats{};
+        uint8_t published = 0;  // APPLICATION_PHASES | BACKEND_PHASES
+    };
+
+    // returns the entry for frameId, resetting it if it held an older frame. Lock must be held.
+    Entry& getEntry(uint32_t frameId) noexcept;
+
+    static float toMilliseconds(clock::duration d) noexcept {
+        return std::chrono::duration<float, std::milli>(d).count();
+    }
+
+    // render thread timestamps of a frame, only accessed by the render thread
+    struct BackendTimestamps {
+        clock::time_point begin;
+        clock::time_point swap;
+        clock::duration idleAtBegin{};
+        clock::duration idleAtSwap{};
+    };
+
+    FEngine& mEngine;
+
+    // application thread
+    std::array<clock::duration, PHASE_COUNT> mPhases{};
+    clock::time_point mFrameBegin;
+    uint32_t mFrameId = 0;
+    bool mInFrame = false;
+
+    // render thread
+    BackendTimestamps mBackend;
+
+    mutable std::mutex mLock;
+    std::array<Entry, FrameStatistics::MAX_FRAME_COUNT> mHistory{};
+};
+
+} // namespace details
+} // namespace filament
+
+#endif // TNT_FILAMENT_DETAILS_FRAMESTATISTICSRECORDER_H
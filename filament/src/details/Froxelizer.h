@@ -22,6 +22,7 @@
 #include "details/Allocators.h"
 #include "details/Scene.h"
 #include "details/Engine.h"
+#include "details/LightTree.h"
 
 #include <backend/Handle.h>
 
@@ -38,6 +39,7 @@
 #include <math/mat4.h>
 #include <math/vec4.h>
 
+#include <array>
 #include <vector>
 
 namespace filament {
@@ -168,6 +170,12 @@ public:
     // with 256 lights this implies 8 jobs (256 / 32) for froxelization.
     using LightGroupType = uint32_t;
 
+    // From this number of point and spot lights, lights are assigned to froxels by querying a
+    // tree of the lights for each froxel, rather than by walking the froxels covered by each
+    // light. The cost of the latter grows with the number of lights and their screen coverage,
+    // the former mostly depends on the number of froxels.
+    static constexpr size_t LIGHT_TREE_MIN_LIGHT_COUNT = 64;
+
 private:
     struct LightRecord {
         using bitset = utils::bitset<uint64_t, (CONFIG_MAX_LIGHT_COUNT + 63) / 64>;
@@ -184,16 +192,11 @@ private:
         float radius;
     };
 
-    struct LightTreeNode {
-        float min;          // lights z-range min
-        float max;          // lights z-range max
-
-        uint16_t next;      // next node when range test fails
-        uint16_t offset;    // offset in record buffer
-
-        uint8_t isLeaf;
-        uint8_t count;      // light count in record buffer
-        uint16_t reserved;
+    // lights of a froxel found by the light tree, stored in the record list of its slice
+    struct FroxelLightList {
+        uint32_t offset;    // offset of the point lights, followed by the spot lights
+        uint8_t pointLightCount;
+        uint8_t spotLightCount;
     };
 
     // The first entry always encodes the type of light, i.e. point/spot
@@ -211,9 +214,12 @@ private:
     void froxelizePointAndSpotLight(FroxelThreadData& froxelThread, size_t bit,
             math::mat4f const& projection, const LightParams& light) const noexcept;
 
-    static void computeLightTree(LightTreeNode* lightTree,
-            utils::Slice<RecordBufferType> const& lightList,
-            const FScene::LightSoa& lightData, size_t lightRecordsOffset) noexcept;
+    void froxelizeLightTree(FEngine& engine,
+            const CameraInfo& camera, const FScene::LightSoa& lightData) noexcept;
+
+    void froxelizeSliceWithLightTree(size_t iz) noexcept;
+
+    void froxelizeAssignRecordsFromLists() noexcept;
 
     uint16_t getFroxelIndex(size_t ix, size_t iy, size_t iz) const noexcept {
         return uint16_t(ix + (iy * mFroxelCountX) + (iz * mFroxelCountX * mFroxelCountY));
@@ -242,6 +248,14 @@ private:
     utils::Slice<RecordBufferType> mRecordBufferUser;   //  64 KiB
     utils::Slice<LightRecord> mLightRecords;            // 256 KiB w/ 256 lights
 
+    // light tree froxelization, these are kept across frames to avoid reallocations
+    LightTree mLightTree;
+    std::vector<LightParams> mLightParams;
+    std::vector<math::float4> mLightSpheres;
+    std::vector<FroxelLightList> mFroxelLightLists;     //  64 KiB w/ 8192 froxels
+    std::array<std::vector<LightTree::index_type>, FEngine::CONFIG_FROXEL_SLICE_COUNT>
+            mSliceRecords;                              // one list per slice, filled in parallel
+
     uint16_t mFroxelCountX = 0;
     uint16_t mFroxelCountY = 0;
     uint16_t mFroxelCountZ = 0;
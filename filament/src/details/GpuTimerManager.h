@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DETAILS_GPUTIMERMANAGER_H
+#define TNT_FILAMENT_DETAILS_GPUTIMERMANAGER_H
+
+#include <filament/Renderer.h>
+
+#include "private/backend/DriverApiForward.h"
+
+#include <backend/Handle.h>
+
+#include <deque>
+#include <vector>
+
+#include <stdint.h>
+
+namespace filament {
+namespace details {
+
+/*
+ * GpuTimerManager measures the GPU time of each FrameGraph pass using backend timer queries.
+ *
+ * Timer queries complete asynchronously, several frames after they're issued. The results of a
+ * frame are only read back once the frame is known to be finished, and the most recent complete
+ * frame is published as a PassTimingReport, along with the GPU time of each view rendered in it.
+ */
+class GpuTimerManager {
+public:
+    using PassTimingReport = Renderer::PassTimingReport;
+
+    // number of frames after which we give up on a frame's results
+    static constexpr uint32_t MAX_FRAME_LATENCY = 8;
+
+    GpuTimerManager() noexcept;
+    ~GpuTimerManager() noexcept;
+
+    GpuTimerManager(GpuTimerManager const&) = delete;
+    GpuTimerManager& operator=(GpuTimerManager const&) = delete;
+
+    void terminate(backend::DriverApi& driver) noexcept;
+
+    // start timing a new frame
+    void beginFrame(uint32_t frameId) noexcept;
+
+    // the passes that follow are attributed to the given view, until the end of the frame
+    void beginView(void const* view) noexcept;
+
+    // called by the FrameGraph around each pass, name must be a string literal
+    void beginPass(backend::DriverApi& driver, const char* name) noexcept;
+    void endPass(backend::DriverApi& driver) noexcept;
+
+    void endFrame() noexcept;
+
+    // reads back the results of all frames up to and including lastFinishedFrameId, which must
+    // have been fully executed by the GPU.
+    void update(backend::DriverApi& driver, uint32_t lastFinishedFrameId) noexcept;
+
+    PassTimingReport const& getReport() const noexcept { return mReport; }
+
+    // GPU time of all the passes of the given view in the most recent complete frame. Returns
+    // false if the view wasn't rendered in that frame.
+    bool getViewTime(void const* view, uint32_t* frameId, float* gpuTimeMs) const noexcept;
+
+private:
+    struct Pass {
+        const char* name;
+        void const* view;
+        backend::TimerQueryHandle query;
+        int64_t elapsed;    // nanoseconds, -1 when not available yet
+    };
+
+    struct Frame {
+        uint32_t frameId;
+        std::vector<Pass> passes;
+    };
+
+    struct ViewTime {
+        void const* view;
+        float gpuTimeMs;
+    };
+
+    backend::TimerQueryHandle obtainQuery(backend::DriverApi& driver) noexcept;
+    void releaseFrame(backend::DriverApi& driver, Frame& frame, bool complete) noexcept;
+
+    std::vector<backend::TimerQueryHandle> mFreeQueries;
+    std::deque<Frame> mPendingFrames;
+    Frame mCurrentFrame{};
+    void const* mCurrentView = nullptr;
+    std::vector<ViewTime> mViewTimes;
+    bool mInFrame = false;
+    bool mInPass = false;
+    PassTimingReport mReport{};
+};
+
+} // namespace details
+} // namespace filament
+
+#endif // TNT_FILAMENT_DETAILS_GPUTIMERMANAGER_H
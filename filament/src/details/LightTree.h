@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DETAILS_LIGHTTREE_H
+#define TNT_FILAMENT_DETAILS_LIGHTTREE_H
+
+#include <utils/compiler.h>
+
+#include <math/vec3.h>
+#include <math/vec4.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace details {
+
+/*
+ * A bounding volume hierarchy of light spheres, used to find which lights intersect a froxel.
+ *
+ * The tree is stored depth-first in a flat array. Each node knows the index of the node to
+ * visit when it's rejected, which allows a stackless traversal, so the tree can be queried
+ * from many threads at once.
+ */
+class LightTree {
+public:
+    // lights are referenced with 16-bits indices
+    using index_type = uint16_t;
+    static constexpr size_t MAX_LIGHT_COUNT = 65536;
+
+    // maximum number of lights per leaf
+    static constexpr size_t LEAF_SIZE = 4;
+
+    LightTree() noexcept;
+    ~LightTree() noexcept;
+
+    LightTree(LightTree const&) = delete;
+    LightTree& operator=(LightTree const&) = delete;
+
+    /*
+     * Builds the tree, this replaces the previous content.
+     *
+     * spheres  lights bounding spheres {center, radius}. Lights with a negative radius are
+     *          ignored. The array must stay valid until the next call to build().
+     * count    number of lights, at most MAX_LIGHT_COUNT.
+     */
+    void build(math::float4 const* spheres, size_t count) noexcept;
+
+    /*
+     * Calls f(index) for each light which sphere intersects the given sphere.
+     * This is thread-safe.
+     */
+    template<typename F>
+    void intersect(math::float4 const& s, F f) const noexcept {
+        math::float4 const* const UTILS_RESTRICT spheres = mSpheres;
+        index_type const* const UTILS_RESTRICT indices = mIndices.data();
+        Node const* const UTILS_RESTRICT nodes = mNodes.data();
+        for (size_t i = 0, c = mNodes.size(); i < c;) {
+            Node const& node = nodes[i];
+            if (!sphereBoxIntersect(s, node.min, node.max)) {
+                i = node.next;
+                continue;
+            }
+            for (size_t k = node.offset, e = node.offset + node.count; k < e; k++) {
+                const index_type l = indices[k];
+                const math::float3 d = spheres[l].xyz - s.xyz;
+                const float r = spheres[l].w + s.w;
+                if (dot(d, d) < r * r) {
+                    f(l);
+                }
+            }
+            // the children of an inner node are stored right after it, and the next node of a
+            // leaf is the node right after it.
+            i++;
+        }
+    }
+
+    size_t getNodeCount() const noexcept { return mNodes.size(); }
+
+private:
+    struct Node {
+        math::float3 min;   // bounding box of all the spheres of this subtree
+        uint32_t next;      // node to visit when this node is rejected
+        math::float3 max;
+        uint16_t offset;    // first light in mIndices (leaves only)
+        uint16_t count;     // number of lights in this leaf, zero for inner nodes
+    };
+
+    static bool sphereBoxIntersect(math::float4 const& s,
+            math::float3 const& min, math::float3 const& max) noexcept {
+        const math::float3 d = s.xyz - clamp(s.xyz, min, max);
+        return dot(d, d) < s.w * s.w;
+    }
+
+    void buildNode(size_t begin, size_t end) noexcept;
+
+    math::float4 const* mSpheres = nullptr;
+    std::vector<index_type> mIndices;
+    std::vector<Node> mNodes;
+};
+
+} // namespace details
+} // namespace filament
+
+#endif // TNT_FILAMENT_DETAILS_LIGHTTREE_H
@@ -52,6 +52,22 @@ public:
         }
     }
 
+    // Number of bytes of staging memory needed to commit the modified uniforms. This is used to
+    // batch the uniform uploads of many material instances into a single allocation.
+    size_t getUniformCommitSize() const noexcept {
+        return mUbHandle ? mUniforms.getDirtySize() : 0;
+    }
+
+    // Same as commit() above, but stages the uniforms into 'staging' which must be at least
+    // getUniformCommitSize() bytes and live in the command stream. Returns the number of bytes used.
+    size_t commit(FEngine::DriverApi& driver, void* staging) const {
+        size_t size = 0;
+        if (UTILS_UNLIKELY(mUniforms.isDirty() || mSamplers.isDirty())) {
+            size = commitSlow(driver, staging);
+        }
+        return size;
+    }
+
     void use(FEngine::DriverApi& driver) const {
         if (mUbHandle) {
             driver.bindUniformBuffer(BindingPoints::PER_MATERIAL_INSTANCE, mUbHandle);
@@ -129,6 +145,7 @@ private:
     void initParameters(FMaterial const* material);
 
     void commitSlow(FEngine::DriverApi& driver) const;
+    size_t commitSlow(FEngine::DriverApi& driver, void* staging) const;
 
     // keep these grouped, they're accessed together in the render-loop
     FMaterial const* mMaterial = nullptr;
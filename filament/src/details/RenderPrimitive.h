@@ -55,6 +55,11 @@ public:
     AttributeBitset getEnabledAttributes() const noexcept { return mEnabledAttributes; }
     uint16_t getBlendOrder() const noexcept { return mBlendOrder; }
 
+    // an empty primitive doesn't generate any draw command
+    bool isEmpty() const noexcept {
+        return mPrimitiveType == backend::PrimitiveType::NONE || !mIndexCount;
+    }
+
     void setMaterialInstance(FMaterialInstance const* mi) noexcept { mMaterialInstance = mi; }
     void setBlendOrder(uint16_t order) noexcept {
         mBlendOrder = static_cast<uint16_t>(order & 0x7FFF);
@@ -65,6 +70,7 @@ private:
     backend::Handle<backend::HwRenderPrimitive> mHandle;
     backend::PrimitiveType mPrimitiveType = backend::PrimitiveType::NONE;
     AttributeBitset mEnabledAttributes;
+    uint32_t mIndexCount = 0;
     uint16_t mBlendOrder = 0;
 };
 
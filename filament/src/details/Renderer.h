@@ -24,6 +24,8 @@
 
 #include "details/Allocators.h"
 #include "details/FrameSkipper.h"
+#include "details/FrameStatisticsRecorder.h"
+#include "details/GpuTimerManager.h"
 #include "details/SwapChain.h"
 
 #include "private/backend/DriverApiForward.h"
@@ -80,6 +82,14 @@ public:
 
     void resetUserTime();
 
+    PassTimingReport getPassTimingReport() const noexcept {
+        return mGpuTimerManager.getReport();
+    }
+
+    size_t getFrameStatistics(FrameStatistics* out, size_t count) const noexcept {
+        return mFrameStatistics.getHistory(out, count);
+    }
+
     void readPixels(uint32_t xoffset, uint32_t yoffset, uint32_t width, uint32_t height,
             backend::PixelBufferDescriptor&& buffer);
 
@@ -100,7 +110,10 @@ private:
             uint32_t xoffset, uint32_t yoffset, uint32_t width, uint32_t height,
             backend::PixelBufferDescriptor&& buffer);
 
-    static RenderPass::CommandTypeFlags getCommandType(View::DepthPrepass prepass) noexcept;
+    // depthPrepassDone is true when the color pass' depth buffer already contains the depth
+    // pre-pass
+    static RenderPass::CommandTypeFlags getCommandType(View::DepthPrepass prepass,
+            bool depthPrepassDone) noexcept;
 
     struct PrepareColorPassesData {
         FrameGraphId<FrameGraphTexture> ssao;
@@ -123,6 +136,10 @@ private:
         return mCommandsHighWatermark * sizeof(RenderPass::Command);
     }
 
+    // latest frame time measurement of this view for dynamic resolution, zero if there is no
+    // new one
+    FrameInfo::duration getFrameTime(FView& view) noexcept;
+
     backend::TextureFormat getHdrFormat(const View& view, bool translucent) const noexcept;
     backend::TextureFormat getLdrFormat(bool translucent) const noexcept;
 
@@ -138,6 +155,8 @@ private:
     // keep a reference to our engine
     FEngine& mEngine;
     FrameSkipper mFrameSkipper;
+    GpuTimerManager mGpuTimerManager;
+    FrameStatisticsRecorder mFrameStatistics;
     backend::Handle<backend::HwRenderTarget> mRenderTarget;
     FSwapChain* mSwapChain = nullptr;
     size_t mCommandsHighWatermark = 0;
@@ -25,6 +25,7 @@
 #include "details/Culler.h"
 
 #include "Allocators.h"
+#include "UniformBuffer.h"
 
 #include <filament/Box.h>
 #include <filament/Scene.h>
@@ -103,6 +104,7 @@ public:
         WORLD_AABB_CENTER,      // 12 | world-space bounding box center of the renderable
         VISIBLE_MASK,           //  1 | each bit represents a visibility in a pass
         MORPH_WEIGHTS,          //  4 | floats for morphing
+        POSITION_QUANTIZATION,  // 24 | bounds of quantized positions, empty if not quantized
 
         // These are not needed anymore after culling
         LAYERS,                 //  1 | layers
@@ -122,6 +124,7 @@ public:
             math::float3,                               // WORLD_AABB_CENTER
             Culler::result_type,                        // VISIBLE_MASK
             math::float4,                               // MORPH_WEIGHTS
+            Box,                                        // POSITION_QUANTIZATION
             uint8_t,                                    // LAYERS
             math::float3,                               // WORLD_AABB_EXTENT
             utils::Slice<FRenderPrimitive>,             // PRIMITIVES
@@ -166,7 +169,16 @@ public:
     LightSoa const& getLightData() const noexcept { return mLightData; }
     LightSoa& getLightData() noexcept { return mLightData; }
 
-    void updateUBOs(utils::Range<uint32_t> visibleRenderables, backend::Handle<backend::HwUniformBuffer> renderableUbh) noexcept;
+    // Updates the per-renderable UBO for the given renderables. renderableUb holds a CPU copy of
+    // the UBO and is used to skip renderables whose data hasn't changed.
+    void updateUBOs(utils::Range<uint32_t> visibleRenderables, UniformBuffer& renderableUb,
+            backend::Handle<backend::HwUniformBuffer> renderableUbh) noexcept;
+
+    // Index of a renderable's PerRenderableUib in the per-renderable UBO. This is stable across
+    // frames (unlike the index in the RenderableSoa), which allows the UBO to persist.
+    static inline uint32_t getRenderableUboIndex(RenderableSoa const& soa, uint32_t i) noexcept {
+        return soa.elementAt<RENDERABLE_INSTANCE>(i).asValue();
+    }
 
 private:
     static inline void computeLightRanges(math::float2* zrange,
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_DETAILS_SHADOWCASTERCULLER_H
+#define TNT_FILAMENT_DETAILS_SHADOWCASTERCULLER_H
+
+#include "details/Culler.h"
+#include "details/Scene.h"
+
+#include <filament/Box.h>
+
+#include <math/mat4.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+
+#include <array>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+namespace details {
+
+/*
+ * Culls the shadow casters of a directional light that can't cast a shadow on any visible
+ * shadow receiver.
+ *
+ * The visible receivers are rasterized in a coarse grid in light-space, each cell keeping the
+ * depth of the receiver farthest from the light. Because the light is directional, a receiver
+ * can only be shadowed by what's in its extrusion towards the light, so a caster is kept only
+ * if it overlaps a cell whose farthest receiver is behind the caster's nearest point.
+ *
+ * This works only on the renderables' world-space bounds, it's conservative: casters that are
+ * kept might still not cast a visible shadow, but culled casters never do.
+ */
+class ShadowCasterCuller {
+public:
+    // resolution of the light-space receivers grid
+    static constexpr size_t GRID_SIZE = 16;
+
+    ShadowCasterCuller() noexcept;
+
+    /*
+     * Builds the light-space receivers grid, this replaces the previous content.
+     *
+     * lightView        the light's view matrix (world to light-space), the light looks
+     *                  towards -z.
+     * visibleLayers    renderables not in these layers are ignored.
+     * receiverMask     a renderable is a visible receiver if it receives shadows and has any of
+     *                  these bits set in its VISIBLE_MASK (or has culling disabled).
+     */
+    void buildReceivers(math::mat4f const& lightView, FScene::RenderableSoa const& soa,
+            uint8_t visibleLayers, Culler::result_type receiverMask) noexcept;
+
+    /*
+     * Clears the casterMask bits of the VISIBLE_MASK of the renderables that can't shadow any
+     * of the receivers. Must be called after buildReceivers().
+     * Returns the number of renderables that had their bits cleared.
+     */
+    size_t cullCasters(FScene::RenderableSoa& soa, Culler::result_type casterMask) const noexcept;
+
+    // whether there was any visible receiver. Valid after buildReceivers().
+    bool hasReceivers() const noexcept { return mHasReceivers; }
+
+private:
+    static Aabb toLightSpace(math::mat4f const& lightView,
+            math::float3 const& center, math::float3 const& extent) noexcept;
+
+    // returns the inclusive range of cells covered by [min, max]
+    inline void getCellRange(math::float2 const& min, math::float2 const& max,
+            math::uint2& first, math::uint2& last) const noexcept;
+
+    math::mat4f mLightView;
+    math::float2 mGridOrigin = {};
+    math::float2 mGridScale = {};
+    // light-space z of the receiver farthest from the light in each cell,
+    // +infinity when a cell has no receivers.
+    std::array<float, GRID_SIZE * GRID_SIZE> mFarthestReceiver{};
+    bool mHasReceivers = false;
+};
+
+} // namespace details
+} // namespace filament
+
+#endif // TNT_FILAMENT_DETAILS_SHADOWCASTERCULLER_H
@@ -25,11 +25,21 @@
 #include "private/backend/DriverApiForward.h"
 #include "private/backend/SamplerGroup.h"
 
+#include <private/filament/EngineEnums.h>
+
+#include <filament/View.h>
 #include <filament/Viewport.h>
 
+#include <utils/Range.h>
+
 #include <math/mat4.h>
 #include <math/vec4.h>
 
+#include <array>
+#include <limits>
+#include <utility>
+#include <vector>
+
 namespace filament {
 namespace details {
 
@@ -48,9 +58,10 @@ public:
     void update(const FScene::LightSoa& lightData, size_t index, FScene const* scene,
             details::CameraInfo const& camera, uint8_t visibleLayers) noexcept;
 
-    void render(backend::DriverApi& driver, RenderPass& pass, FView& view) noexcept;
+    // Renders all the cascades with visible shadows, each in its own layer of the shadow map.
+    void render(backend::DriverApi& driver, RenderPass const& pass, FView& view) noexcept;
 
-    // Do we have visible shadows. Valid after calling update().
+    // Do we have visible shadows in any cascade. Valid after calling update().
     bool hasVisibleShadows() const noexcept { return mHasVisibleShadows; }
 
     // Allocates shadow texture based on user parameters (e.g. dimensions)
@@ -59,22 +70,76 @@ public:
     // Returns the shadow map's viewport. Valid after prepare().
     Viewport const& getViewport() const noexcept { return mViewport; }
 
-    backend::Handle<backend::HwRenderTarget> getRenderTarget() const { return mShadowMapRenderTarget; }
+    // Number of cascades in use, always 1 for non directional lights. Valid after update().
+    size_t getCascadeCount() const noexcept { return mCascadeCount; }
+
+    // View-space distance of the far plane of each cascade, unused cascades are set to
+    // +infinity. Valid after update().
+    math::float4 const& getCascadeSplits() const noexcept { return mCascadeSplits; }
+
+    // Do we have visible shadows in this cascade. Valid after calling update().
+    bool hasVisibleShadows(size_t cascade) const noexcept {
+        return mCascades[cascade].hasVisibleShadows;
+    }
+
+    backend::Handle<backend::HwRenderTarget> getRenderTarget(size_t cascade = 0) const noexcept {
+        return mCascades[cascade].renderTarget;
+    }
 
     // Computes the transform to use in the shader to access the shadow map.
     // Valid after calling update().
-    math::mat4f const& getLightSpaceMatrix() const noexcept { return mLightSpace; }
+    math::mat4f const& getLightSpaceMatrix(size_t cascade = 0) const noexcept {
+        return mCascades[cascade].lightSpace;
+    }
 
     // return the size of a texel in world space (pre-warping)
-    float getTexelSizeWorldSpace() const noexcept { return mTexelSizeWs; }
+    float getTexelSizeWorldSpace(size_t cascade = 0) const noexcept {
+        return mCascades[cascade].texelSizeWs;
+    }
+
+    // Returns the light's view matrix (world to light-space, without the projection),
+    // shared by all cascades. Valid after calling update().
+    math::mat4f const& getLightViewMatrix() const noexcept { return mLightView; }
 
     // Returns the light's projection. Valid after calling update().
-    FCamera const& getCamera() const noexcept { return *mCamera; }
+    FCamera const& getCamera(size_t cascade = 0) const noexcept {
+        return *mCascades[cascade].camera;
+    }
 
     // use only for debugging
     FCamera const& getDebugCamera() const noexcept { return *mDebugCamera; }
 
+    // When caching is enabled, render() is skipped if neither the light's camera nor the
+    // shadow casters changed since the shadow map was last rendered.
+    void setCachingEnabled(bool enabled) noexcept;
+    void invalidateCache() noexcept;
+    View::ShadowCacheStats const& getCacheStats() const noexcept { return mCacheStats; }
+
+    // Computes the view-space distances of the far plane of each cascade, between near and far.
+    // Unused entries are set to +infinity. Exposed for testing.
+    static math::float4 computeCascadeSplits(LightManager::ShadowOptions const& options,
+            size_t cascadeCount, float near, float far) noexcept;
+
 private:
+    struct Cascade {
+        FCamera* camera = nullptr;
+        math::mat4f lightSpace;
+        float texelSizeWs = 0.0f;
+        bool hasVisibleShadows = false;
+        // one render target per layer of the shadow map, set-up in prepare()
+        backend::Handle<backend::HwRenderTarget> renderTarget;
+        // shadow map cache, the key holds everything that affects the content of this cascade
+        std::vector<uint32_t> cacheKey;
+        bool cacheValid = false;
+    };
+
+    // shadow casters and receivers bounds, shared by all cascades
+    struct SceneBounds {
+        Aabb wsShadowCastersVolume;
+        Aabb wsShadowReceiversVolume;
+        math::float2 lsNearFar;     // light-space near/far of the shadow casters
+    };
+
     struct CameraInfo {
         math::mat4f projection;
         math::mat4f model;
@@ -102,10 +167,9 @@ private:
     // 8 corners, 12 segments w/ 2 intersection max -- all of this twice (8 + 12 * 2) * 2 (768 bytes)
     using FrustumBoxIntersection = std::array<math::float3, 64>;
 
-    void computeShadowCameraDirectional(
-            math::float3 const& direction, FScene const* scene,
-            CameraInfo const& camera, FLightManager::ShadowParams const& params,
-            uint8_t visibleLayers) noexcept;
+    void computeShadowCameraDirectional(Cascade& cascade, FCamera* debugCamera,
+            math::float3 const& direction, math::mat4f const& Mv, SceneBounds const& sceneBounds,
+            CameraInfo const& camera, FLightManager::ShadowParams const& params) noexcept;
 
     static math::mat4f applyLISPSM(math::mat4f& Wp,
             CameraInfo const& camera, FLightManager::ShadowParams const& params,
@@ -174,6 +238,12 @@ private:
 
     void fillWithDebugPattern(backend::DriverApi& driverApi) const noexcept;
 
+    // writes everything that affects the content of the shadow map into key, and returns whether
+    // the shadow casters can be cached at all.
+    bool computeCacheKey(std::vector<uint32_t>& key, FCamera const& camera,
+            FScene::RenderableSoa const& renderableData, utils::Range<uint32_t> casters,
+            Culler::result_type visibilityMask) const noexcept;
+
     static constexpr const Segment sBoxSegments[12] = {
             { 0, 1 }, { 1, 3 }, { 3, 2 }, { 2, 0 },
             { 4, 5 }, { 5, 7 }, { 7, 6 }, { 6, 4 },
@@ -188,18 +258,19 @@ private:
             { 2, 6, 7, 3 },  // top
     };
 
-    FCamera* mCamera = nullptr;
+    std::array<Cascade, CONFIG_MAX_SHADOW_CASCADES> mCascades;
+    math::mat4f mLightView;
     FCamera* mDebugCamera = nullptr;
-    math::mat4f mLightSpace;
-    float mTexelSizeWs = 0.0f;
 
     // set-up in prepare()
     Viewport mViewport;
     backend::Handle<backend::HwTexture> mShadowMapHandle;
-    backend::Handle<backend::HwRenderTarget> mShadowMapRenderTarget;
+    uint8_t mLayerCount = 0;
 
     // set-up in update()
     uint32_t mShadowMapDimension = 0;
+    uint8_t mCascadeCount = 1;
+    math::float4 mCascadeSplits{ std::numeric_limits<float>::infinity() };
     math::float3 mShadowMapResolution = {};     // 1 / effective resolution
     bool mHasVisibleShadows = false;
     backend::PolygonOffset mPolygonOffset{};
@@ -208,6 +279,11 @@ private:
     // initialization of the float3 each time
     FrustumBoxIntersection mWsClippedShadowReceiverVolume;
 
+    // shadow map cache, the keys are kept per cascade
+    bool mCachingEnabled = false;
+    std::vector<uint32_t> mCacheKey;    // scratch key, swapped with the cascade's
+    View::ShadowCacheStats mCacheStats;
+
     FEngine& mEngine;
     const bool mClipSpaceFlipped;
 };
@@ -27,6 +27,8 @@
 #include "details/Camera.h"
 #include "details/Froxelizer.h"
 #include "details/RenderTarget.h"
+#include "details/DynamicResolutionController.h"
+#include "details/ShadowCasterCuller.h"
 #include "details/ShadowMap.h"
 #include "details/Scene.h"
 
@@ -53,6 +55,7 @@ namespace details {
 
 class FEngine;
 class FMaterialInstance;
+class FrameStatisticsRecorder;
 class FRenderer;
 class FScene;
 
@@ -65,8 +68,10 @@ public:
 
     void terminate(FEngine& engine);
 
+    // stats is where the scene prepare and culling times are accounted, it can be null
     void prepare(FEngine& engine, backend::DriverApi& driver, ArenaScope& arena,
-            Viewport const& viewport, math::float4 const& userTime) noexcept;
+            Viewport const& viewport, math::float4 const& userTime,
+            FrameStatisticsRecorder* stats) noexcept;
 
     void setScene(FScene* scene) { mScene = scene; }
     FScene const* getScene() const noexcept { return mScene; }
@@ -142,6 +147,18 @@ public:
 
     void setShadowsEnabled(bool enabled) noexcept { mShadowingEnabled = enabled; }
 
+    void setShadowCachingEnabled(bool enabled) noexcept {
+        mDirectionalShadowMap.setCachingEnabled(enabled);
+    }
+
+    void invalidateShadowCache() noexcept {
+        mDirectionalShadowMap.invalidateCache();
+    }
+
+    ShadowCacheStats getShadowCacheStats() const noexcept {
+        return mDirectionalShadowMap.getCacheStats();
+    }
+
     ShadowMap const& getShadowMap() const { return mDirectionalShadowMap; }
     ShadowMap& getShadowMap() { return mDirectionalShadowMap; }
 
@@ -149,6 +166,13 @@ public:
         return &mDirectionalShadowMap.getDebugCamera();
     }
 
+    // bits of the VISIBLE_MASK set for the shadow casters of each directional shadow cascade
+    static constexpr size_t VISIBLE_DIR_SHADOW_CASCADE_FIRST_BIT = 2u;
+
+    static Culler::result_type getShadowCascadeVisibilityMask(size_t cascade) noexcept {
+        return Culler::result_type(1u << (VISIBLE_DIR_SHADOW_CASCADE_FIRST_BIT + cascade));
+    }
+
     void setRenderTarget(FRenderTarget* renderTarget, TargetBufferFlags discard) noexcept {
         mRenderTarget = renderTarget;
         mDiscardedTargetBuffers = discard;
@@ -200,7 +224,15 @@ public:
         return mHasPostProcessPass;
     }
 
-    math::float2 updateScale(std::chrono::duration<float, std::milli> frameTime) noexcept;
+    // frameTime is zero when there is no new measurement since the last call
+    math::float2 updateScale(std::chrono::duration<float, std::milli> frameTime,
+            bool gpuFrameTime) noexcept;
+
+    DynamicResolutionStatistics getDynamicResolutionStatistics() const noexcept;
+
+    // id of the last frame whose GPU time was fed to updateScale()
+    uint32_t getLastTimedFrameId() const noexcept { return mLastTimedFrameId; }
+    void setLastTimedFrameId(uint32_t frameId) noexcept { mLastTimedFrameId = frameId; }
 
     void setDynamicResolutionOptions(View::DynamicResolutionOptions const& options) noexcept;
 
@@ -282,13 +314,12 @@ public:
     }
 
 private:
-    static constexpr size_t MAX_FRAMETIME_HISTORY = 32u;
-
     void prepareVisibleRenderables(utils::JobSystem& js,
             Frustum const& frustum, FScene::RenderableSoa& renderableData) const noexcept;
 
     static void prepareVisibleShadowCasters(utils::JobSystem& js,
-            Frustum const& lightFrustum, FScene::RenderableSoa& renderableData) noexcept;
+            Frustum const& lightFrustum, FScene::RenderableSoa& renderableData,
+            size_t cascade) noexcept;
 
     static void prepareVisibleLights(
             FLightManager const& lcm, utils::JobSystem& js, Frustum const& frustum,
@@ -356,16 +387,19 @@ private:
 
     using duration = std::chrono::duration<float, std::milli>;
     DynamicResolutionOptions mDynamicResolution;
-    std::array<duration, MAX_FRAMETIME_HISTORY> mFrameTimeHistory;
-    size_t mFrameTimeHistorySize = 0;
+    DynamicResolutionController mDynamicResolutionController;
+    bool mGpuFrameTime = false;
+    uint32_t mLastTimedFrameId = 0;
 
     math::float2 mScale = 1.0f;
-    float mDynamicWorkloadScale = 1.0f;
     bool mIsDynamicResolutionSupported = false;
 
     RenderQuality mRenderQuality;
 
     mutable UniformBuffer mPerViewUb;
+
+    // CPU copy of the per-renderable UBO, used as a cache across frames
+    UniformBuffer mRenderableUb;
     mutable backend::SamplerGroup mPerViewSb;
 
     utils::CString mName;
@@ -378,6 +412,7 @@ private:
     mutable bool mHasDynamicLighting = false;
     mutable bool mHasShadowing = false;
     mutable ShadowMap mDirectionalShadowMap;
+    ShadowCasterCuller mShadowCasterCuller;
 };
 
 FILAMENT_UPCAST(View)
@@ -26,6 +26,7 @@
 #include "fg/VirtualResource.h"
 
 #include "details/Engine.h"
+#include "details/GpuTimerManager.h"
 
 #include <backend/DriverEnums.h>
 #include <backend/Handle.h>
@@ -674,11 +675,17 @@ void FrameGraph::reset() noexcept {
     mId = 0;
 }
 
-void FrameGraph::execute(FEngine& engine, DriverApi& driver) noexcept {
+void FrameGraph::execute(FEngine& engine, DriverApi& driver, GpuTimerManager* timers) noexcept {
     auto const& passNodes = mPassNodes;
     for (PassNode const& node : passNodes) {
         if (node.refCount) {
+            if (timers) {
+                timers->beginPass(driver, node.name);
+            }
             executeInternal(node, driver);
+            if (timers) {
+                timers->endPass(driver);
+            }
             if (&node != &passNodes.back()) {
                 // wake-up the driver thread and consume data in the command queue, this helps with
                 // latency, parallelism and memory pressure in the command queue.
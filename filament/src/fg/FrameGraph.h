@@ -48,6 +48,7 @@ namespace filament {
 
 namespace details {
 class FEngine;
+class GpuTimerManager;
 } // namespace details
 
 namespace fg {
@@ -247,8 +248,10 @@ public:
     // allocates concrete resources and culls unreferenced passes
     FrameGraph& compile() noexcept;
 
-    // execute all referenced passes and flush the command queue after each pass
-    void execute(details::FEngine& engine, backend::DriverApi& driver) noexcept;
+    // execute all referenced passes and flush the command queue after each pass.
+    // If timers is provided, the GPU time of each pass is measured.
+    void execute(details::FEngine& engine, backend::DriverApi& driver,
+            details::GpuTimerManager* timers = nullptr) noexcept;
 
 
     /*
@@ -38,7 +38,12 @@
 #include "details/Allocators.h"
 #include "details/Material.h"
 #include "details/Camera.h"
+#include "details/DynamicResolutionController.h"
+#include "details/FrameStatisticsRecorder.h"
 #include "details/Froxelizer.h"
+#include "details/LightTree.h"
+#include "details/ShadowCasterCuller.h"
+#include "details/ShadowMap.h"
 #include "details/Engine.h"
 #include "components/RenderableManager.h"
 #include "components/TransformManager.h"
@@ -500,6 +505,122 @@ TEST(FilamentTest, UniformBufferSize2) {
     buffer.invalidate();
 }
 
+TEST(FilamentTest, UniformBufferDirtyRanges) {
+    UniformBuffer buffer(256);
+
+    // a new buffer is entirely dirty
+    EXPECT_TRUE(buffer.isDirty());
+    EXPECT_EQ(1, buffer.getDirtyRangeCount());
+    EXPECT_EQ(256, buffer.getDirtySize());
+    buffer.clean();
+    EXPECT_FALSE(buffer.isDirty());
+    EXPECT_EQ(0, buffer.getDirtySize());
+
+    // adjacent and overlapping ranges are coalesced
+    buffer.setUniform(16, 1.0f);
+    buffer.setUniform(20, 1.0f);
+    buffer.setUniform(16, float2(1.0f));
+    EXPECT_EQ(1, buffer.getDirtyRangeCount());
+    EXPECT_EQ(16, buffer.getDirtyRange(0).begin);
+    EXPECT_EQ(24, buffer.getDirtyRange(0).end);
+
+    // disjoint ranges are kept sorted
+    buffer.setUniform(128, float4(1.0f));
+    buffer.setUniform(64, 1.0f);
+    EXPECT_EQ(3, buffer.getDirtyRangeCount());
+    EXPECT_EQ(16, buffer.getDirtyRange(0).begin);
+    EXPECT_EQ(64, buffer.getDirtyRange(1).begin);
+    EXPECT_EQ(128, buffer.getDirtyRange(2).begin);
+    EXPECT_EQ(8 + 4 + 16, buffer.getDirtySize());
+
+    // a range spanning several ranges merges them all
+    buffer.setUniform(60, float4(1.0f));
+    buffer.setUniform(20, mat4f());
+    EXPECT_EQ(2, buffer.getDirtyRangeCount());
+    EXPECT_EQ(16, buffer.getDirtyRange(0).begin);
+    EXPECT_EQ(84, buffer.getDirtyRange(0).end);
+
+    // when we run out of ranges, the closest ones are merged
+    buffer.clean();
+    buffer.setUniform(0, 1.0f);
+    buffer.setUniform(64, 1.0f);
+    buffer.setUniform(128, 1.0f);
+    buffer.setUniform(200, 1.0f);
+    buffer.setUniform(208, 1.0f);
+    EXPECT_EQ(UniformBuffer::MAX_DIRTY_RANGES, buffer.getDirtyRangeCount());
+    EXPECT_EQ(200, buffer.getDirtyRange(3).begin);
+    EXPECT_EQ(212, buffer.getDirtyRange(3).end);
+    EXPECT_EQ(4 + 4 + 4 + 12, buffer.getDirtySize());
+
+    // invalidating everything collapses to a single range
+    buffer.invalidate();
+    EXPECT_EQ(1, buffer.getDirtyRangeCount());
+    EXPECT_EQ(256, buffer.getDirtySize());
+}
+
+TEST(FilamentTest, UniformBufferScatteredDirtyRanges) {
+    // a large buffer with updates scattered across it, e.g. the per-renderable UBO
+    constexpr size_t stride = 256;
+    constexpr size_t count = 1024;
+    UniformBuffer buffer(stride * count);
+    buffer.clean();
+
+    // every 8th entry is modified, they're too far apart to be merged
+    for (size_t i = 0; i < count; i += 8) {
+        buffer.setUniform(i * stride, float4(1.0f));
+    }
+    EXPECT_EQ(count / 8, buffer.getDirtyRangeCount());
+    EXPECT_EQ(count / 8 * sizeof(float4), buffer.getDirtySize());
+
+    // ranges are still sorted, and survive a move
+    UniformBuffer moved(std::move(buffer));
+    EXPECT_EQ(count / 8, moved.getDirtyRangeCount());
+    for (size_t i = 0, c = moved.getDirtyRangeCount(); i < c; i++) {
+        EXPECT_EQ(i * 8 * stride, moved.getDirtyRange(i).begin);
+    }
+
+    // close ranges are merged, at the cost of uploading the clean data between them
+    UniformBuffer dense(stride * count);
+    dense.clean();
+    for (size_t i = 0; i < count; i++) {
+        dense.setUniform(i * stride, float4(1.0f));
+    }
+    const size_t span = (count - 1) * stride + sizeof(float4);
+    EXPECT_EQ(UniformBuffer::MAX_DIRTY_RANGES, dense.getDirtyRangeCount());
+    EXPECT_GE(span, dense.getDirtySize());
+    EXPECT_LE(span - (UniformBuffer::MAX_DIRTY_RANGES - 1) * (stride - sizeof(float4)),
+            dense.getDirtySize());
+}
+
+TEST(FilamentTest, UniformBufferDirtyRangesMat3) {
+    UniformBuffer buffer(128);
+    buffer.clean();
+
+    // a mat3f occupies 3 vec4 in std140, all of them must be uploaded
+    const mat3f m(float3{ 1, 2, 3 }, float3{ 4, 5, 6 }, float3{ 7, 8, 9 });
+    buffer.setUniform(32, m);
+    EXPECT_EQ(1, buffer.getDirtyRangeCount());
+    EXPECT_EQ(32, buffer.getDirtyRange(0).begin);
+    EXPECT_EQ(32 + 48, buffer.getDirtyRange(0).end);
+
+    // the uploaded bytes hold the padded columns
+    float const* uploaded = reinterpret_cast<float const*>(
+            static_cast<char const*>(buffer.getBuffer()) + buffer.getDirtyRange(0).begin);
+    for (size_t i = 0; i < 3; i++) {
+        EXPECT_EQ(m[i][0], uploaded[i * 4 + 0]);
+        EXPECT_EQ(m[i][1], uploaded[i * 4 + 1]);
+        EXPECT_EQ(m[i][2], uploaded[i * 4 + 2]);
+    }
+
+    // arrays of mat3f use the same layout
+    buffer.clean();
+    const mat3f array[2] = { m, m };
+    buffer.setUniformArray(0, array, 2);
+    EXPECT_EQ(96, buffer.getDirtySize());
+    uploaded = static_cast<float const*>(buffer.getBuffer());
+    EXPECT_EQ(9.0f, uploaded[4 * 5 + 2]);
+}
+
 TEST(FilamentTest, BoxCulling) {
     Frustum frustum(mat4f::frustum(-1, 1, -1, 1, 1, 100));
 
@@ -729,6 +850,228 @@ TEST(FilamentTest, FroxelData) {
     Engine::destroy((Engine **)&engine);
 }
 
+TEST(FilamentTest, LightTree) {
+    using namespace filament::details;
+
+    std::default_random_engine gen; // NOLINT
+    std::uniform_real_distribution<float> rand(-50.0f, 50.0f);
+
+    std::vector<float4> lights(1000);
+    for (float4& light : lights) {
+        light = { rand(gen), rand(gen), rand(gen), (rand(gen) + 50.0f) * 0.05f };
+    }
+    lights[0].w = -1.0f;    // ignored by the tree
+
+    LightTree tree;
+    tree.build(lights.data(), lights.size());
+
+    // the tree must find exactly the same lights as a brute-force search
+    for (size_t q = 0; q < 100; q++) {
+        const float4 s = { rand(gen), rand(gen), rand(gen), (rand(gen) + 50.0f) * 0.1f };
+        std::vector<size_t> found(lights.size(), 0);
+        tree.intersect(s, [&found](LightTree::index_type l) { found[l]++; });
+        for (size_t i = 0; i < lights.size(); i++) {
+            const float3 d = lights[i].xyz - s.xyz;
+            const float r = lights[i].w + s.w;
+            const bool expected = lights[i].w >= 0 && dot(d, d) < r * r;
+            EXPECT_EQ(expected ? 1u : 0u, found[i]);
+        }
+    }
+}
+
+TEST(FilamentTest, ShadowCascadeSplits) {
+    using namespace filament::details;
+    using CascadeSplitScheme = LightManager::CascadeSplitScheme;
+    constexpr float inf = std::numeric_limits<float>::infinity();
+
+    LightManager::ShadowOptions options;
+    options.cascadeSplitScheme = CascadeSplitScheme::UNIFORM;
+    float4 splits = ShadowMap::computeCascadeSplits(options, 4, 1.0f, 101.0f);
+    EXPECT_FLOAT_EQ(26.0f, splits[0]);
+    EXPECT_FLOAT_EQ(51.0f, splits[1]);
+    EXPECT_FLOAT_EQ(76.0f, splits[2]);
+    EXPECT_EQ(inf, splits[3]);
+
+    options.cascadeSplitScheme = CascadeSplitScheme::LOGARITHMIC;
+    splits = ShadowMap::computeCascadeSplits(options, 2, 1.0f, 100.0f);
+    EXPECT_FLOAT_EQ(10.0f, splits[0]);
+    EXPECT_EQ(inf, splits[1]);
+
+    options.cascadeSplitScheme = CascadeSplitScheme::PRACTICAL;
+    options.cascadeSplitLambda = 0.5f;
+    splits = ShadowMap::computeCascadeSplits(options, 2, 1.0f, 100.0f);
+    EXPECT_FLOAT_EQ((50.5f + 10.0f) * 0.5f, splits[0]);
+
+    // the logarithmic splits fall back to uniform ones when near <= 0
+    options.cascadeSplitScheme = CascadeSplitScheme::LOGARITHMIC;
+    splits = ShadowMap::computeCascadeSplits(options, 2, 0.0f, 100.0f);
+    EXPECT_FLOAT_EQ(50.0f, splits[0]);
+    splits = ShadowMap::computeCascadeSplits(options, 2, -10.0f, 100.0f);
+    EXPECT_FLOAT_EQ(45.0f, splits[0]);
+    options.cascadeSplitScheme = CascadeSplitScheme::PRACTICAL;
+    splits = ShadowMap::computeCascadeSplits(options, 4, 0.0f, 100.0f);
+    EXPECT_FLOAT_EQ(25.0f, splits[0]);
+    EXPECT_FLOAT_EQ(50.0f, splits[1]);
+    EXPECT_FLOAT_EQ(75.0f, splits[2]);
+
+    options.cascadeSplitScheme = CascadeSplitScheme::CUSTOM;
+    options.cascadeSplitPositions[0] = 0.5f;
+    options.cascadeSplitPositions[1] = 0.25f;   // not increasing
+    splits = ShadowMap::computeCascadeSplits(options, 3, 0.0f, 100.0f);
+    EXPECT_FLOAT_EQ(50.0f, splits[0]);
+    EXPECT_FLOAT_EQ(50.0f, splits[1]);
+    EXPECT_EQ(inf, splits[2]);
+
+    // a single cascade doesn't split anything
+    splits = ShadowMap::computeCascadeSplits(options, 1, 1.0f, 100.0f);
+    EXPECT_EQ(inf, splits[0]);
+}
+
+TEST(FilamentTest, ShadowCasterCuller) {
+    using namespace filament::details;
+    constexpr Culler::result_type RECEIVER = 0x1;
+    constexpr Culler::result_type CASTER = 0x4;
+
+    // the light points down, world -y becomes light-space -z
+    const mat4f lightView = FCamera::rigidTransformInverse(
+            mat4f::lookAt(float3{}, float3{ 0, -1, 0 }, float3{ 0, 0, 1 }));
+
+    FScene::RenderableSoa soa;
+    auto add = [&soa](float3 center, float3 extent, bool receives, Culler::result_type mask) {
+        soa.resize(soa.size() + 1);
+        const size_t i = soa.size() - 1;
+        FRenderableManager::Visibility v{};
+        v.castShadows = true;
+        v.receiveShadows = receives;
+        v.culling = true;
+        soa.elementAt<FScene::WORLD_AABB_CENTER>(i) = center;
+        soa.elementAt<FScene::WORLD_AABB_EXTENT>(i) = extent;
+        soa.elementAt<FScene::VISIBILITY_STATE>(i) = v;
+        soa.elementAt<FScene::LAYERS>(i) = 0x1;
+        soa.elementAt<FScene::VISIBLE_MASK>(i) = mask;
+        return i;
+    };
+
+    // a visible ground plane, 10x10 around the origin
+    const size_t ground = add({ 0, 0, 0 }, { 5, 0.1f, 5 }, true, RECEIVER | CASTER);
+    // a caster above the ground
+    const size_t above = add({ 1, 2, 1 }, { 0.5f, 0.5f, 0.5f }, false, CASTER);
+    // a caster below the ground, it can't shadow it
+    const size_t below = add({ 1, -2, 1 }, { 0.5f, 0.5f, 0.5f }, false, CASTER);
+    // a caster far to the side, its shadow falls outside of the ground
+    const size_t aside = add({ 20, 2, 0 }, { 0.5f, 0.5f, 0.5f }, false, CASTER);
+    // a receiver that is not visible doesn't protect casters above it
+    add({ 20, -5, 20 }, { 1, 0.1f, 1 }, true, 0);
+    const size_t aboveInvisible = add({ 20, 2, 20 }, { 0.5f, 0.5f, 0.5f }, false, CASTER);
+
+    ShadowCasterCuller culler;
+    culler.buildReceivers(lightView, soa, 0x1, RECEIVER);
+    EXPECT_TRUE(culler.hasReceivers());
+    EXPECT_EQ(3u, culler.cullCasters(soa, CASTER));
+
+    auto const* mask = soa.data<FScene::VISIBLE_MASK>();
+    EXPECT_EQ(RECEIVER | CASTER, mask[ground]);
+    EXPECT_EQ(CASTER, mask[above]);
+    EXPECT_EQ(0, mask[below]);
+    EXPECT_EQ(0, mask[aside]);
+    EXPECT_EQ(0, mask[aboveInvisible]);
+
+    // without any visible receiver, all casters are culled
+    culler.buildReceivers(lightView, soa, 0x2, RECEIVER);
+    EXPECT_FALSE(culler.hasReceivers());
+    EXPECT_EQ(2u, culler.cullCasters(soa, CASTER));
+}
+
+TEST(FilamentTest, DynamicResolutionController) {
+    using namespace filament::details;
+
+    View::DynamicResolutionOptions options;
+    options.enabled = true;
+    options.targetFrameTimeMilli = 10.0f;
+    options.minScale = 0.5f;
+    options.maxScale = 1.0f;
+
+    DynamicResolutionController controller;
+    controller.setOptions(options);
+    EXPECT_EQ(0.0f, controller.getPercentile(0.5f));
+
+    // frames taking twice the budget must bring the scale down to the minimum area
+    for (size_t i = 0; i < 100; i++) {
+        controller.update(20.0f);
+    }
+    EXPECT_FLOAT_EQ(0.25f, controller.getAreaScale());
+
+    // frames well within budget must bring it back up to the maximum
+    for (size_t i = 0; i < 200; i++) {
+        controller.update(5.0f);
+    }
+    EXPECT_FLOAT_EQ(1.0f, controller.getAreaScale());
+
+    // a frame time proportional to the area must settle close to the target
+    for (size_t i = 0; i < 500; i++) {
+        controller.update(16.0f * controller.getAreaScale());
+    }
+    EXPECT_NEAR(10.0f / 16.0f, controller.getAreaScale(), 0.01f);
+
+    // percentiles over the last 100 frames
+    controller.reset();
+    for (size_t i = 1; i <= 100; i++) {
+        controller.update(float(i));
+    }
+    EXPECT_EQ(100u, controller.getSampleCount());
+    EXPECT_EQ(100.0f, controller.getLastFrameTime());
+    EXPECT_EQ(1.0f, controller.getPercentile(0.0f));
+    EXPECT_EQ(50.0f, controller.getPercentile(0.5f));
+    EXPECT_EQ(90.0f, controller.getPercentile(0.9f));
+    EXPECT_EQ(100.0f, controller.getPercentile(1.0f));
+}
+
+TEST(FilamentTest, FrameStatisticsHistory) {
+    using namespace filament;
+    using namespace filament::details;
+    using FrameStatistics = Renderer::FrameStatistics;
+
+    FEngine* engine = FEngine::create();
+    FrameStatisticsRecorder recorder(*engine);
+
+    FrameStatistics history[FrameStatistics::MAX_FRAME_COUNT + 1];
+    EXPECT_EQ(0u, recorder.getHistory(history, FrameStatistics::MAX_FRAME_COUNT + 1));
+
+    // the backend half of a frame can come in first, a frame is only visible with both halves
+    for (uint32_t frameId = 1; frameId <= 20; frameId++) {
+        FrameStatistics stats{};
+        stats.frameId = frameId;
+        stats.cullingMs = float(frameId);
+        if (frameId % 2) {
+            recorder.publishBackendPhases(frameId, 2.0f * frameId, 1.0f);
+            recorder.publishApplicationPhases(stats);
+        } else {
+            recorder.publishApplicationPhases(stats);
+            if (frameId != 18) {
+                recorder.publishBackendPhases(frameId, 2.0f * frameId, 1.0f);
+            }
+        }
+    }
+
+    // frames 5 to 20 are kept, frame 18 isn't complete
+    size_t count = recorder.getHistory(history, FrameStatistics::MAX_FRAME_COUNT + 1);
+    EXPECT_EQ(FrameStatistics::MAX_FRAME_COUNT - 1, count);
+    EXPECT_EQ(20u, history[0].frameId);
+    EXPECT_EQ(19u, history[1].frameId);
+    EXPECT_EQ(17u, history[2].frameId);
+    EXPECT_EQ(5u, history[count - 1].frameId);
+    EXPECT_EQ(19.0f, history[1].cullingMs);
+    EXPECT_EQ(38.0f, history[1].backendExecutionMs);
+    EXPECT_EQ(1.0f, history[1].swapMs);
+
+    // only the most recent frames are returned when asking for fewer
+    EXPECT_EQ(2u, recorder.getHistory(history, 2));
+    EXPECT_EQ(20u, history[0].frameId);
+    EXPECT_EQ(19u, history[1].frameId);
+
+    Engine::destroy((Engine **)&engine);
+}
+
 TEST(FilamentTest, Bones) {
     using namespace ::filament::details;
 
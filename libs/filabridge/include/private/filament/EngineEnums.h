@@ -54,6 +54,11 @@ constexpr size_t CONFIG_MAX_LIGHT_INDEX = CONFIG_MAX_LIGHT_COUNT - 1;
 // On some webGL platforms we only have 256 vec4s (defined by GL_MAX_VERTEX_UNIFORM_VECTORS) not 16Kib, so has to be smaller still
 constexpr size_t CONFIG_MAX_BONE_COUNT = 56;
 
+// Number of shadow cascades for the directional light, each cascade is a layer of the
+// shadow map texture array. This is limited to 4 because the cascade selection in the shaders
+// uses a vec4 of split distances.
+constexpr size_t CONFIG_MAX_SHADOW_CASCADES = 4;
+
 } // namespace filament
 
 #endif // TNT_FILAMENT_driver/EngineEnums.h
@@ -17,6 +17,7 @@
 #ifndef TNT_FILABRIDGE_UIBGENERATOR_H
 #define TNT_FILABRIDGE_UIBGENERATOR_H
 
+#include <private/filament/EngineEnums.h>
 
 #include <math/mat4.h>
 #include <math/vec4.h>
@@ -49,7 +50,7 @@ struct PerViewUib { // NOLINT(cppcoreguidelines-pro-type-member-init)
     filament::math::mat4f viewFromClipMatrix;
     filament::math::mat4f clipFromWorldMatrix;
     filament::math::mat4f worldFromClipMatrix;
-    filament::math::mat4f lightFromWorldMatrix;
+    filament::math::mat4f lightFromWorldMatrix[CONFIG_MAX_SHADOW_CASCADES]; // one per cascade
 
     filament::math::float4 resolution; // viewport width, height, 1/width, 1/height
 
@@ -86,10 +87,15 @@ struct PerViewUib { // NOLINT(cppcoreguidelines-pro-type-member-init)
     filament::math::float3 worldOffset; // this is (0,0,0) when camera_at_origin is disabled
     float padding1;
 
+    filament::math::float4 cascadeSplits;       // view-space far distance of each cascade
+    filament::math::float4 cascadeNormalBias;   // normal bias of each cascade, in world units
+
     // bring PerViewUib to 1 KiB
-    filament::math::float4 padding2[15];
+    filament::math::float4 padding2[1];
 };
 
+static_assert(sizeof(PerViewUib) == 1024, "PerViewUib must be 1 KiB");
+
 
 // PerRenderableUib must have an alignment of 256 to be compatible with all versions of GLES.
 struct alignas(256) PerRenderableUib {
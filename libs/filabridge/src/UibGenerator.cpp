@@ -43,7 +43,7 @@ UniformInterfaceBlock const& UibGenerator::getPerViewUib() noexcept  {
             .add("viewFromClipMatrix",      1, UniformInterfaceBlock::Type::MAT4, Precision::HIGH)
             .add("clipFromWorldMatrix",     1, UniformInterfaceBlock::Type::MAT4, Precision::HIGH)
             .add("worldFromClipMatrix",     1, UniformInterfaceBlock::Type::MAT4, Precision::HIGH)
-            .add("lightFromWorldMatrix",    1, UniformInterfaceBlock::Type::MAT4, Precision::HIGH)
+            .add("lightFromWorldMatrix",    CONFIG_MAX_SHADOW_CASCADES, UniformInterfaceBlock::Type::MAT4, Precision::HIGH)
             // view
             .add("resolution",              1, UniformInterfaceBlock::Type::FLOAT4, Precision::HIGH)
             // camera
@@ -78,9 +78,12 @@ UniformInterfaceBlock const& UibGenerator::getPerViewUib() noexcept  {
             .add("padding0",                1, UniformInterfaceBlock::Type::FLOAT2)
             // view
             .add("worldOffset",             1, UniformInterfaceBlock::Type::FLOAT3)
-            // bring size to 1 KiB
             .add("padding1",                1, UniformInterfaceBlock::Type::FLOAT)
-            .add("padding2",                15, UniformInterfaceBlock::Type::FLOAT4)
+            // shadow cascades
+            .add("cascadeSplits",           1, UniformInterfaceBlock::Type::FLOAT4, Precision::HIGH)
+            .add("cascadeNormalBias",       1, UniformInterfaceBlock::Type::FLOAT4)
+            // bring size to 1 KiB
+            .add("padding2",                1, UniformInterfaceBlock::Type::FLOAT4)
             .build();
     return uib;
 }
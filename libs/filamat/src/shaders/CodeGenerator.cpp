@@ -79,6 +79,12 @@ io::sstream& CodeGenerator::generateProlog(io::sstream& out, ShaderType type,
     out << "precision " << precision << " float;\n";
     out << "precision " << precision << " int;\n";
 
+    if (type == ShaderType::VERTEX) {
+        // The depth and color variants of a material must compute bit-identical positions, so
+        // that the color pass can use an equal depth test after the depth prepass.
+        out << "\ninvariant gl_Position;\n";
+    }
+
     out << SHADERS_COMMON_TYPES_FS_DATA;
 
     out << "\n";
@@ -591,6 +597,14 @@ char const* CodeGenerator::getSamplerTypeName(SamplerType type, SamplerFormat fo
                     case SamplerFormat::SHADOW: return "sampler2DShadow";   // should not happen
                 }
             }
+        case SamplerType::SAMPLER_2D_ARRAY:
+            assert(!multisample);
+            switch (format) {
+                case SamplerFormat::INT:    return "isampler2DArray";
+                case SamplerFormat::UINT:   return "usampler2DArray";
+                case SamplerFormat::FLOAT:  return "sampler2DArray";
+                case SamplerFormat::SHADOW: return "sampler2DArrayShadow";
+            }
         case SamplerType::SAMPLER_CUBEMAP:
             assert(!multisample);
             switch (format) {
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TNT_FILAMENT_FILAMESHIO_CLUSTERCULLER_H
+#define TNT_FILAMENT_FILAMESHIO_CLUSTERCULLER_H
+
+#include <filameshio/filamesh.h>
+
+#include <math/mat4.h>
+
+#include <utils/Entity.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace filament {
+    class Camera;
+    class Engine;
+}
+
+namespace filamesh {
+
+/**
+ * Culls the clusters of a filamesh renderable, see the CLUSTERS flag.
+ *
+ * Each part of the mesh is drawn with up to MAX_RANGES_PER_PART primitives. Every time cull()
+ * is called, the clusters outside of the camera frustum or facing away from the camera are
+ * rejected, and the index ranges of the remaining clusters are assigned to these primitives.
+ * When a part has more visible ranges than primitives, the ranges separated by the smallest gaps
+ * are merged, which draws a few culled clusters. Unused primitives are given an empty range.
+ *
+ * The primitives are shared by every view and by the shadow passes, so the renderable must only be
+ * rendered by the view whose camera is given to cull(). Shadow casters are never culled, since
+ * the shadow maps would miss the geometry culled for the camera: MeshReader builds cluster
+ * renderables with castShadows(false), and cull() draws whole parts if shadows are turned on.
+ *
+ * Instances are created by MeshReader when a mesh has clusters, and owned by the caller.
+ */
+class ClusterCuller {
+public:
+    static constexpr size_t MAX_RANGES_PER_PART = 8;
+
+    ClusterCuller(utils::Entity renderable, Cluster const* clusters, size_t clusterCount,
+            Part const* parts, size_t partCount);
+
+    ClusterCuller(ClusterCuller const&) = delete;
+    ClusterCuller& operator=(ClusterCuller const&) = delete;
+
+    /**
+     * Number of primitives the renderable must be built with.
+     */
+    size_t getPrimitiveCount() const noexcept { return mPrimitiveCount; }
+
+    /**
+     * Index of the first primitive of a part. The part's primitives are consecutive, the first
+     * one draws the whole part until cull() is called and the others are empty.
+     */
+    size_t getFirstPrimitive(size_t part) const noexcept { return mParts[part].firstPrimitive; }
+
+    /**
+     * Number of primitives used to draw a part.
+     */
+    size_t getPrimitiveCount(size_t part) const noexcept { return mParts[part].primitiveCount; }
+
+    /**
+     * Culls the clusters for the given camera, and updates the primitives of the renderable.
+     * The model matrix is the renderable's world transform, the normal cone test assumes it
+     * doesn't have a non-uniform scale. Returns the number of visible clusters, which is all of
+     * them if the renderable casts shadows.
+     */
+    size_t cull(filament::Engine& engine, filament::Camera const& camera,
+            filament::math::mat4f const& model);
+
+    /**
+     * Number of clusters of the mesh.
+     */
+    size_t getClusterCount() const noexcept { return mClusters.size(); }
+
+private:
+    struct PartInfo {
+        uint32_t offset;
+        uint32_t indexCount;
+        uint32_t firstCluster;
+        uint32_t clusterCount;
+        uint32_t firstPrimitive;
+        uint32_t primitiveCount;
+    };
+
+    struct Range {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    // merges ranges until there are at most budget of them
+    void mergeRanges(std::vector<Range>& ranges, size_t budget);
+
+    utils::Entity mRenderable;
+    std::vector<Cluster> mClusters;
+    std::vector<PartInfo> mParts;
+    std::vector<Range> mPrimitives;     // current range of each primitive
+    size_t mPrimitiveCount = 0;
+
+    // scratch buffers, kept to avoid allocations in cull()
+    std::vector<Range> mRanges;
+    std::vector<uint32_t> mGaps;
+};
+
+} // namespace filamesh
+
+#endif // TNT_FILAMENT_FILAMESHIO_CLUSTERCULLER_H
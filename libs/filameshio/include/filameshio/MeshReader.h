@@ -33,6 +33,7 @@ namespace utils {
 
 namespace filamesh {
 
+class ClusterCuller;
 
 /**
  * This API can be used to read meshes stored in the "filamesh" format produced
@@ -80,6 +81,10 @@ public:
         utils::Entity renderable;
         filament::VertexBuffer* vertexBuffer = nullptr;
         filament::IndexBuffer* indexBuffer = nullptr;
+
+        // Only set when the mesh has clusters, in which case it must be used to cull them every
+        // frame, see ClusterCuller. Owned by the caller.
+        ClusterCuller* clusters = nullptr;
     };
 
     /**
@@ -19,6 +19,8 @@
 
 #include <filament/Box.h>
 
+#include <math/vec3.h>
+
 namespace filamesh {
 
 using Box = filament::Box;
@@ -36,6 +38,8 @@ enum Flags : uint32_t {
     INTERLEAVED         = 1 << 0,
     TEXCOORD_SNORM16    = 1 << 1,
     COMPRESSION         = 1 << 2,
+    CLUSTERS            = 1 << 3,
+    POSITION_SNORM16    = 1 << 4,
 };
 
 // Each of these fields specifies a number of bytes within the compressed data. This is ignored
@@ -51,7 +55,7 @@ struct CompressionHeader {
 struct Header {
     uint32_t version;
     uint32_t parts;
-    Box      aabb;
+    Box      aabb;      // positions are normalized to this box with POSITION_SNORM16
     uint32_t flags;
     uint32_t offsetPosition;
     uint32_t stridePosition;
@@ -79,6 +83,20 @@ struct Part {
     Box aabb;
 };
 
+// A cluster (or meshlet) is a small group of neighboring triangles of a part, stored contiguously
+// in the index buffer, with bounds that allow culling it independently from the rest of the part.
+// Clusters are present when the CLUSTERS flag is enabled, sorted by part and by offset.
+struct Cluster {
+    uint32_t part;
+    uint32_t offset;
+    uint32_t indexCount;
+    filament::math::float3 center;      // bounding sphere
+    float radius;
+    filament::math::float3 coneApex;    // normal cone, for backface culling
+    filament::math::float3 coneAxis;
+    float coneCutoff;                   // cos(angle / 2), 1 if the cone can't be used
+};
+
 } // namespace filamesh
 
 #endif // TNT_FILAMENT_FILAMESHIO_FILAMESH_H
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filameshio/ClusterCuller.h>
+
+#include <filament/Camera.h>
+#include <filament/Engine.h>
+#include <filament/Frustum.h>
+#include <filament/RenderableManager.h>
+
+#include <math/vec4.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <math.h>
+
+using namespace filament;
+using namespace filament::math;
+
+namespace filamesh {
+
+constexpr size_t ClusterCuller::MAX_RANGES_PER_PART;
+
+ClusterCuller::ClusterCuller(utils::Entity renderable, Cluster const* clusters,
+        size_t clusterCount, Part const* parts, size_t partCount)
+        : mRenderable(renderable), mClusters(clusters, clusters + clusterCount) {
+    mParts.resize(partCount);
+    size_t cursor = 0;
+    for (size_t i = 0; i < partCount; i++) {
+        PartInfo& part = mParts[i];
+        part.offset = parts[i].offset;
+        part.indexCount = parts[i].indexCount;
+        part.firstCluster = uint32_t(cursor);
+        while (cursor < clusterCount && mClusters[cursor].part == i) {
+            cursor++;
+        }
+        part.clusterCount = uint32_t(cursor - part.firstCluster);
+        part.firstPrimitive = uint32_t(mPrimitiveCount);
+        part.primitiveCount = uint32_t(std::max(size_t(1),
+                std::min(size_t(part.clusterCount), MAX_RANGES_PER_PART)));
+        mPrimitiveCount += part.primitiveCount;
+
+        // until the first cull() the whole part is drawn by its first primitive
+        mPrimitives.push_back({ part.offset, part.indexCount });
+        mPrimitives.resize(mPrimitiveCount, { part.offset, 0 });
+    }
+}
+
+size_t ClusterCuller::cull(Engine& engine, Camera const& camera, mat4f const& model) {
+    RenderableManager& rm = engine.getRenderableManager();
+    const RenderableManager::Instance instance = rm.getInstance(mRenderable);
+    if (!instance) {
+        return 0;
+    }
+
+    // The shadow passes use the same primitives, so shadow casters are drawn whole.
+    const bool culling = !rm.isShadowCaster(instance);
+    const Frustum frustum = camera.getFrustum();
+
+    // Bounding spheres are tested in world space, normal cones in model space, where the camera
+    // position is all we need to transform.
+    const float3 eye = (inverse(model) * float4(camera.getPosition(), 1.0f)).xyz;
+    const float scale = std::sqrt(std::max({
+            dot(model[0].xyz, model[0].xyz),
+            dot(model[1].xyz, model[1].xyz),
+            dot(model[2].xyz, model[2].xyz) }));
+
+    size_t visibleCount = 0;
+    for (PartInfo const& part : mParts) {
+        if (!part.clusterCount) {
+            continue;
+        }
+
+        mRanges.clear();
+        Cluster const* const clusters = mClusters.data() + part.firstCluster;
+        for (size_t i = 0; i < part.clusterCount; i++) {
+            Cluster const& cluster = clusters[i];
+            const float3 center = (model * float4(cluster.center, 1.0f)).xyz;
+            const bool backFacing =
+                    dot(normalize(cluster.coneApex - eye), cluster.coneAxis) >= cluster.coneCutoff;
+            if (culling &&
+                    (backFacing || !frustum.intersects(float4(center, cluster.radius * scale)))) {
+                continue;
+            }
+            visibleCount++;
+            // clusters of a part are contiguous, so visible neighbors form a single range
+            if (!mRanges.empty() && mRanges.back().offset + mRanges.back().count == cluster.offset) {
+                mRanges.back().count += cluster.indexCount;
+            } else {
+                mRanges.push_back({ cluster.offset, cluster.indexCount });
+            }
+        }
+
+        mergeRanges(mRanges, part.primitiveCount);
+
+        for (size_t i = 0; i < part.primitiveCount; i++) {
+            const Range range = i < mRanges.size() ? mRanges[i] : Range{ part.offset, 0 };
+            Range& current = mPrimitives[part.firstPrimitive + i];
+            if (current.offset != range.offset || current.count != range.count) {
+                current = range;
+                rm.setGeometryAt(instance, part.firstPrimitive + i,
+                        RenderableManager::PrimitiveType::TRIANGLES, range.offset, range.count);
+            }
+        }
+    }
+    return visibleCount;
+}
+
+void ClusterCuller::mergeRanges(std::vector<Range>& ranges, size_t budget) {
+    const size_t count = ranges.size();
+    if (count <= budget) {
+        return;
+    }
+
+    // Only the (budget - 1) largest gaps between ranges stay open. Gaps equal to the threshold
+    // are kept open in order, until we run out of budget.
+    const size_t openGaps = budget - 1;
+    uint32_t threshold = std::numeric_limits<uint32_t>::max();
+    size_t openAtThreshold = 0;
+    if (openGaps) {
+        mGaps.resize(count - 1);
+        for (size_t i = 0; i < count - 1; i++) {
+            mGaps[i] = ranges[i + 1].offset - (ranges[i].offset + ranges[i].count);
+        }
+        std::nth_element(mGaps.begin(), mGaps.begin() + openGaps - 1, mGaps.end(),
+                std::greater<uint32_t>());
+        threshold = mGaps[openGaps - 1];
+        openAtThreshold = openGaps - std::count_if(mGaps.begin(), mGaps.begin() + openGaps,
+                [threshold](uint32_t gap) { return gap > threshold; });
+    }
+
+    size_t last = 0;
+    for (size_t i = 1; i < count; i++) {
+        Range& range = ranges[last];
+        const uint32_t end = range.offset + range.count;
+        const uint32_t gap = ranges[i].offset - end;
+        bool open = gap > threshold;
+        if (gap == threshold && openAtThreshold) {
+            openAtThreshold--;
+            open = true;
+        }
+        if (open) {
+            ranges[++last] = ranges[i];
+        } else {
+            range.count = ranges[i].offset + ranges[i].count - range.offset;
+        }
+    }
+    ranges.resize(last + 1);
+}
+
+} // namespace filamesh
@@ -15,6 +15,7 @@
  */
 
 #include <filameshio/MeshReader.h>
+#include <filameshio/ClusterCuller.h>
 #include <filameshio/filamesh.h>
 
 #include <filament/Box.h>
@@ -226,6 +227,15 @@ MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
         p += nameLength + 1; // null terminated
     }
 
+    uint32_t clusterCount = 0;
+    Cluster const* clusters = nullptr;
+    if (header->flags & CLUSTERS) {
+        memcpy(&clusterCount, p, sizeof(uint32_t));
+        p += sizeof(uint32_t);
+        clusters = (Cluster const*) p;
+        p += clusterCount * sizeof(Cluster);
+    }
+
     Mesh mesh;
 
     mesh.indexBuffer = IndexBuffer::Builder()
@@ -269,9 +279,15 @@ MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
     VertexBuffer::AttributeType uvtype = (header->flags & TEXCOORD_SNORM16) ?
             VertexBuffer::AttributeType::SHORT2 : VertexBuffer::AttributeType::HALF2;
 
+    // quantized positions are normalized to the bounding box of the mesh
+    const bool quantizedPositions = header->flags & POSITION_SNORM16;
+    VertexBuffer::AttributeType positiontype = quantizedPositions ?
+            VertexBuffer::AttributeType::SHORT4 : VertexBuffer::AttributeType::HALF4;
+
     vbb
-            .attribute(VertexAttribute::POSITION, 0, VertexBuffer::AttributeType::HALF4,
+            .attribute(VertexAttribute::POSITION, 0, positiontype,
                         header->offsetPosition, uint8_t(header->stridePosition))
+            .normalized(VertexAttribute::POSITION, quantizedPositions)
             .attribute(VertexAttribute::TANGENTS, 0, VertexBuffer::AttributeType::SHORT4,
                         header->offsetTangents, uint8_t(header->strideTangents))
             .attribute(VertexAttribute::COLOR, 0, VertexBuffer::AttributeType::UBYTE4,
@@ -349,20 +365,39 @@ MeshReader::Mesh MeshReader::loadMeshFromBuffer(filament::Engine* engine,
 
     mesh.renderable = utils::EntityManager::get().create();
 
-    RenderableManager::Builder builder(header->parts);
+    // With clusters, each part is drawn by several primitives, only the first one initially
+    // covers the whole part, the others are empty until the clusters are culled.
+    if (clusters) {
+        mesh.clusters = new ClusterCuller(mesh.renderable, clusters, clusterCount,
+                parts, header->parts);
+    }
+    const size_t primitiveCount = mesh.clusters ? mesh.clusters->getPrimitiveCount() : header->parts;
+
+    RenderableManager::Builder builder(primitiveCount);
     builder.boundingBox(header->aabb);
+    if (mesh.clusters) {
+        // the clusters are culled for the camera, see ClusterCuller
+        builder.castShadows(false);
+    }
+    if (quantizedPositions) {
+        builder.positionQuantization(header->aabb);
+    }
     const auto defaultmi = materials.getMaterialInstance(utils::CString(DEFAULT_MATERIAL));
     for (size_t i = 0; i < header->parts; i++) {
-        builder.geometry(i, RenderableManager::PrimitiveType::TRIANGLES,
-                            mesh.vertexBuffer, mesh.indexBuffer, parts[i].offset,
-                            parts[i].minIndex, parts[i].maxIndex, parts[i].indexCount);
         const utils::CString materialName(partsMaterial[i].c_str(), partsMaterial[i].size());
-        const auto mat = materials.getMaterialInstance(materialName);
+        auto mat = materials.getMaterialInstance(materialName);
         if (mat == nullptr) {
-            builder.material(i, defaultmi);
+            mat = defaultmi;
             materials.registerMaterialInstance(materialName, defaultmi);
-        } else {
-            builder.material(i, mat);
+        }
+        const size_t first = mesh.clusters ? mesh.clusters->getFirstPrimitive(i) : i;
+        const size_t count = mesh.clusters ? mesh.clusters->getPrimitiveCount(i) : 1;
+        for (size_t j = first; j < first + count; j++) {
+            builder.geometry(j, RenderableManager::PrimitiveType::TRIANGLES,
+                                mesh.vertexBuffer, mesh.indexBuffer, parts[i].offset,
+                                parts[i].minIndex, parts[i].maxIndex,
+                                j == first ? parts[i].indexCount : 0);
+            builder.material(j, mat);
         }
     }
     builder.build(*engine, mesh.renderable);
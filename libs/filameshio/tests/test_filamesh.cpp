@@ -14,14 +14,17 @@
  * limitations under the License.
  */
 
+#include <filament/Camera.h>
 #include <filament/Engine.h>
 #include <filament/Material.h>
 #include <filament/RenderableManager.h>
 
+#include <filameshio/ClusterCuller.h>
 #include <filameshio/filamesh.h>
 #include <filameshio/MeshReader.h>
 
 #include <math/half.h>
+#include <math/mat4.h>
 #include <math/mat3.h>
 #include <math/norm.h>
 #include <math/quat.h>
@@ -210,12 +213,147 @@ TEST_F(FilameshTest, Interleaved) {
     auto& rm = engine->getRenderableManager();
     auto inst = rm.getInstance(mesh.renderable);
     EXPECT_EQ(rm.getPrimitiveCount(inst), 1);
+    EXPECT_TRUE(rm.getPositionQuantization(inst).isEmpty());
 
     // Cleanup.
     engine->destroy(mesh.renderable);
     engine->destroy(mi);
 }
 
+TEST_F(FilameshTest, QuantizedPositions) {
+    // Serialize a single-triangle mesh with positions normalized to its bounding box
+    static const short4 quantizedPositions[] = {
+        packSnorm16(float4(-1, -1, 0, 1)),
+        packSnorm16(float4( 1, -1, 0, 1)),
+        packSnorm16(float4( 0,  1, 0, 1)),
+    };
+    const Box bounds = { .center = float3(10, 20, 30), .halfExtent = float3(2, 2, 0) };
+    const Header header {
+        .version = VERSION,
+        .parts = 1,
+        .aabb = bounds,
+        .flags = POSITION_SNORM16,
+        .offsetTangents = sizeof(quantizedPositions),
+        .offsetColor = sizeof(quantizedPositions) + sizeof(tangents),
+        .offsetUV0 = sizeof(quantizedPositions) + sizeof(tangents) + sizeof(colors),
+        .strideUV1 = maxint,
+        .vertexCount = vertexCount,
+        .vertexSize = sizeof(quantizedPositions) + sizeof(tangents) + sizeof(colors) + sizeof(uv0),
+        .indexType = IndexType::UI16,
+        .indexCount = 3,
+        .indexSize = sizeof(uint16_t) * 3
+    };
+    const uint32_t nmats = 1;
+    const string matname = "DefaultMaterial";
+    const uint32_t matnamelength = matname.size();
+
+    stringstream stream(ios_base::out);
+    write(stream, MAGICID, sizeof(MAGICID));
+    write(stream, &header, sizeof(header));
+    write(stream, quantizedPositions, sizeof(quantizedPositions));
+    write(stream, tangents, sizeof(tangents));
+    write(stream, colors, sizeof(colors));
+    write(stream, uv0, sizeof(uv0));
+    write(stream, indices, sizeof(indices));
+    write(stream, parts, sizeof(parts));
+    write(stream, &nmats, sizeof(nmats));
+    write(stream, &matnamelength, sizeof(matnamelength));
+    write(stream, matname.c_str(), matnamelength + 1);
+
+    // The bounding box of the renderable stays in model space.
+    MaterialInstance* mi = engine->getDefaultMaterial()->createInstance();
+    auto mesh = MeshReader::loadMeshFromBuffer(engine, stream.str().data(), nullptr, nullptr, mi);
+    auto& rm = engine->getRenderableManager();
+    auto inst = rm.getInstance(mesh.renderable);
+    EXPECT_EQ(rm.getPrimitiveCount(inst), 1);
+    EXPECT_EQ(rm.getAxisAlignedBoundingBox(inst).center, bounds.center);
+    EXPECT_EQ(rm.getAxisAlignedBoundingBox(inst).halfExtent, bounds.halfExtent);
+
+    // The positions are mapped back to model space with the header's bounds.
+    EXPECT_EQ(rm.getPositionQuantization(inst).center, bounds.center);
+    EXPECT_EQ(rm.getPositionQuantization(inst).halfExtent, bounds.halfExtent);
+
+    // Cleanup.
+    engine->destroy(mesh.renderable);
+    engine->destroy(mi);
+}
+
+TEST_F(FilameshTest, Clusters) {
+    // Serialize a mesh made of the same triangle three times, one triangle per cluster.
+    static const uint16_t clusterIndices[] = { 0, 1, 2, 0, 1, 2, 0, 1, 2 };
+    const Part part { .offset = 0, .indexCount = 9, .minIndex = 0, .maxIndex = 2, .aabb = unitBox };
+    const Header header {
+        .version = VERSION,
+        .parts = 1,
+        .aabb = unitBox,
+        .flags = INTERLEAVED | TEXCOORD_SNORM16 | CLUSTERS,
+        .offsetPosition = offsetof(InterleavedVertex, position),
+        .stridePosition = sizeof(InterleavedVertex),
+        .offsetTangents = offsetof(InterleavedVertex, tangent),
+        .strideTangents = sizeof(InterleavedVertex),
+        .offsetColor = offsetof(InterleavedVertex, color),
+        .strideColor = sizeof(InterleavedVertex),
+        .offsetUV0 = offsetof(InterleavedVertex, uv0),
+        .strideUV0 = sizeof(InterleavedVertex),
+        .offsetUV1 = maxint,
+        .strideUV1 = maxint,
+        .vertexCount = vertexCount,
+        .vertexSize = sizeof(interleavedVertices),
+        .indexType = IndexType::UI16,
+        .indexCount = 9,
+        .indexSize = sizeof(clusterIndices)
+    };
+    const uint32_t nmats = 1;
+    const string matname = "DefaultMaterial";
+    const uint32_t matnamelength = matname.size();
+
+    // The middle cluster is behind the camera, the last one faces away from it.
+    const uint32_t nclusters = 3;
+    const Cluster clusters[] = {
+        { 0, 0, 3, float3(0, 0, -5), 1, float3(0, 0, -5), float3(0, 0, 1), 0.5f },
+        { 0, 3, 3, float3(0, 0, 5), 1, float3(0, 0, 5), float3(0, 0, -1), 0.5f },
+        { 0, 6, 3, float3(0, 0, -5), 1, float3(0, 0, -5), float3(0, 0, -1), 0.5f },
+    };
+
+    stringstream stream(ios_base::out);
+    write(stream, MAGICID, sizeof(MAGICID));
+    write(stream, &header, sizeof(header));
+    write(stream, interleavedVertices, sizeof(interleavedVertices));
+    write(stream, clusterIndices, sizeof(clusterIndices));
+    write(stream, &part, sizeof(part));
+    write(stream, &nmats, sizeof(nmats));
+    write(stream, &matnamelength, sizeof(matnamelength));
+    write(stream, matname.c_str(), matnamelength + 1);
+    write(stream, &nclusters, sizeof(nclusters));
+    write(stream, clusters, sizeof(clusters));
+
+    MaterialInstance* mi = engine->getDefaultMaterial()->createInstance();
+    auto mesh = MeshReader::loadMeshFromBuffer(engine, stream.str().data(), nullptr, nullptr, mi);
+    ASSERT_NE(mesh.clusters, nullptr);
+    EXPECT_EQ(mesh.clusters->getClusterCount(), 3);
+
+    // Each cluster gets its own primitive, as it's below the budget of the part.
+    auto& rm = engine->getRenderableManager();
+    auto inst = rm.getInstance(mesh.renderable);
+    EXPECT_EQ(rm.getPrimitiveCount(inst), 3);
+
+    // The camera is at the origin, looking down -z.
+    Camera* camera = engine->createCamera();
+    camera->setProjection(45, 1, 0.1, 100);
+    EXPECT_EQ(mesh.clusters->cull(*engine, *camera, mat4f()), 1);
+
+    // Cluster renderables don't cast shadows, and shadow casters aren't culled.
+    EXPECT_FALSE(rm.isShadowCaster(inst));
+    rm.setCastShadows(inst, true);
+    EXPECT_EQ(mesh.clusters->cull(*engine, *camera, mat4f()), 3);
+
+    // Cleanup.
+    delete mesh.clusters;
+    engine->destroy(mesh.renderable);
+    engine->destroy(mi);
+    engine->destroy(camera);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
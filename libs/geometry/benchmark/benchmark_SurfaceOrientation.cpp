@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <geometry/SurfaceOrientation.h>
+
+#include <math/norm.h>
+#include <math/vec2.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace filament::geometry;
+using namespace filament::math;
+
+// A wavy grid of size x size vertices, i.e. about 2 million triangles at the default size.
+struct Grid {
+    explicit Grid(uint32_t size) {
+        positions.resize(size * size);
+        normals.resize(size * size);
+        uvs.resize(size * size);
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                const float u = float(x) / float(size - 1);
+                const float v = float(y) / float(size - 1);
+                const uint32_t i = y * size + x;
+                positions[i] = { u, v, 0.1f * std::sin(u * 20.0f) };
+                normals[i] = normalize(float3{ -2.0f * std::cos(u * 20.0f), 0.0f, 1.0f });
+                uvs[i] = { u, v };
+            }
+        }
+        triangles.reserve((size - 1) * (size - 1) * 2);
+        for (uint32_t y = 0; y < size - 1; y++) {
+            for (uint32_t x = 0; x < size - 1; x++) {
+                const uint32_t i = y * size + x;
+                triangles.push_back({ i, i + 1, i + size });
+                triangles.push_back({ i + 1, i + size + 1, i + size });
+            }
+        }
+    }
+
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> uvs;
+    std::vector<uint3> triangles;
+};
+
+static void BM_SurfaceOrientation_uvs(benchmark::State& state) {
+    const Grid grid(uint32_t(state.range(0)));
+    const size_t vertexCount = grid.positions.size();
+    std::vector<short4> quats(vertexCount);
+    for (auto _ : state) {
+        SurfaceOrientation helper = SurfaceOrientation::Builder()
+                .vertexCount(vertexCount)
+                .normals(grid.normals.data())
+                .uvs(grid.uvs.data())
+                .positions(grid.positions.data())
+                .triangleCount(grid.triangles.size())
+                .triangles(grid.triangles.data())
+                .build();
+        helper.getQuats(quats.data(), vertexCount);
+        benchmark::DoNotOptimize(quats.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(grid.triangles.size()));
+}
+
+static void BM_SurfaceOrientation_normals(benchmark::State& state) {
+    const Grid grid(uint32_t(state.range(0)));
+    const size_t vertexCount = grid.positions.size();
+    std::vector<short4> quats(vertexCount);
+    for (auto _ : state) {
+        SurfaceOrientation helper = SurfaceOrientation::Builder()
+                .vertexCount(vertexCount)
+                .normals(grid.normals.data())
+                .build();
+        helper.getQuats(quats.data(), vertexCount);
+        benchmark::DoNotOptimize(quats.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(vertexCount));
+}
+
+BENCHMARK(BM_SurfaceOrientation_uvs)->Arg(64)->Arg(1024)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SurfaceOrientation_normals)->Arg(1024)->Unit(benchmark::kMillisecond);
@@ -16,11 +16,13 @@
 
 #include <geometry/SurfaceOrientation.h>
 
+#include <utils/compiler.h>
 #include <utils/Panic.h>
 
 #include <math/mat3.h>
 #include <math/norm.h>
 
+#include <algorithm>
 #include <vector>
 
 namespace filament {
@@ -185,6 +187,95 @@ SurfaceOrientation OrientationBuilderImpl::buildWithSuppliedTangents() {
     return SurfaceOrientation(new OrientationImpl( { std::move(quats) } ));
 }
 
+// Sum of the tangent directions of the triangles sharing a vertex. Both directions are kept
+// together, so that accumulating a triangle corner touches a single cache line.
+struct TangentSums {
+    float3 sdir;
+    float3 tdir;
+};
+
+// Number of triangles whose tangents are computed at once in accumulateTangents().
+static constexpr size_t TANGENT_BLOCK_SIZE = 64;
+
+// Accumulates the tangent directions of each triangle into its vertices.
+//
+// Triangles are processed in blocks: their edges are first gathered into a structure of arrays,
+// the directions are then computed with a branch-free loop that the compiler vectorizes, and
+// finally scattered to the vertices. Degenerate UVs are the only case needing a branch, they're
+// rare and handled during the scatter.
+template<typename INDEX>
+static void accumulateTangents(TangentSums* UTILS_RESTRICT sums,
+        const INDEX* UTILS_RESTRICT triangles, size_t triangleCount,
+        const float3* UTILS_RESTRICT positions, const float2* UTILS_RESTRICT uvs,
+        const float3* UTILS_RESTRICT normals) noexcept {
+    constexpr size_t N = TANGENT_BLOCK_SIZE;
+    struct {
+        float x1[N], x2[N], y1[N], y2[N], z1[N], z2[N];
+        float s1[N], s2[N], t1[N], t2[N];
+        float r[N];
+        float sx[N], sy[N], sz[N];
+        float tx[N], ty[N], tz[N];
+    } block; // NOLINT -- it's initialized below
+
+    for (size_t first = 0; first < triangleCount; first += N) {
+        const INDEX* tris = triangles + first;
+        const size_t count = std::min(N, triangleCount - first);
+
+        for (size_t i = 0; i < count; i++) {
+            const float3 v1 = positions[tris[i].x];
+            const float3 v2 = positions[tris[i].y];
+            const float3 v3 = positions[tris[i].z];
+            const float2 w1 = uvs[tris[i].x];
+            const float2 w2 = uvs[tris[i].y];
+            const float2 w3 = uvs[tris[i].z];
+            block.x1[i] = v2.x - v1.x;
+            block.x2[i] = v3.x - v1.x;
+            block.y1[i] = v2.y - v1.y;
+            block.y2[i] = v3.y - v1.y;
+            block.z1[i] = v2.z - v1.z;
+            block.z2[i] = v3.z - v1.z;
+            block.s1[i] = w2.x - w1.x;
+            block.s2[i] = w3.x - w1.x;
+            block.t1[i] = w2.y - w1.y;
+            block.t2[i] = w3.y - w1.y;
+        }
+
+        #pragma clang loop vectorize(enable)
+        for (size_t i = 0; i < count; i++) {
+            const float s1 = block.s1[i], s2 = block.s2[i];
+            const float t1 = block.t1[i], t2 = block.t2[i];
+            const float d = s1 * t2 - s2 * t1;
+            const float r = d != 0.0f ? 1.0f / d : 0.0f;
+            block.r[i] = r;
+            block.sx[i] = (t2 * block.x1[i] - t1 * block.x2[i]) * r;
+            block.sy[i] = (t2 * block.y1[i] - t1 * block.y2[i]) * r;
+            block.sz[i] = (t2 * block.z1[i] - t1 * block.z2[i]) * r;
+            block.tx[i] = (s1 * block.x2[i] - s2 * block.x1[i]) * r;
+            block.ty[i] = (s1 * block.y2[i] - s2 * block.y1[i]) * r;
+            block.tz[i] = (s1 * block.z2[i] - s2 * block.z1[i]) * r;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const uint3 tri = uint3(tris[i]);
+            float3 sdir = { block.sx[i], block.sy[i], block.sz[i] };
+            float3 tdir = { block.tx[i], block.ty[i], block.tz[i] };
+            // In general we can't guarantee smooth tangents when the UV's are non-smooth, but
+            // let's at least avoid divide-by-zero and fall back to normals-only method.
+            if (UTILS_UNLIKELY(block.r[i] == 0.0f)) {
+                const float3& n1 = normals[tri.x];
+                sdir = randomPerp(n1);
+                tdir = cross(n1, sdir);
+            }
+            sums[tri.x].sdir += sdir;
+            sums[tri.x].tdir += tdir;
+            sums[tri.y].sdir += sdir;
+            sums[tri.y].tdir += tdir;
+            sums[tri.z].sdir += sdir;
+            sums[tri.z].tdir += tdir;
+        }
+    }
+}
+
 // This method is based on:
 //
 // Computing Tangent Space Basis Vectors for an Arbitrary Mesh (Lengyel’s Method)
@@ -198,56 +289,18 @@ SurfaceOrientation OrientationBuilderImpl::buildWithUvs() {
     ASSERT_PRECONDITION(this->tangentStride == 0, "Non-zero tangent stride not yet supported.");
     ASSERT_PRECONDITION(this->uvStride == 0, "Non-zero uv stride not yet supported.");
     ASSERT_PRECONDITION(this->positionStride == 0, "Non-zero positions stride not yet supported.");
-    vector<float3> tan1(vertexCount);
-    vector<float3> tan2(vertexCount);
-    memset(tan1.data(), 0, sizeof(float3) * vertexCount);
-    memset(tan2.data(), 0, sizeof(float3) * vertexCount);
-    for (size_t a = 0; a < triangleCount; ++a) {
-        uint3 tri = triangles16 ? uint3(triangles16[a]) : triangles32[a];
-        const float3& v1 = positions[tri.x];
-        const float3& v2 = positions[tri.y];
-        const float3& v3 = positions[tri.z];
-        const float2& w1 = uvs[tri.x];
-        const float2& w2 = uvs[tri.y];
-        const float2& w3 = uvs[tri.z];
-        float x1 = v2.x - v1.x;
-        float x2 = v3.x - v1.x;
-        float y1 = v2.y - v1.y;
-        float y2 = v3.y - v1.y;
-        float z1 = v2.z - v1.z;
-        float z2 = v3.z - v1.z;
-        float s1 = w2.x - w1.x;
-        float s2 = w3.x - w1.x;
-        float t1 = w2.y - w1.y;
-        float t2 = w3.y - w1.y;
-        float d = s1 * t2 - s2 * t1;
-        float3 sdir, tdir;
-        // In general we can't guarantee smooth tangents when the UV's are non-smooth, but let's at
-        // least avoid divide-by-zero and fall back to normals-only method.
-        if (d == 0.0) {
-            const float3& n1 = normals[tri.x];
-            sdir = randomPerp(n1);
-            tdir = cross(n1, sdir);
-        } else {
-            sdir = {t2 * x1 - t1 * x2, t2 * y1 - t1 * y2, t2 * z1 - t1 * z2};
-            tdir = {s1 * x2 - s2 * x1, s1 * y2 - s2 * y1, s1 * z2 - s2 * z1};
-            float r = 1.0f / d;
-            sdir *= r;
-            tdir *= r;
-        }
-        tan1[tri.x] += sdir;
-        tan1[tri.y] += sdir;
-        tan1[tri.z] += sdir;
-        tan2[tri.x] += tdir;
-        tan2[tri.y] += tdir;
-        tan2[tri.z] += tdir;
+    vector<TangentSums> sums(vertexCount);
+    if (triangles16) {
+        accumulateTangents(sums.data(), triangles16, triangleCount, positions, uvs, normals);
+    } else {
+        accumulateTangents(sums.data(), triangles32, triangleCount, positions, uvs, normals);
     }
 
     vector<quatf> quats(vertexCount);
     for (size_t a = 0; a < vertexCount; a++) {
         const float3& n = normals[a];
-        const float3& t1 = tan1[a];
-        const float3& t2 = tan2[a];
+        const float3& t1 = sums[a].sdir;
+        const float3& t2 = sums[a].tdir;
 
         // Gram-Schmidt orthogonalize
         float3 t = normalize(t1 - n * dot(n, t1));
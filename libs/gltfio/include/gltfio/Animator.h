@@ -21,7 +21,10 @@
 
 namespace gltfio {
 
-namespace details { struct FFilamentAsset; }
+namespace details {
+struct FFilamentAsset;
+struct FFilamentInstance;
+}
 
 struct AnimatorImpl;
 
@@ -71,9 +74,10 @@ private:
 
     /*! \cond PRIVATE */
     friend struct details::FFilamentAsset;
+    friend struct details::FFilamentInstance;
     /*! \endcond */
 
-    Animator(FilamentAsset* asset);
+    Animator(details::FFilamentAsset* asset, details::FFilamentInstance* instance);
     ~Animator();
     AnimatorImpl* mImpl;
 };
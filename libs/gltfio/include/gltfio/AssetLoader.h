@@ -21,6 +21,7 @@
 #include <filament/Material.h>
 
 #include <gltfio/FilamentAsset.h>
+#include <gltfio/FilamentInstance.h>
 #include <gltfio/MaterialProvider.h>
 
 namespace utils {
@@ -146,6 +147,37 @@ public:
      */
     FilamentAsset* createAssetFromBinary(const uint8_t* bytes, uint32_t nbytes);
 
+    /**
+     * Loads a GLB glTF 2.0 file from the given path and returns a bundle of Filament objects.
+     * Returns null on failure.
+     *
+     * Unlike createAssetFromBinary(), the file is memory-mapped rather than copied, and the
+     * vertex and index data is uploaded straight from the mapping, which is released after the
+     * uploads have completed. This keeps the peak memory usage of large assets close to the size
+     * of the file. Platforms that can't map files fall back to reading it.
+     */
+    FilamentAsset* createAssetFromBinaryFile(const char* path);
+
+    /**
+     * Consumes the contents of a GLB file and produces a primary asset with one or more instances.
+     *
+     * The instances share the vertex buffers, index buffers, material instances and textures of the
+     * asset, which are created and loaded only once. Each instance has its own entities, transforms,
+     * skins and animator, and its root is parented to the root of the asset. All the entities of
+     * the instances are also listed by FilamentAsset::getEntities().
+     *
+     * The resources of the asset are loaded with ResourceLoader as usual, and the instances are
+     * destroyed together with the asset.
+     *
+     * @param bytes the contents of a GLB file
+     * @param nbytes the size of the GLB file
+     * @param instances destination pointer, to be populated with numInstances instances
+     * @param numInstances the number of instances to create, must be at least 1
+     * @return the primary asset, or null on failure
+     */
+    FilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t nbytes,
+            FilamentInstance** instances, size_t numInstances);
+
     /**
      * Takes a pointer to an opaque pipeline object and returns a bundle of Filament objects.
      *
@@ -126,7 +126,8 @@ public:
      * Reclaims CPU-side memory for URI strings, binding lists, and raw animation data.
      *
      * This should only be called after ResourceLoader::loadResources().
-     * If using Animator, this should be called after getAnimator().
+     * If using Animator, this should be called after getAnimator(), on the asset and on each
+     * animated FilamentInstance.
      */
     void releaseSourceData() noexcept;
 
@@ -22,6 +22,7 @@
 #include <filament/MaterialInstance.h>
 
 #include <array>
+#include <vector>
 
 namespace gltfio {
 
@@ -136,6 +137,35 @@ public:
     virtual void destroyMaterials() = 0;
 };
 
+/**
+ * \class MaterialCache MaterialProvider.h gltfio/MaterialProvider.h
+ * \brief Interface to a persistent store of compiled material packages.
+ *
+ * MaterialGenerator looks up every material it needs in the cache before building it, and stores
+ * the materials it had to build, so that generating shaders can be skipped entirely on warm
+ * starts.
+ *
+ * Keys are short printable strings that can be used as file names. They are derived from the
+ * MaterialKey, the uv mapping, the target backend and the material format version, so a package
+ * is never reused by an incompatible engine. Implementations may be called from any thread that
+ * loads assets, but never concurrently by the same MaterialGenerator.
+ */
+class MaterialCache {
+public:
+    virtual ~MaterialCache() {}
+
+    /**
+     * Fetches the package stored under the given key.
+     * Returns false if there is none, in which case package is left untouched.
+     */
+    virtual bool load(const char* key, std::vector<uint8_t>* package) = 0;
+
+    /**
+     * Stores a package under the given key, replacing any previous package.
+     */
+    virtual void store(const char* key, const uint8_t* package, size_t size) = 0;
+};
+
 namespace details {
     void constrainMaterial(MaterialKey* key, UvMap* uvmap);
     void processShaderString(std::string* shader, const UvMap& uvmap,
@@ -146,8 +176,21 @@ namespace details {
  * Creates a material provider that builds materials on the fly, composing GLSL at run time.
  *
  * Requires \c libfilamat to be linked in. Not available in \c libgltfio_core.
+ *
+ * @param engine Used to create the materials
+ * @param cache Optional persistent cache of compiled materials, which must outlive the provider.
+ *              The provider does not take ownership of it.
+ */
+MaterialProvider* createMaterialGenerator(filament::Engine* engine,
+        MaterialCache* cache = nullptr);
+
+/**
+ * Creates a MaterialCache that stores each package in its own file in the given directory, which
+ * is created if needed. Packages are written atomically, so several processes can share a cache.
+ *
+ * Not available in \c libgltfio_core. The caller owns the returned cache and must delete it.
  */
-MaterialProvider* createMaterialGenerator(filament::Engine* engine);
+MaterialCache* createFileMaterialCache(const char* directory);
 
 /**
  * Creates a material provider that loads a small set of pre-built materials.
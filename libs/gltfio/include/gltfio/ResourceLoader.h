@@ -52,6 +52,10 @@ struct ResourceConfiguration {
     //! If true, computes the bounding boxes of all \c POSITION attibutes. Well formed glTF files
     //! do not need this, but it is useful for robustness.
     bool recomputeBoundingBoxes;
+
+    //! Maximum number of texture bytes uploaded by each call to ResourceLoader::asyncUpdateLoad().
+    //! At least one texture is uploaded per call, so that loading always makes progress.
+    size_t asyncUploadBudget = 16u * 1024u * 1024u;
 };
 
 /**
@@ -69,7 +73,10 @@ struct ResourceConfiguration {
  * because it listens to filament::backend::BufferDescriptor callbacks in order to determine when to
  * free CPU-side data blobs.
  *
- * \todo The GPU upload is asynchronous but the load-from-disk and image decode is not.
+ * loadResources() waits for all images to be decoded. To keep rendering while images are decoded
+ * and uploaded, use asyncBeginLoad() and asyncUpdateLoad() instead.
+ *
+ * \todo Loading buffers from disk is not asynchronous.
  */
 class ResourceLoader {
 public:
@@ -88,6 +95,40 @@ public:
      */
     bool loadResources(FilamentAsset* asset);
 
+    /**
+     * Starts an asynchronous resource load.
+     *
+     * This does the same work as loadResources(), except that it returns without waiting for
+     * image decoding, which continues on the JobSystem. The decoded textures are uploaded to the
+     * GPU by subsequent calls to asyncUpdateLoad(), at most ResourceConfiguration::asyncUploadBudget
+     * bytes at a time, so they pop in progressively. Vertex and index buffers don't need
+     * decoding and are passed to the engine immediately, without copies.
+     *
+     * Only one asset can be loaded asynchronously at a time. Returns false if the resources have
+     * already been loaded, if another asynchronous load is in progress, or if one or more
+     * resources could not be loaded.
+     */
+    bool asyncBeginLoad(FilamentAsset* asset);
+
+    /**
+     * Uploads the textures that have been decoded since the last call, within the upload
+     * budget. This should be called once per frame, on the thread that calls
+     * filament::Renderer::render(), until asyncGetLoadProgress() returns 1.
+     */
+    void asyncUpdateLoad();
+
+    /**
+     * Returns the fraction of textures that have been uploaded, between 0 and 1. This returns 1
+     * when no asynchronous load is in progress.
+     */
+    float asyncGetLoadProgress() const;
+
+    /**
+     * Cancels the asynchronous load in progress, if any. This waits for the decoding jobs that are
+     * already running. Textures that have not been uploaded are left uninitialized.
+     */
+    void asyncCancelLoad();
+
     /**
      * Adds raw resource data into a cache for platforms that do not have filesystem or network
      * access.
@@ -95,7 +136,7 @@ public:
     void addResourceData(std::string url, BufferDescriptor&& buffer);
 
 private:
-    bool createTextures(details::FFilamentAsset* asset) const;
+    bool createTextures(details::FFilamentAsset* asset);
     void applySparseData(details::FFilamentAsset* asset) const;
     void computeTangents(details::FFilamentAsset* asset) const;
     void normalizeSkinningWeights(details::FFilamentAsset* asset) const;
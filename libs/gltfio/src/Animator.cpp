@@ -70,6 +70,7 @@ struct AnimatorImpl {
     vector<Animation> animations;
     vector<mat4f> boneMatrices;
     FFilamentAsset* asset;
+    FFilamentInstance* instance;    // null unless the asset is instanced
     RenderableManager* renderableManager;
     TransformManager* transformManager;
 };
@@ -137,9 +138,11 @@ static void setTransformType(const cgltf_animation_channel& src, Channel& dst) {
     }
 }
 
-Animator::Animator(FilamentAsset* publicAsset) {
+Animator::Animator(FFilamentAsset* asset, FFilamentInstance* instance) {
     mImpl = new AnimatorImpl();
-    FFilamentAsset* asset = mImpl->asset = upcast(publicAsset);
+    mImpl->asset = asset;
+    mImpl->instance = instance;
+    NodeMap& nodeMap = instance ? instance->nodeMap : asset->mNodeMap;
     mImpl->renderableManager = &asset->mEngine->getRenderableManager();
     mImpl->transformManager = &asset->mEngine->getTransformManager();
 
@@ -173,7 +176,7 @@ Animator::Animator(FilamentAsset* publicAsset) {
         dstAnim.channels.resize(srcAnim.channels_count);
         for (cgltf_size j = 0, nchans = srcAnim.channels_count; j < nchans; ++j) {
             const cgltf_animation_channel& srcChannel = srcChannels[j];
-            utils::Entity targetEntity = asset->mNodeMap[srcChannel.target_node];
+            utils::Entity targetEntity = nodeMap[srcChannel.target_node];
             Channel& dstChannel = dstAnim.channels[j];
             dstChannel.sourceData = &dstAnim.samplers[srcChannel.sampler - srcSamplers];
             dstChannel.targetEntity = targetEntity;
@@ -322,10 +325,10 @@ void Animator::applyAnimation(size_t animationIndex, float time) const {
 
 void Animator::updateBoneMatrices() {
     vector<mat4f>& boneMatrices = mImpl->boneMatrices;
-    FFilamentAsset* asset = mImpl->asset;
+    const auto& skins = mImpl->instance ? mImpl->instance->skins : mImpl->asset->mSkins;
     auto renderableManager = mImpl->renderableManager;
     auto transformManager = mImpl->transformManager;
-    for (const auto& skin : asset->mSkins) {
+    for (const auto& skin : skins) {
         size_t njoints = skin.joints.size();
         boneMatrices.resize(njoints);
         for (const auto& entity : skin.targets) {
@@ -43,6 +43,17 @@
 
 #include <vector>
 
+#if defined(WIN32) || defined(__EMSCRIPTEN__)
+#include <fstream>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #define CGLTF_IMPLEMENTATION
 #include <cgltf.h>
 
@@ -109,6 +120,9 @@ struct FAssetLoader : public AssetLoader {
 
     FFilamentAsset* createAssetFromJson(const uint8_t* bytes, uint32_t nbytes);
     FilamentAsset* createAssetFromBinary(const uint8_t* bytes, uint32_t nbytes);
+    FilamentAsset* createAssetFromBinaryFile(const char* path);
+    FilamentAsset* createInstancedAsset(const uint8_t* bytes, uint32_t nbytes,
+            FilamentInstance** instances, size_t numInstances);
 
     ~FAssetLoader() {
         delete mMaterials;
@@ -126,8 +140,9 @@ struct FAssetLoader : public AssetLoader {
         return mMaterials->getMaterials();
     }
 
-    void createAsset(const cgltf_data* srcAsset);
+    void createAsset(const cgltf_data* srcAsset, size_t numInstances = 0);
     void createEntity(const cgltf_node* node, Entity parent);
+    void createSkins(const cgltf_data* srcAsset, std::vector<Skin>& skins, const NodeMap& nodeMap);
     void createRenderable(const cgltf_node* node, Entity entity);
     bool createPrimitive(const cgltf_primitive* inPrim, Primitive* outPrim, const UvMap& uvmap,
             const char* name);
@@ -135,7 +150,7 @@ struct FAssetLoader : public AssetLoader {
             bool vertexColor);
     void addTextureBinding(MaterialInstance* materialInstance, const char* parameterName,
             const cgltf_texture* srcTexture, bool srgb);
-    void importSkinningData(Skin& dstSkin, const cgltf_skin& srcSkin);
+    void importSkinningData(Skin& dstSkin, const cgltf_skin& srcSkin, const NodeMap& nodeMap);
     bool primitiveHasVertexColor(const cgltf_primitive* inPrim) const;
 
     EntityManager& mEntityManager;
@@ -147,6 +162,7 @@ struct FAssetLoader : public AssetLoader {
 
     // The loader owns a few transient mappings used only for the current asset being loaded.
     FFilamentAsset* mResult;
+    FFilamentInstance* mInstance = nullptr; // the instance being created, if any
     MatInstanceCache mMatInstanceCache;
     MeshCache mMeshCache;
     bool mError = false;
@@ -172,6 +188,11 @@ FFilamentAsset* FAssetLoader::createAssetFromJson(const uint8_t* bytes, uint32_t
 }
 
 FilamentAsset* FAssetLoader::createAssetFromBinary(const uint8_t* bytes, uint32_t nbytes) {
+    return createInstancedAsset(bytes, nbytes, nullptr, 0);
+}
+
+FilamentAsset* FAssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t nbytes,
+        FilamentInstance** instances, size_t numInstances) {
 
     // The cgltf library handles GLB efficiently by pointing all buffer views into the source data.
     // However, we wish our API to be simple and safe, allowing clients to free up their source blob
@@ -189,14 +210,86 @@ FilamentAsset* FAssetLoader::createAssetFromBinary(const uint8_t* bytes, uint32_
         slog.e << "Unable to parse glb file." << io::endl;
         return nullptr;
     }
+    createAsset(sourceAsset, numInstances);
+    if (mResult) {
+        glbdata.swap(mResult->mGlbData);
+        std::copy(mResult->mInstances.begin(), mResult->mInstances.end(), instances);
+    }
+    return mResult;
+}
+
+FilamentAsset* FAssetLoader::createAssetFromBinaryFile(const char* path) {
+#if defined(WIN32) || defined(__EMSCRIPTEN__)
+    std::ifstream in(path, std::ifstream::binary | std::ifstream::ate);
+    if (!in) {
+        slog.e << "Unable to open " << path << io::endl;
+        return nullptr;
+    }
+    std::vector<uint8_t> glbdata(size_t(in.tellg()));
+    in.seekg(0);
+    if (!in.read((char*) glbdata.data(), glbdata.size())) {
+        slog.e << "Unable to read " << path << io::endl;
+        return nullptr;
+    }
+
+    cgltf_options options { cgltf_file_type_glb };
+    cgltf_data* sourceAsset;
+    cgltf_result result = cgltf_parse(&options, glbdata.data(), glbdata.size(), &sourceAsset);
+    if (result != cgltf_result_success) {
+        slog.e << "Unable to parse glb file." << io::endl;
+        return nullptr;
+    }
     createAsset(sourceAsset);
     if (mResult) {
         glbdata.swap(mResult->mGlbData);
     }
     return mResult;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        slog.e << "Unable to open " << path << ": " << strerror(errno) << io::endl;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        slog.e << "Unable to read " << path << io::endl;
+        close(fd);
+        return nullptr;
+    }
+
+    // The mapping is private and writable because the ResourceLoader can modify the buffers in
+    // place (e.g. to normalize skinning weights), only the modified pages are copied.
+    const size_t size = size_t(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        slog.e << "Unable to map " << path << ": " << strerror(errno) << io::endl;
+        return nullptr;
+    }
+
+    // The buffer views of cgltf point into the mapping, and the ResourceLoader hands them to
+    // the vertex and index buffers directly. The mapping is released with the source asset,
+    // which happens only after all the uploads have completed.
+    backend::BufferDescriptor mapping(data, size, [](void* buffer, size_t size, void*) {
+        munmap(buffer, size);
+    });
+
+    cgltf_options options { cgltf_file_type_glb };
+    cgltf_data* sourceAsset;
+    cgltf_result result = cgltf_parse(&options, data, size, &sourceAsset);
+    if (result != cgltf_result_success) {
+        slog.e << "Unable to parse glb file." << io::endl;
+        return nullptr;
+    }
+    createAsset(sourceAsset);
+    if (mResult) {
+        mResult->mGlbMapping = std::move(mapping);
+    }
+    return mResult;
+#endif
 }
 
-void FAssetLoader::createAsset(const cgltf_data* srcAsset) {
+void FAssetLoader::createAsset(const cgltf_data* srcAsset, size_t numInstances) {
     for (cgltf_size i = 0; i < srcAsset->extensions_required_count; i++) {
         if (!strcmp(srcAsset->extensions_required[i], "KHR_draco_mesh_compression")) {
             slog.e << "KHR_draco_mesh_compression is not supported." << io::endl;
@@ -221,32 +314,34 @@ void FAssetLoader::createAsset(const cgltf_data* srcAsset) {
     mTransformManager.create(mResult->mRoot);
 
     // One scene may have multiple root nodes. Recurse down and create an entity for each node.
+    // Instances repeat this under their own root, the mesh and material caches ensure that they
+    // share all of their buffers and material instances.
     cgltf_node** nodes = scene->nodes;
-    for (cgltf_size i = 0, len = scene->nodes_count; i < len; ++i) {
-        const cgltf_node* root = nodes[i];
-        createEntity(root, mResult->mRoot);
+    if (numInstances == 0) {
+        for (cgltf_size i = 0, len = scene->nodes_count; i < len; ++i) {
+            createEntity(nodes[i], mResult->mRoot);
+        }
+        createSkins(srcAsset, mResult->mSkins, mResult->mNodeMap);
     }
+    for (size_t instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex) {
+        mInstance = new FFilamentInstance(mResult);
+        mInstance->root = mEntityManager.create();
+        mTransformManager.create(mInstance->root, mTransformManager.getInstance(mResult->mRoot));
+        mResult->mInstances.push_back(mInstance);
+        for (cgltf_size i = 0, len = scene->nodes_count; i < len; ++i) {
+            createEntity(nodes[i], mInstance->root);
+        }
+        createSkins(srcAsset, mInstance->skins, mInstance->nodeMap);
+    }
+    mInstance = nullptr;
 
     if (mError) {
         delete mResult;
         mResult = nullptr;
-    }
-
-    // Copy over joint lists (references to TransformManager components) and create buffer bindings
-    // for inverseBindMatrices.
-    mResult->mSkins.resize(srcAsset->skins_count);
-    for (cgltf_size i = 0, len = srcAsset->skins_count; i < len; ++i) {
-        importSkinningData(mResult->mSkins[i], srcAsset->skins[i]);
-    }
-
-    // For each skin, build a list of renderables that it affects.
-    for (cgltf_size i = 0, len = srcAsset->nodes_count; i < len; ++i) {
-        const cgltf_node& node = srcAsset->nodes[i];
-        if (node.skin) {
-            int skinIndex = node.skin - &srcAsset->skins[0];
-            Entity entity = mResult->mNodeMap[&node];
-            mResult->mSkins[skinIndex].targets.push_back(entity);
-        }
+        mMatInstanceCache.clear();
+        mMeshCache.clear();
+        mError = false;
+        return;
     }
 
     // Find every unique resource URI and store a pointer to any of the cgltf-owned cstrings
@@ -293,7 +388,12 @@ void FAssetLoader::createEntity(const cgltf_node* node, Entity parent) {
 
     // Update the asset's entity list and private node mapping.
     mResult->mEntities.push_back(entity);
-    mResult->mNodeMap[node] = entity;
+    if (mInstance) {
+        mInstance->entities.push_back(entity);
+        mInstance->nodeMap[node] = entity;
+    } else {
+        mResult->mNodeMap[node] = entity;
+    }
 
     // If the node has a mesh, then create a renderable component.
     if (node->mesh) {
@@ -965,12 +1065,32 @@ void FAssetLoader::addTextureBinding(MaterialInstance* materialInstance, const c
     });
 }
 
-void FAssetLoader::importSkinningData(Skin& dstSkin, const cgltf_skin& srcSkin) {
+void FAssetLoader::createSkins(const cgltf_data* srcAsset, std::vector<Skin>& skins,
+        const NodeMap& nodeMap) {
+    // Copy over joint lists (references to TransformManager components) and create buffer bindings
+    // for inverseBindMatrices.
+    skins.resize(srcAsset->skins_count);
+    for (cgltf_size i = 0, len = srcAsset->skins_count; i < len; ++i) {
+        importSkinningData(skins[i], srcAsset->skins[i], nodeMap);
+    }
+
+    // For each skin, build a list of renderables that it affects.
+    for (cgltf_size i = 0, len = srcAsset->nodes_count; i < len; ++i) {
+        const cgltf_node& node = srcAsset->nodes[i];
+        auto iter = nodeMap.find(&node);
+        if (node.skin && iter != nodeMap.end()) {
+            int skinIndex = node.skin - &srcAsset->skins[0];
+            skins[skinIndex].targets.push_back(iter->second);
+        }
+    }
+}
+
+void FAssetLoader::importSkinningData(Skin& dstSkin, const cgltf_skin& srcSkin,
+        const NodeMap& nodeMap) {
     if (srcSkin.name) {
         dstSkin.name = srcSkin.name;
     }
     dstSkin.joints.resize(srcSkin.joints_count);
-    const auto& nodeMap = mResult->mNodeMap;
     for (cgltf_size i = 0, len = srcSkin.joints_count; i < len; ++i) {
         dstSkin.joints[i] = nodeMap.at(srcSkin.joints[i]);
     }
@@ -1003,6 +1123,19 @@ FilamentAsset* AssetLoader::createAssetFromBinary(uint8_t const* bytes, uint32_t
     return upcast(this)->createAssetFromBinary(bytes, nbytes);
 }
 
+FilamentAsset* AssetLoader::createAssetFromBinaryFile(const char* path) {
+    return upcast(this)->createAssetFromBinaryFile(path);
+}
+
+FilamentAsset* AssetLoader::createInstancedAsset(const uint8_t* bytes, uint32_t nbytes,
+        FilamentInstance** instances, size_t numInstances) {
+    if (numInstances == 0 || instances == nullptr) {
+        slog.e << "At least one instance is required." << io::endl;
+        return nullptr;
+    }
+    return upcast(this)->createInstancedAsset(bytes, nbytes, instances, numInstances);
+}
+
 FilamentAsset* AssetLoader::createAssetFromHandle(const void* handle) {
     const cgltf_data* sourceAsset = (const cgltf_data*) handle;
     upcast(this)->createAsset(sourceAsset);
@@ -29,6 +29,8 @@
 #include <filament/TransformManager.h>
 #include <filament/VertexBuffer.h>
 
+#include <backend/BufferDescriptor.h>
+
 #include <math/mat4.h>
 
 #include <utils/Entity.h>
@@ -36,6 +38,7 @@
 
 #include <cgltf.h>
 
+#include "FFilamentInstance.h"
 #include "upcast.h"
 #include "Wireframe.h"
 
@@ -48,13 +51,6 @@
 namespace gltfio {
 namespace details {
 
-struct Skin {
-    std::string name;
-    std::vector<filament::math::mat4f> inverseBindMatrices;
-    std::vector<utils::Entity> joints;
-    std::vector<utils::Entity> targets;
-};
-
 struct FFilamentAsset : public FilamentAsset {
     FFilamentAsset(filament::Engine* engine, utils::NameComponentManager* names) :
             mEngine(engine), mNameManager(names) {}
@@ -62,6 +58,10 @@ struct FFilamentAsset : public FilamentAsset {
     ~FFilamentAsset() {
         releaseSourceData();
         delete mAnimator;
+        for (auto instance : mInstances) {
+            mEngine->destroy(instance->root);
+            delete instance;
+        }
         delete mWireframe;
         mEngine->destroy(mRoot);
         for (auto entity : mEntities) {
@@ -142,8 +142,12 @@ struct FFilamentAsset : public FilamentAsset {
     }
 
     Animator* getAnimator() noexcept {
+        // the animator of an instanced asset drives its first instance
+        if (!mInstances.empty()) {
+            return mInstances[0]->getAnimator();
+        }
         if (!mAnimator) {
-            mAnimator = new Animator(this);
+            mAnimator = new Animator(this, nullptr);
         }
         return mAnimator;
     }
@@ -168,6 +172,9 @@ struct FFilamentAsset : public FilamentAsset {
         mTextureBindings = {};
         mResourceUris = {};
         mNodeMap = {};
+        for (FFilamentInstance* instance : mInstances) {
+            instance->nodeMap = {};
+        }
         mPrimMap = {};
         mAccessorMap = {};
         releaseSourceAsset();
@@ -189,12 +196,15 @@ struct FFilamentAsset : public FilamentAsset {
                 cgltf_free((cgltf_data*) mSourceAsset);
             }
             mSourceAsset = nullptr;
+            // destroying the descriptor releases the mapping, after cgltf is done with it
+            filament::backend::BufferDescriptor glbMapping(std::move(mGlbMapping));
         }
     }
 
     filament::Engine* mEngine;
     utils::NameComponentManager* mNameManager;
     std::vector<uint8_t> mGlbData;
+    filament::backend::BufferDescriptor mGlbMapping; // alternative to mGlbData for mapped files
     std::vector<utils::Entity> mEntities;
     std::vector<filament::MaterialInstance*> mMaterialInstances;
     std::vector<filament::VertexBuffer*> mVertexBuffers;
@@ -203,6 +213,7 @@ struct FFilamentAsset : public FilamentAsset {
     filament::Aabb mBoundingBox;
     utils::Entity mRoot;
     std::vector<Skin> mSkins;
+    std::vector<FFilamentInstance*> mInstances; // empty unless created by createInstancedAsset
     Animator* mAnimator = nullptr;
     Wireframe* mWireframe = nullptr;
     int mSourceAssetRefCount = 0;
@@ -214,7 +225,7 @@ struct FFilamentAsset : public FilamentAsset {
     std::vector<TextureBinding> mTextureBindings;
     std::vector<const char*> mResourceUris;
     const cgltf_data* mSourceAsset = nullptr;
-    tsl::robin_map<const cgltf_node*, utils::Entity> mNodeMap;
+    NodeMap mNodeMap; // empty for instanced assets, each instance has its own
     tsl::robin_map<const cgltf_primitive*, filament::VertexBuffer*> mPrimMap;
     tsl::robin_map<const cgltf_accessor*, std::vector<filament::VertexBuffer*>> mAccessorMap;
 };
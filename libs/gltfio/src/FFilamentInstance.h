@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GLTFIO_FFILAMENTINSTANCE_H
+#define GLTFIO_FFILAMENTINSTANCE_H
+
+#include <gltfio/FilamentInstance.h>
+#include <gltfio/Animator.h>
+
+#include <math/mat4.h>
+
+#include <utils/Entity.h>
+
+#include <cgltf.h>
+
+#include "upcast.h"
+
+#include <tsl/robin_map.h>
+
+#include <string>
+#include <vector>
+
+namespace gltfio {
+namespace details {
+
+struct FFilamentAsset;
+
+using NodeMap = tsl::robin_map<const cgltf_node*, utils::Entity>;
+
+struct Skin {
+    std::string name;
+    std::vector<filament::math::mat4f> inverseBindMatrices;
+    std::vector<utils::Entity> joints;
+    std::vector<utils::Entity> targets;
+};
+
+// An instance owns its entities, which the asset destroys, and its animator.
+struct FFilamentInstance : public FilamentInstance {
+    FFilamentInstance(FFilamentAsset* owner) : owner(owner) {}
+
+    ~FFilamentInstance() {
+        delete animator;
+    }
+
+    Animator* getAnimator() noexcept {
+        if (!animator) {
+            animator = new Animator(owner, this);
+        }
+        return animator;
+    }
+
+    std::vector<utils::Entity> entities;
+    utils::Entity root;
+    Animator* animator = nullptr;
+    FFilamentAsset* owner;
+    std::vector<Skin> skins;
+    NodeMap nodeMap;
+};
+
+FILAMENT_UPCAST(FilamentInstance)
+
+} // namespace details
+} // namespace gltfio
+
+#endif // GLTFIO_FFILAMENTINSTANCE_H
@@ -18,13 +18,29 @@
 
 #include <filamat/MaterialBuilder.h>
 
+#include <filaflat/ChunkContainer.h>
+#include <filaflat/Unflattener.h>
+
+#include <filament/MaterialChunkType.h>
+#include <filament/MaterialEnums.h>
+
 #include <utils/Log.h>
 #include <utils/Hash.h>
+#include <utils/Path.h>
 
 #include <tsl/robin_map.h>
 
+#include <fstream>
 #include <string>
 
+#include <stdio.h>
+
+#if defined(WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 using namespace filamat;
 using namespace filament;
 using namespace gltfio;
@@ -32,9 +48,13 @@ using namespace utils;
 
 namespace {
 
+// Identifies the materials built by this file in persistent caches. Bump it whenever the generated
+// shaders or the MaterialBuilder settings change, so that stale cached packages are not loaded.
+constexpr uint32_t GLTFIO_MATERIAL_GENERATOR_VERSION = 1;
+
 class MaterialGenerator : public MaterialProvider {
 public:
-    explicit MaterialGenerator(filament::Engine* engine);
+    MaterialGenerator(filament::Engine* engine, MaterialCache* cache);
     ~MaterialGenerator() override;
 
     MaterialSource getSource() const noexcept override { return GENERATE_SHADERS; }
@@ -50,9 +70,24 @@ public:
     tsl::robin_map<MaterialKey, filament::Material*, HashFn> mCache;
     std::vector<filament::Material*> mMaterials;
     filament::Engine* mEngine;
+    MaterialCache* mPersistentCache;
+};
+
+class FileMaterialCache : public MaterialCache {
+public:
+    explicit FileMaterialCache(const char* directory) : mDirectory(directory) {
+        mDirectory.mkdirRecursive();
+    }
+
+    bool load(const char* key, std::vector<uint8_t>* package) override;
+    void store(const char* key, const uint8_t* package, size_t size) override;
+
+private:
+    utils::Path mDirectory;
 };
 
-MaterialGenerator::MaterialGenerator(Engine* engine) : mEngine(engine) {
+MaterialGenerator::MaterialGenerator(Engine* engine, MaterialCache* cache) :
+        mEngine(engine), mPersistentCache(cache) {
     MaterialBuilder::init();
 }
 
@@ -195,7 +230,40 @@ std::string shaderFromKey(const MaterialKey& config) {
     return shader;
 }
 
-Material* createMaterial(Engine* engine, const MaterialKey& config, const UvMap& uvmap,
+// Builds the key of a material in the persistent cache. The MaterialKey and UvMap bytes are spelled
+// out rather than hashed, so that distinct materials can never collide. The hash of the generated
+// shader and the generator version invalidate the packages built by older versions of gltfio.
+std::string persistentKey(Engine* engine, const MaterialKey& config, const UvMap& uvmap) {
+    static_assert(std::is_trivially_copyable<MaterialKey>::value, "MaterialKey is not POD.");
+    uint8_t bytes[sizeof(MaterialKey) + sizeof(UvMap)];
+    memcpy(bytes, &config, sizeof(MaterialKey));
+    memcpy(bytes + sizeof(MaterialKey), uvmap.data(), sizeof(UvMap));
+
+    char hex[sizeof(bytes) * 2 + 1];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        snprintf(hex + i * 2, 3, "%02x", bytes[i]);
+    }
+
+#ifndef NDEBUG
+    const char* optimization = "debug";
+#else
+    const char* optimization = "release";
+#endif
+
+    std::string shader = shaderFromKey(config);
+    gltfio::details::processShaderString(&shader, uvmap, config);
+    char shaderHash[17];
+    snprintf(shaderHash, sizeof(shaderHash), "%016llx",
+            (unsigned long long) std::hash<std::string>{}(shader));
+
+    return std::string("gltfio-") + hex +
+            "-g" + std::to_string(GLTFIO_MATERIAL_GENERATOR_VERSION) + "-" + shaderHash +
+            "-v" + std::to_string(size_t(MATERIAL_VERSION)) +
+            "-" + std::to_string(int(filamat::targetApiFromBackend(engine->getBackend()))) +
+            "-" + optimization;
+}
+
+Package buildPackage(Engine* engine, const MaterialKey& config, const UvMap& uvmap,
         const char* name) {
     std::string shader = shaderFromKey(config);
     gltfio::details::processShaderString(&shader, uvmap, config);
@@ -305,16 +373,120 @@ Material* createMaterial(Engine* engine, const MaterialKey& config, const UvMap&
         builder.shading(Shading::LIT);
     }
 
-    Package pkg = builder.build();
+    return builder.build();
+}
+
+// Checks that a package read from the persistent cache is a complete material package for this
+// engine, since Material::Builder doesn't tolerate invalid packages.
+bool isValidPackage(Engine* engine, const std::vector<uint8_t>& package) {
+    using filamat::ChunkType;
+    filaflat::ChunkContainer container(package.data(), package.size());
+    if (!container.parse()) {
+        return false;
+    }
+
+    ChunkType materialTag = ChunkType::MaterialGlsl;
+    ChunkType dictionaryTag = ChunkType::DictionaryGlsl;
+    switch (engine->getBackend()) {
+        case Engine::Backend::METAL:
+            materialTag = ChunkType::MaterialMetal;
+            dictionaryTag = ChunkType::DictionaryMetal;
+            break;
+        case Engine::Backend::VULKAN:
+            materialTag = ChunkType::MaterialSpirv;
+            dictionaryTag = ChunkType::DictionarySpirv;
+            break;
+        default:
+            break;
+    }
+    if (!container.hasChunk(materialTag) || !container.hasChunk(dictionaryTag) ||
+            !container.hasChunk(ChunkType::MaterialName) ||
+            !container.hasChunk(ChunkType::MaterialShaderModels) ||
+            !container.hasChunk(ChunkType::MaterialVersion)) {
+        return false;
+    }
+
+    filaflat::Unflattener unflattener(container.getChunkStart(ChunkType::MaterialVersion),
+            container.getChunkEnd(ChunkType::MaterialVersion));
+    uint32_t version = 0;
+    return unflattener.read(&version) && version == MATERIAL_VERSION;
+}
+
+Material* createMaterial(Engine* engine, const MaterialKey& config, const UvMap& uvmap,
+        const char* name, MaterialCache* persistentCache) {
+    if (!persistentCache) {
+        Package pkg = buildPackage(engine, config, uvmap, name);
+        return Material::Builder().package(pkg.getData(), pkg.getSize()).build(*engine);
+    }
+
+    const std::string key = persistentKey(engine, config, uvmap);
+    std::vector<uint8_t> data;
+    if (persistentCache->load(key.c_str(), &data)) {
+        Material* material = isValidPackage(engine, data) ?
+                Material::Builder().package(data.data(), data.size()).build(*engine) : nullptr;
+        if (material) {
+            return material;
+        }
+        slog.w << "Discarding invalid cached material " << key.c_str() << io::endl;
+    }
+
+    Package pkg = buildPackage(engine, config, uvmap, name);
+    if (pkg.isValid()) {
+        persistentCache->store(key.c_str(), pkg.getData(), pkg.getSize());
+    }
     return Material::Builder().package(pkg.getData(), pkg.getSize()).build(*engine);
 }
 
+bool FileMaterialCache::load(const char* key, std::vector<uint8_t>* package) {
+    const utils::Path path = mDirectory + (std::string(key) + ".filamat");
+    std::ifstream in(path.c_str(), std::ifstream::binary | std::ifstream::ate);
+    if (!in) {
+        return false;
+    }
+    std::vector<uint8_t> data(size_t(in.tellg()));
+    in.seekg(0);
+    if (data.empty() || !in.read((char*) data.data(), data.size())) {
+        return false;
+    }
+    package->swap(data);
+    return true;
+}
+
+void FileMaterialCache::store(const char* key, const uint8_t* package, size_t size) {
+    // Write to a file private to this process, then rename it, so that readers never see a
+    // partially written package.
+    const utils::Path path = mDirectory + (std::string(key) + ".filamat");
+#if defined(WIN32)
+    const int pid = _getpid();
+#else
+    const int pid = getpid();
+#endif
+    const std::string temporary = path.getPath() + "." + std::to_string(pid) + ".tmp";
+    {
+        std::ofstream out(temporary.c_str(), std::ofstream::binary | std::ofstream::trunc);
+        if (!out.write((const char*) package, size)) {
+            slog.w << "Unable to write " << temporary.c_str() << io::endl;
+            out.close();
+            remove(temporary.c_str());
+            return;
+        }
+    }
+#if defined(WIN32)
+    // rename() fails on Windows when the target exists, in which case a concurrent reader sees
+    // a cache miss at worst.
+    remove(path.c_str());
+#endif
+    if (rename(temporary.c_str(), path.c_str()) != 0) {
+        remove(temporary.c_str());
+    }
+}
+
 MaterialInstance* MaterialGenerator::createMaterialInstance(MaterialKey* config, UvMap* uvmap,
         const char* label) {
     gltfio::details::constrainMaterial(config, uvmap);
     auto iter = mCache.find(*config);
     if (iter == mCache.end()) {
-        Material* mat = createMaterial(mEngine, *config, *uvmap, label);
+        Material* mat = createMaterial(mEngine, *config, *uvmap, label, mPersistentCache);
         mCache.emplace(std::make_pair(*config, mat));
         mMaterials.push_back(mat);
         return mat->createInstance();
@@ -326,8 +498,12 @@ MaterialInstance* MaterialGenerator::createMaterialInstance(MaterialKey* config,
 
 namespace gltfio {
 
-MaterialProvider* createMaterialGenerator(filament::Engine* engine) {
-    return new MaterialGenerator(engine);
+MaterialProvider* createMaterialGenerator(filament::Engine* engine, MaterialCache* cache) {
+    return new MaterialGenerator(engine, cache);
+}
+
+MaterialCache* createFileMaterialCache(const char* directory) {
+    return new FileMaterialCache(directory);
 }
 
 } // namespace gltfio
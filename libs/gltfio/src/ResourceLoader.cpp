@@ -27,6 +27,8 @@
 
 #include <geometry/SurfaceOrientation.h>
 
+#include <meshoptimizer.h>
+
 #include <math/quat.h>
 #include <math/vec3.h>
 #include <math/vec4.h>
@@ -40,7 +42,12 @@
 
 #include <tsl/robin_map.h>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <string>
+#include <vector>
 
 using namespace filament;
 using namespace filament::math;
@@ -50,10 +57,78 @@ static const auto FREE_CALLBACK = [](void* mem, size_t, void*) { free(mem); };
 
 namespace gltfio {
 
+namespace {
+
+// A texture that is decoded on the JobSystem, then uploaded on the calling thread.
+struct TextureCacheEntry {
+    Texture* texture = nullptr;
+    std::atomic<stbi_uc*> texels = { nullptr };
+    std::atomic<bool> decoded = { false };  // set by the decoder job, even if decoding failed
+    bool completed = false;                 // uploaded or failed, only used by the calling thread
+};
+
+} // anonymous namespace
+
 struct ResourceLoader::Impl {
     tsl::robin_map<std::string, BufferDescriptor> mUserCache;
+
+    // State of the texture load in progress, if any.
+    std::vector<std::unique_ptr<TextureCacheEntry>> mTextures;
+    size_t mCompletedTextures = 0;
+    JobSystem::Job* mDecoderRootJob = nullptr;
+
+    // Uploads decoded textures until at least budget bytes have been uploaded, or all the
+    // decoded textures have been uploaded.
+    void uploadTextures(Engine& engine, size_t budget);
+
+    // Waits for the decoder jobs and forgets about the textures.
+    void finishLoad();
 };
 
+void ResourceLoader::Impl::uploadTextures(Engine& engine, size_t budget) {
+    size_t uploaded = 0;
+    for (auto& entry : mTextures) {
+        if (entry->completed || !entry->decoded.load(std::memory_order_acquire)) {
+            continue;
+        }
+        entry->completed = true;
+        mCompletedTextures++;
+
+        Texture* texture = entry->texture;
+        stbi_uc* texels = entry->texels.exchange(nullptr, std::memory_order_relaxed);
+        if (!texels) {
+            slog.e << "Unable to decode texture." << io::endl;
+            continue;
+        }
+
+        const size_t size = texture->getWidth() * texture->getHeight() * 4;
+        Texture::PixelBufferDescriptor pbd(texels, size,
+                Texture::Format::RGBA,
+                Texture::Type::UBYTE,
+                [] (void* buffer, size_t, void*) { free(buffer); });
+        texture->setImage(engine, 0, std::move(pbd));
+        texture->generateMipmaps(engine);
+
+        uploaded += size;
+        if (uploaded >= budget) {
+            break;
+        }
+    }
+}
+
+void ResourceLoader::Impl::finishLoad() {
+    if (mDecoderRootJob) {
+        JobSystem::getJobSystem()->waitAndRelease(mDecoderRootJob);
+        mDecoderRootJob = nullptr;
+    }
+    // free the texels that were decoded but never uploaded (i.e. when the load is cancelled)
+    for (auto& entry : mTextures) {
+        free(entry->texels.exchange(nullptr, std::memory_order_relaxed));
+    }
+    mTextures.clear();
+    mCompletedTextures = 0;
+}
+
 namespace details {
 
 // The AssetPool tracks references to raw source data (cgltf hierarchies) and frees them
@@ -102,6 +177,7 @@ ResourceLoader::ResourceLoader(const ResourceConfiguration& config) :
         mPool(new AssetPool), mConfig(config), pImpl(new Impl) {}
 
 ResourceLoader::~ResourceLoader() {
+    pImpl->finishLoad();
     mPool->onLoaderDestroyed();
     delete pImpl;
 }
@@ -121,6 +197,103 @@ void ResourceLoader::addResourceData(std::string url, BufferDescriptor&& buffer)
     pImpl->mUserCache.emplace(url, std::move(buffer));
 }
 
+// Returns true if [offset, offset + size) is within a buffer of the given size, without overflowing.
+static bool isWithinBuffer(cgltf_size offset, cgltf_size size, cgltf_size bufferSize) {
+    return size <= bufferSize && offset <= bufferSize - size;
+}
+
+// Validates the untrusted parameters of a compressed buffer view, so that decoding it can neither
+// read nor write out of bounds.
+static bool isValidMeshoptCompression(const cgltf_buffer_view& view) {
+    const cgltf_meshopt_compression& mc = view.meshopt_compression;
+    if (!isWithinBuffer(mc.offset, mc.size, mc.buffer->size) ||
+            !isWithinBuffer(view.offset, view.size, view.buffer->size)) {
+        return false;
+    }
+    if (mc.mode == cgltf_meshopt_compression_mode_attributes) {
+        if (mc.stride == 0 || mc.stride > 256 || mc.stride % 4 != 0) {
+            return false;
+        }
+    } else if ((mc.stride != 2 && mc.stride != 4) || mc.count % 3 != 0) {
+        return false;
+    }
+    return mc.count <= view.size / mc.stride;
+}
+
+// Decodes the buffer views compressed with EXT_meshopt_compression into their uncompressed buffer,
+// when that buffer has no data of its own, i.e. it is a fallback buffer. This way the rest of the
+// loader doesn't need to know about compression. Each buffer view is decoded in its own job.
+static bool decodeMeshoptCompression(cgltf_data* gltf) {
+    std::vector<bool> fallbackBuffers(gltf->buffers_count);
+    for (cgltf_size i = 0; i < gltf->buffer_views_count; ++i) {
+        const cgltf_buffer_view& view = gltf->buffer_views[i];
+        if (view.has_meshopt_compression && !view.buffer->data) {
+            fallbackBuffers[view.buffer - gltf->buffers] = true;
+        }
+    }
+    for (cgltf_size i = 0; i < gltf->buffers_count; ++i) {
+        if (fallbackBuffers[i]) {
+            // this is freed by cgltf_free() along with the other buffers
+            gltf->buffers[i].data = malloc(gltf->buffers[i].size);
+            if (!gltf->buffers[i].data && gltf->buffers[i].size) {
+                slog.e << "Unable to allocate meshopt fallback buffer." << io::endl;
+                return false;
+            }
+        }
+    }
+
+    std::vector<cgltf_buffer_view*> views;
+    for (cgltf_size i = 0; i < gltf->buffer_views_count; ++i) {
+        cgltf_buffer_view& view = gltf->buffer_views[i];
+        if (!view.has_meshopt_compression || !fallbackBuffers[view.buffer - gltf->buffers]) {
+            continue;
+        }
+        const cgltf_meshopt_compression& mc = view.meshopt_compression;
+        if (!mc.buffer->data) {
+            slog.e << "Missing meshopt compressed data." << io::endl;
+            return false;
+        }
+        if (mc.filter != cgltf_meshopt_compression_filter_none ||
+                (mc.mode != cgltf_meshopt_compression_mode_attributes &&
+                 mc.mode != cgltf_meshopt_compression_mode_triangles)) {
+            slog.e << "Unsupported meshopt compression mode or filter." << io::endl;
+            return false;
+        }
+        if (!isValidMeshoptCompression(view)) {
+            slog.e << "Invalid meshopt compressed buffer view." << io::endl;
+            return false;
+        }
+        views.push_back(&view);
+    }
+    if (views.empty()) {
+        return true;
+    }
+
+    JobSystem* js = JobSystem::getJobSystem();
+    JobSystem::Job* parent = js->createJob();
+    std::atomic<bool> success = { true };
+    for (cgltf_buffer_view* view : views) {
+        js->run(jobs::createJob(*js, parent, [view, &success] {
+            const cgltf_meshopt_compression& mc = view->meshopt_compression;
+            auto src = (const uint8_t*) mc.buffer->data + mc.offset;
+            auto dst = (uint8_t*) view->buffer->data + view->offset;
+            int err = mc.mode == cgltf_meshopt_compression_mode_attributes ?
+                    meshopt_decodeVertexBuffer(dst, mc.count, mc.stride, src, mc.size) :
+                    meshopt_decodeIndexBuffer(dst, mc.count, mc.stride, src, mc.size);
+            if (err) {
+                success.store(false, std::memory_order_relaxed);
+            }
+        }));
+    }
+    js->runAndWait(parent);
+
+    if (!success.load(std::memory_order_relaxed)) {
+        slog.e << "Unable to decode meshopt compressed data." << io::endl;
+        return false;
+    }
+    return true;
+}
+
 static void convertBytesToShorts(uint16_t* dst, const uint8_t* src, size_t count) {
     for (size_t i = 0; i < count; ++i) {
         dst[i] = src[i];
@@ -134,10 +307,46 @@ static void generateTrivialIndices(uint32_t* dst, size_t numVertices) {
 }
 
 bool ResourceLoader::loadResources(FilamentAsset* asset) {
+    if (!asyncBeginLoad(asset)) {
+        return false;
+    }
+    if (pImpl->mDecoderRootJob) {
+        JobSystem::getJobSystem()->waitAndRelease(pImpl->mDecoderRootJob);
+        pImpl->uploadTextures(*mConfig.engine, std::numeric_limits<size_t>::max());
+    }
+    pImpl->finishLoad();
+    return true;
+}
+
+void ResourceLoader::asyncUpdateLoad() {
+    if (!pImpl->mDecoderRootJob) {
+        return;
+    }
+    pImpl->uploadTextures(*mConfig.engine, mConfig.asyncUploadBudget);
+    if (pImpl->mCompletedTextures == pImpl->mTextures.size()) {
+        // all the decoder jobs have finished, so this doesn't block
+        pImpl->finishLoad();
+    }
+}
+
+float ResourceLoader::asyncGetLoadProgress() const {
+    const size_t count = pImpl->mTextures.size();
+    return count ? float(pImpl->mCompletedTextures) / float(count) : 1.0f;
+}
+
+void ResourceLoader::asyncCancelLoad() {
+    pImpl->finishLoad();
+}
+
+bool ResourceLoader::asyncBeginLoad(FilamentAsset* asset) {
     FFilamentAsset* fasset = upcast(asset);
     if (fasset->mResourcesLoaded) {
         return false;
     }
+    if (pImpl->mDecoderRootJob) {
+        slog.e << "An asynchronous load is already in progress." << io::endl;
+        return false;
+    }
     fasset->mResourcesLoaded = true;
     mPool->addAsset(fasset);
     auto gltf = (cgltf_data*) fasset->mSourceAsset;
@@ -212,6 +421,10 @@ bool ResourceLoader::loadResources(FilamentAsset* asset) {
 
     #endif
 
+    if (!decodeMeshoptCompression(gltf)) {
+        return false;
+    }
+
     #ifndef NDEBUG
     if (cgltf_validate(gltf) != cgltf_result_success) {
         slog.e << "Failed cgltf validation." << io::endl;
@@ -273,8 +486,14 @@ bool ResourceLoader::loadResources(FilamentAsset* asset) {
     }
 
     // Copy over the inverse bind matrices to allow users to destroy the source asset.
+    // Instanced assets have no skins of their own, only their instances do.
     for (cgltf_size i = 0, len = gltf->skins_count; i < len; ++i) {
-        importSkinningData(fasset->mSkins[i], gltf->skins[i]);
+        if (fasset->mInstances.empty()) {
+            importSkinningData(fasset->mSkins[i], gltf->skins[i]);
+        }
+        for (FFilamentInstance* instance : fasset->mInstances) {
+            importSkinningData(instance->skins[i], gltf->skins[i]);
+        }
     }
 
     // Apply sparse data modifications to base arrays, then upload the result.
@@ -292,8 +511,8 @@ bool ResourceLoader::loadResources(FilamentAsset* asset) {
     return createTextures(fasset);
 }
 
-bool ResourceLoader::createTextures(details::FFilamentAsset* asset) const {
-    // Define a simple functor that creates a Filament Texture.
+bool ResourceLoader::createTextures(details::FFilamentAsset* asset) {
+    // Define a simple functor that creates a Filament Texture for an image decoded by stb.
     // TODO: this could be optimized, e.g. do not generate mips if never mipmap-sampled, and use a
     // more compact format when possible.
     auto createTexture = [this, asset](uint32_t w, uint32_t h, bool srgb) {
@@ -311,119 +530,122 @@ bool ResourceLoader::createTextures(details::FFilamentAsset* asset) const {
     // needless re-decoding with a cache of Filament Texture objects composed of two maps, where
     // the map keys are URL strings or source data pointers.
 
-    struct TextureCacheEntry {
-        Texture* texture;
-        stbi_uc* texels;
-    };
-    tsl::robin_map<const void*, std::unique_ptr<TextureCacheEntry>> bufTextureCache;
-    tsl::robin_map<std::string, std::unique_ptr<TextureCacheEntry>> urlTextureCache;
+    tsl::robin_map<const void*, TextureCacheEntry*> bufTextureCache;
+    tsl::robin_map<std::string, TextureCacheEntry*> urlTextureCache;
 
     // The following loop does a fair bit of synchronous work but it offloads the actual PNG / JPEG
     // decoding into the job system. Synchronously, it invokes stbi_info() over each image, creates
     // Filament Textures, and updates the above caches. Along the way, it kicks off jobs that
-    // perform the decoding.
+    // perform the decoding, the decoded textures are uploaded by uploadTextures().
 
     utils::JobSystem* js = utils::JobSystem::getJobSystem();
     utils::JobSystem::Job* parent = js->createJob();
+    auto& textures = pImpl->mTextures;
+
+    auto createCacheEntry = [&textures]() {
+        textures.push_back(std::make_unique<TextureCacheEntry>());
+        return textures.back().get();
+    };
+
+    // Creates the cache entry and texture of an image in memory and starts decoding it, returns
+    // null if the image header can't be read.
+    auto decodeFromMemory = [&](const uint8_t* sourceData, size_t size, bool srgb)
+            -> TextureCacheEntry* {
+        int width, height, comp;
+        if (!stbi_info_from_memory(sourceData, size, &width, &height, &comp)) {
+            return nullptr;
+        }
+        TextureCacheEntry* cacheEntry = createCacheEntry();
+        cacheEntry->texture = createTexture(width, height, srgb);
+        js->run(utils::jobs::createJob(*js, parent, [=] {
+            int width, height, comp;
+            cacheEntry->texels.store(stbi_load_from_memory(sourceData, size,
+                    &width, &height, &comp, 4), std::memory_order_relaxed);
+            cacheEntry->decoded.store(true, std::memory_order_release);
+        }));
+        return cacheEntry;
+    };
+
+    bool success = true;
 
     for (size_t i = 0, n = asset->getTextureBindingCount(); i < n; ++i) {
         const TextureBinding* texbindings = asset->getTextureBindings();
         auto tb = texbindings[i];
         TextureCacheEntry* cacheEntry = nullptr;
-        int width, height, comp;
 
         // Check if the texture binding uses BufferView data (i.e. it does not have a URL).
         if (tb.data) {
             const uint8_t* sourceData = tb.offset + (const uint8_t*) *tb.data;
-            cacheEntry = bufTextureCache[sourceData] ? bufTextureCache[sourceData].get() : nullptr;
+            cacheEntry = bufTextureCache[sourceData];
             if (cacheEntry) {
                 tb.materialInstance->setParameter(tb.materialParameter, cacheEntry->texture, tb.sampler);
                 continue;
             }
 
-            cacheEntry = (bufTextureCache[sourceData] = std::make_unique<TextureCacheEntry>()).get();
-
-            if (stbi_info_from_memory(sourceData, tb.totalSize, &width, &height, &comp)) {
-                utils::JobSystem::Job* decode = utils::jobs::createJob(*js, parent, [=] {
-                    int width, height, comp;
-                    cacheEntry->texels = stbi_load_from_memory(sourceData, tb.totalSize, &width, &height, &comp, 4);
-                });
-                js->run(decode);
+            cacheEntry = decodeFromMemory(sourceData, tb.totalSize, tb.srgb);
+            if (!cacheEntry) {
+                slog.e << "Unable to read texture header." << io::endl;
+                continue;
             }
 
-            cacheEntry->texture = createTexture(width, height, tb.srgb);
-            cacheEntry->texels = nullptr;
+            bufTextureCache[sourceData] = cacheEntry;
             tb.materialInstance->setParameter(tb.materialParameter, cacheEntry->texture, tb.sampler);
             continue;
         }
 
         // Check if we already created a Texture object for this URL.
-        cacheEntry = urlTextureCache[tb.uri] ? urlTextureCache[tb.uri].get() : nullptr;
+        cacheEntry = urlTextureCache[tb.uri];
         if (cacheEntry) {
             tb.materialInstance->setParameter(tb.materialParameter, cacheEntry->texture, tb.sampler);
             continue;
         }
 
-        cacheEntry = (urlTextureCache[tb.uri] = std::make_unique<TextureCacheEntry>()).get();
-
         // Check the user-supplied resource cache for this URL, otherwise load it from the file system.
         auto iter = pImpl->mUserCache.find(tb.uri);
         if (iter != pImpl->mUserCache.end()) {
             const uint8_t* sourceData = (const uint8_t*) iter->second.buffer;
-            if (stbi_info_from_memory(sourceData, iter->second.size, &width, &height, &comp)) {
-                utils::JobSystem::Job* decode = utils::jobs::createJob(*js, parent, [=] {
-                    int width, height, comp;
-                    cacheEntry->texels = stbi_load_from_memory(sourceData, iter->second.size, &width, &height, &comp, 4);
-                });
-                js->run(decode);
+            const size_t size = iter->second.size;
+            cacheEntry = decodeFromMemory(sourceData, size, tb.srgb);
+            if (!cacheEntry) {
+                slog.e << "Unable to read texture header: " << tb.uri << io::endl;
+                continue;
             }
+            urlTextureCache[tb.uri] = cacheEntry;
         } else {
             #if defined(__EMSCRIPTEN__) || defined(ANDROID)
                 slog.e << "Unable to load texture: " << tb.uri << io::endl;
-                return false;
+                success = false;
+                break;
             #else
                 utils::Path fullpath = this->mConfig.gltfPath.getParent() + tb.uri;
-                if (stbi_info(fullpath.c_str(), &width, &height, &comp)) {
-                    utils::JobSystem::Job* decode = utils::jobs::createJob(*js, parent, [=] {
-                        int width, height, comp;
-                        cacheEntry->texels = stbi_load(fullpath.c_str(), &width, &height, &comp, 4);
-                    });
-                    js->run(decode);
+                int width, height, comp;
+                if (!stbi_info(fullpath.c_str(), &width, &height, &comp)) {
+                    slog.e << "Unable to read texture header: " << tb.uri << io::endl;
+                    continue;
                 }
+                cacheEntry = urlTextureCache[tb.uri] = createCacheEntry();
+                cacheEntry->texture = createTexture(width, height, tb.srgb);
+                js->run(utils::jobs::createJob(*js, parent, [=] {
+                    int width, height, comp;
+                    cacheEntry->texels.store(stbi_load(fullpath.c_str(), &width, &height, &comp, 4),
+                            std::memory_order_relaxed);
+                    cacheEntry->decoded.store(true, std::memory_order_release);
+                }));
             #endif
         }
 
-        cacheEntry->texture = createTexture(width, height, tb.srgb);
         tb.materialInstance->setParameter(tb.materialParameter, cacheEntry->texture, tb.sampler);
     }
 
-    js->runAndWait(parent);
-
-    // Upload all texture data and generate mipmaps.
-
-    auto upload = [](TextureCacheEntry* cacheEntry, Engine& engine) {
-        Texture* texture = cacheEntry->texture;
-        if (texture) {
-            uint8_t* texels = cacheEntry->texels;
-            Texture::PixelBufferDescriptor pbd(texels,
-                    texture->getWidth() * texture->getHeight() * 4,
-                    Texture::Format::RGBA,
-                    Texture::Type::UBYTE,
-                    [] (void* buffer, size_t, void*) { free(buffer); });
-            texture->setImage(engine, 0, std::move(pbd));
-            texture->generateMipmaps(engine);
-            cacheEntry->texture = nullptr;
-        }
-    };
+    pImpl->mDecoderRootJob = js->runAndRetain(parent);
 
-    for (auto& pair : bufTextureCache) {
-        upload(pair.second.get(), *mConfig.engine);
-    }
-    for (auto& pair : urlTextureCache) {
-        upload(pair.second.get(), *mConfig.engine);
+    // If there is nothing to decode (no textures, or none with a readable header), the load is
+    // already complete and asyncGetLoadProgress() returns 1, so clients won't call
+    // asyncUpdateLoad() again. Release the root job now, or the next load would be refused.
+    if (!success || pImpl->mTextures.empty()) {
+        pImpl->finishLoad();
     }
-
-    return true;
+    return success;
 }
 
 void ResourceLoader::applySparseData(FFilamentAsset* asset) const {
@@ -462,17 +684,25 @@ void ResourceLoader::applySparseData(FFilamentAsset* asset) const {
 }
 
 void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
-    // Declare vectors of normals and tangents, which we'll extract & convert from the source.
-    std::vector<float3> fp32Normals;
-    std::vector<float4> fp32Tangents;
-    std::vector<float3> fp32Positions;
-    std::vector<float2> fp32TexCoords;
-    std::vector<uint3> ui32Triangles;
-
     constexpr int kMorphTargetUnused = -1;
 
-    auto computeQuats = [&](const cgltf_primitive& prim, VertexBuffer* vb, uint8_t slot,
-            int morphTargetIndex) {
+    // One task per TANGENT vertex attribute slot. Tasks are computed in
+    // parallel on the JobSystem, the resulting quaternions are uploaded on the calling thread.
+    struct TangentsTask {
+        const cgltf_primitive* prim;
+        VertexBuffer* vb;
+        uint8_t slot;
+        int morphTargetIndex;
+        short4* quats;
+        size_t vertexCount;
+        const char* error;
+    };
+
+    // Computes the surface orientation quaternions of a primitive or morph target. This can be
+    // called from any thread, it only reads the source asset.
+    auto computeQuats = [](TangentsTask* task) {
+        const cgltf_primitive& prim = *task->prim;
+        const int morphTargetIndex = task->morphTargetIndex;
 
         cgltf_size vertexCount = 0;
 
@@ -481,22 +711,17 @@ void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
         const cgltf_accessor* accessors[NUM_ATTRIBUTES] = {};
 
         // Collect accessors for normals, tangents, etc.
-        if (morphTargetIndex == kMorphTargetUnused) {
-            for (cgltf_size aindex = 0; aindex < prim.attributes_count; aindex++) {
-                const cgltf_attribute& attr = prim.attributes[aindex];
-                if (attr.index == 0) {
-                    accessors[attr.type] = attr.data;
-                    vertexCount = attr.data->count;
-                }
-            }
-        } else {
-            const cgltf_morph_target& morphTarget = prim.targets[morphTargetIndex];
-            for (cgltf_size aindex = 0; aindex < morphTarget.attributes_count; aindex++) {
-                const cgltf_attribute& attr = prim.attributes[aindex];
-                if (attr.index == 0) {
-                    accessors[attr.type] = attr.data;
-                    vertexCount = attr.data->count;
-                }
+        const cgltf_attribute* attributes = prim.attributes;
+        cgltf_size attributesCount = prim.attributes_count;
+        if (morphTargetIndex != kMorphTargetUnused) {
+            attributes = prim.targets[morphTargetIndex].attributes;
+            attributesCount = prim.targets[morphTargetIndex].attributes_count;
+        }
+        for (cgltf_size aindex = 0; aindex < attributesCount; aindex++) {
+            const cgltf_attribute& attr = attributes[aindex];
+            if (attr.index == 0) {
+                accessors[attr.type] = attr.data;
+                vertexCount = attr.data->count;
             }
         }
 
@@ -506,7 +731,12 @@ void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
             return;
         }
 
-        short4* quats = (short4*) malloc(sizeof(short4) * vertexCount);
+        // Declare vectors of normals and tangents, which we'll extract & convert from the source.
+        std::vector<float3> fp32Normals;
+        std::vector<float4> fp32Tangents;
+        std::vector<float3> fp32Positions;
+        std::vector<float2> fp32TexCoords;
+        std::vector<uint3> ui32Triangles;
 
         geometry::SurfaceOrientation::Builder sob;
         sob.vertexCount(vertexCount);
@@ -522,7 +752,7 @@ void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
         auto tangentsInfo = accessors[cgltf_attribute_type_tangent];
         if (tangentsInfo) {
             if (tangentsInfo->count != vertexCount || tangentsInfo->type != cgltf_type_vec4) {
-                slog.e << "Bad tangent count or type." << io::endl;
+                task->error = "Bad tangent count or type.";
                 return;
             }
             fp32Tangents.resize(vertexCount);
@@ -533,7 +763,7 @@ void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
         auto positionsInfo = accessors[cgltf_attribute_type_position];
         if (positionsInfo) {
             if (positionsInfo->count != vertexCount || positionsInfo->type != cgltf_type_vec3) {
-                slog.e << "Bad position count or type." << io::endl;
+                task->error = "Bad position count or type.";
                 return;
             }
             fp32Positions.resize(vertexCount);
@@ -567,7 +797,7 @@ void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
         auto texcoordsInfo = accessors[cgltf_attribute_type_texcoord];
         if (texcoordsInfo) {
             if (texcoordsInfo->count != vertexCount || texcoordsInfo->type != cgltf_type_vec2) {
-                slog.e << "Bad texcoord count or type." << io::endl;
+                task->error = "Bad texcoord count or type.";
                 return;
             }
             fp32TexCoords.resize(vertexCount);
@@ -577,11 +807,9 @@ void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
 
         // Compute surface orientation quaternions.
         auto helper = sob.build();
-        helper.getQuats(quats, vertexCount);
-
-        // Upload quaternions to the GPU.
-        VertexBuffer::BufferDescriptor bd(quats, vertexCount * sizeof(short4), FREE_CALLBACK);
-        vb->setBufferAt(*mConfig.engine, slot, std::move(bd));
+        task->quats = (short4*) malloc(sizeof(short4) * vertexCount);
+        task->vertexCount = vertexCount;
+        helper.getQuats(task->quats, vertexCount);
     };
 
     // Collect all TANGENT vertex attribute slots that need to be populated.
@@ -599,27 +827,55 @@ void ResourceLoader::computeTangents(FFilamentAsset* asset) const {
         }
     }
 
-    // Go through all cgltf primitives and populate their tangents if requested.
-    for (auto iter : asset->mNodeMap) {
-        const cgltf_mesh* mesh = iter.first->mesh;
-        if (mesh) {
-            cgltf_size nprims = mesh->primitives_count;
-            for (cgltf_size index = 0; index < nprims; ++index) {
-                VertexBuffer* vb = asset->mPrimMap.at(mesh->primitives + index);
-                auto iter = baseTangents.find(vb);
-                if (iter != baseTangents.end()) {
-                    computeQuats(mesh->primitives[index], vb, iter->second, kMorphTargetUnused);
-                }
-                for (int morphTarget = 0; morphTarget < 4; morphTarget++) {
-                    const auto& tangents = morphTangents[morphTarget];
-                    auto iter = tangents.find(vb);
-                    if (iter != tangents.end()) {
-                        computeQuats(mesh->primitives[index], vb, iter->second, morphTarget);
-                    }
-                }
+    // Go through all cgltf primitives and gather the tangents that were requested. Primitives are
+    // visited once even if their mesh is referenced by several nodes or instances.
+    std::vector<TangentsTask> tasks;
+    for (auto iter : asset->mPrimMap) {
+        const cgltf_primitive* prim = iter.first;
+        VertexBuffer* vb = iter.second;
+        auto baseIter = baseTangents.find(vb);
+        if (baseIter != baseTangents.end()) {
+            tasks.push_back({ prim, vb, baseIter->second, kMorphTargetUnused });
+        }
+        for (int morphTarget = 0; morphTarget < 4; morphTarget++) {
+            const auto& tangents = morphTangents[morphTarget];
+            auto morphIter = tangents.find(vb);
+            if (morphIter != tangents.end()) {
+                tasks.push_back({ prim, vb, morphIter->second, morphTarget });
             }
         }
     }
+    if (tasks.empty()) {
+        return;
+    }
+
+    // The largest primitives are started first, so they don't end up running alone at the end.
+    auto primitiveSize = [](const TangentsTask& task) {
+        return task.prim->indices ? task.prim->indices->count :
+                task.prim->attributes_count ? task.prim->attributes[0].data->count : 0;
+    };
+    std::sort(tasks.begin(), tasks.end(), [&](const TangentsTask& lhs, const TangentsTask& rhs) {
+        return primitiveSize(lhs) > primitiveSize(rhs);
+    });
+
+    JobSystem* js = JobSystem::getJobSystem();
+    JobSystem::Job* parent = js->createJob();
+    for (TangentsTask& task : tasks) {
+        js->run(jobs::createJob(*js, parent, [&task, &computeQuats] { computeQuats(&task); }));
+    }
+    js->runAndWait(parent);
+
+    // Upload quaternions to the GPU.
+    for (const TangentsTask& task : tasks) {
+        if (task.error) {
+            slog.e << task.error << io::endl;
+        }
+        if (task.quats) {
+            VertexBuffer::BufferDescriptor bd(task.quats, task.vertexCount * sizeof(short4),
+                    FREE_CALLBACK);
+            task.vb->setBufferAt(*mConfig.engine, task.slot, std::move(bd));
+        }
+    }
 }
 
 void ResourceLoader::normalizeSkinningWeights(details::FFilamentAsset* asset) const {
@@ -688,17 +944,32 @@ void ResourceLoader::updateBoundingBoxes(details::FFilamentAsset* asset) const {
         return aabb;
     };
 
+    // Instances share meshes, so the bounds of each mesh are computed only once.
+    tsl::robin_map<const cgltf_mesh*, Aabb> meshBounds;
+    auto computeMeshBounds = [&](const cgltf_mesh* mesh) {
+        auto iter = meshBounds.find(mesh);
+        if (iter != meshBounds.end()) {
+            return iter->second;
+        }
+        // Find the object-space bounds for the renderable by unioning the bounds of each prim.
+        Aabb aabb;
+        for (cgltf_size index = 0, nprims = mesh->primitives_count; index < nprims; ++index) {
+            Aabb primBounds = computeBoundingBox(mesh->primitives[index]);
+            aabb.min = min(aabb.min, primBounds.min);
+            aabb.max = max(aabb.max, primBounds.max);
+        }
+        meshBounds[mesh] = aabb;
+        return aabb;
+    };
+
     Aabb assetBounds;
-    for (auto iter : asset->mNodeMap) {
-        const cgltf_mesh* mesh = iter.first->mesh;
-        if (mesh) {
-            // Find the object-space bounds for the renderable by unioning the bounds of each prim.
-            Aabb aabb;
-            for (cgltf_size index = 0, nprims = mesh->primitives_count; index < nprims; ++index) {
-                Aabb primBounds = computeBoundingBox(mesh->primitives[index]);
-                aabb.min = min(aabb.min, primBounds.min);
-                aabb.max = max(aabb.max, primBounds.max);
+    auto updateNodes = [&](const NodeMap& nodeMap) {
+        for (auto iter : nodeMap) {
+            const cgltf_mesh* mesh = iter.first->mesh;
+            if (!mesh) {
+                continue;
             }
+            const Aabb aabb = computeMeshBounds(mesh);
             auto renderable = rm.getInstance(iter.second);
             rm.setAxisAlignedBoundingBox(renderable, Box().set(aabb.min, aabb.max));
 
@@ -709,6 +980,10 @@ void ResourceLoader::updateBoundingBoxes(details::FFilamentAsset* asset) const {
             assetBounds.min = min(assetBounds.min, transformed.min);
             assetBounds.max = max(assetBounds.max, transformed.max);
         }
+    };
+    updateNodes(asset->mNodeMap);
+    for (FFilamentInstance* instance : asset->mInstances) {
+        updateNodes(instance->nodeMap);
     }
 
     for (auto e : modelRoots) {
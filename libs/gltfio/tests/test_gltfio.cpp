@@ -0,0 +1,439 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <filament/Engine.h>
+#include <filament/MaterialInstance.h>
+#include <filament/RenderableManager.h>
+#include <filament/TransformManager.h>
+
+#include <gltfio/AssetLoader.h>
+#include <gltfio/FilamentAsset.h>
+#include <gltfio/FilamentInstance.h>
+#include <gltfio/MaterialProvider.h>
+#include <gltfio/ResourceLoader.h>
+
+#include <math/mat4.h>
+
+#include <utils/Entity.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <string.h>
+
+// gltfio's sources aren't in the include path, since its math.h would shadow the system one.
+#include "../src/FFilamentAsset.h"
+
+using namespace filament;
+using namespace gltfio;
+using namespace gltfio::details;
+using namespace utils;
+
+// A single triangle, with 16-bit indices and the default material.
+static const char* TRIANGLE_JSON = R"({
+    "asset": { "version": "2.0" },
+    "scene": 0,
+    "scenes": [ { "nodes": [ 0 ] } ],
+    "nodes": [ { "mesh": 0 } ],
+    "meshes": [ { "primitives": [ { "attributes": { "POSITION": 0 }, "indices": 1 } ] } ],
+    "buffers": [ { "byteLength": 44 } ],
+    "bufferViews": [
+        { "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+        { "buffer": 0, "byteOffset": 36, "byteLength": 6 }
+    ],
+    "accessors": [
+        { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+          "min": [ 0, 0, 0 ], "max": [ 1, 1, 0 ] },
+        { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" }
+    ]
+})";
+
+// The same triangle, with UVs and three distinct PNG textures stored in buffer views.
+static const char* TEXTURED_TRIANGLE_JSON = R"({
+    "asset": { "version": "2.0" },
+    "scene": 0,
+    "scenes": [ { "nodes": [ 0 ] } ],
+    "nodes": [ { "mesh": 0 } ],
+    "meshes": [ { "primitives": [ {
+        "attributes": { "POSITION": 0, "TEXCOORD_0": 2 }, "indices": 1, "material": 0
+    } ] } ],
+    "materials": [ {
+        "pbrMetallicRoughness": {
+            "baseColorTexture": { "index": 0 },
+            "metallicRoughnessTexture": { "index": 1 }
+        },
+        "emissiveTexture": { "index": 2 }
+    } ],
+    "textures": [ { "source": 0 }, { "source": 1 }, { "source": 2 } ],
+    "images": [
+        { "bufferView": 3, "mimeType": "image/png" },
+        { "bufferView": 4, "mimeType": "image/png" },
+        { "bufferView": 5, "mimeType": "image/png" }
+    ],
+    "buffers": [ { "byteLength": 280 } ],
+    "bufferViews": [
+        { "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+        { "buffer": 0, "byteOffset": 36, "byteLength": 6 },
+        { "buffer": 0, "byteOffset": 44, "byteLength": 24 },
+        { "buffer": 0, "byteOffset": 68, "byteLength": 70 },
+        { "buffer": 0, "byteOffset": 138, "byteLength": 70 },
+        { "buffer": 0, "byteOffset": 208, "byteLength": 70 }
+    ],
+    "accessors": [
+        { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+          "min": [ 0, 0, 0 ], "max": [ 1, 1, 0 ] },
+        { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" },
+        { "bufferView": 2, "componentType": 5126, "count": 3, "type": "VEC2" }
+    ]
+})";
+
+// The same triangle, skinned to a single joint whose inverse bind matrix is a translation.
+static const char* SKINNED_TRIANGLE_JSON = R"({
+    "asset": { "version": "2.0" },
+    "scene": 0,
+    "scenes": [ { "nodes": [ 0, 1 ] } ],
+    "nodes": [ { "mesh": 0, "skin": 0 }, { "translation": [ 0, 1, 0 ] } ],
+    "skins": [ { "joints": [ 1 ], "inverseBindMatrices": 4 } ],
+    "meshes": [ { "primitives": [ {
+        "attributes": { "POSITION": 0, "JOINTS_0": 2, "WEIGHTS_0": 3 }, "indices": 1
+    } ] } ],
+    "buffers": [ { "byteLength": 168 } ],
+    "bufferViews": [
+        { "buffer": 0, "byteOffset": 0, "byteLength": 36 },
+        { "buffer": 0, "byteOffset": 36, "byteLength": 6 },
+        { "buffer": 0, "byteOffset": 44, "byteLength": 12 },
+        { "buffer": 0, "byteOffset": 56, "byteLength": 48 },
+        { "buffer": 0, "byteOffset": 104, "byteLength": 64 }
+    ],
+    "accessors": [
+        { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+          "min": [ 0, 0, 0 ], "max": [ 1, 1, 0 ] },
+        { "bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR" },
+        { "bufferView": 2, "componentType": 5121, "count": 3, "type": "VEC4" },
+        { "bufferView": 3, "componentType": 5126, "count": 3, "type": "VEC4" },
+        { "bufferView": 4, "componentType": 5126, "count": 1, "type": "MAT4" }
+    ]
+})";
+
+// A 1x1 RGBA PNG.
+static const uint8_t PIXEL_PNG[70] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48,
+    0x44, 0x52, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x06, 0x00, 0x00,
+    0x00, 0x1f, 0x15, 0xc4, 0x89, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x44, 0x41, 0x54, 0x78,
+    0x9c, 0x63, 0xf8, 0xdf, 0xe0, 0xf0, 0x1f, 0x00, 0x07, 0x00, 0x02, 0xbf, 0x2b, 0xd7,
+    0xc7, 0xe2, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+};
+
+static const float TRIANGLE_POSITIONS[] = { 0, 0, 0,  1, 0, 0,  0, 1, 0 };
+static const uint16_t TRIANGLE_INDICES[] = { 0, 1, 2 };
+
+static std::vector<uint8_t> createGlb(const char* jsonString, std::vector<uint8_t> bin) {
+    // chunks are 4-bytes aligned, the json chunk is padded with spaces
+    std::string json(jsonString);
+    json.resize((json.size() + 3) & ~size_t(3), ' ');
+    bin.resize((bin.size() + 3) & ~size_t(3), 0);
+
+    std::vector<uint8_t> glb;
+    auto append32 = [&glb](uint32_t value) {
+        glb.insert(glb.end(), (const uint8_t*) &value, (const uint8_t*) &value + 4);
+    };
+    append32(0x46546C67);   // "glTF"
+    append32(2);
+    append32(uint32_t(12 + 8 + json.size() + 8 + bin.size()));
+    append32(uint32_t(json.size()));
+    append32(0x4E4F534A);   // "JSON"
+    glb.insert(glb.end(), json.begin(), json.end());
+    append32(uint32_t(bin.size()));
+    append32(0x004E4942);   // "BIN"
+    glb.insert(glb.end(), bin.begin(), bin.end());
+    return glb;
+}
+
+static std::vector<uint8_t> createTriangleGlb() {
+    std::vector<uint8_t> bin(44, 0);
+    memcpy(bin.data(), TRIANGLE_POSITIONS, sizeof(TRIANGLE_POSITIONS));
+    memcpy(bin.data() + sizeof(TRIANGLE_POSITIONS), TRIANGLE_INDICES, sizeof(TRIANGLE_INDICES));
+    return createGlb(TRIANGLE_JSON, std::move(bin));
+}
+
+static std::vector<uint8_t> createTexturedTriangleGlb() {
+    const float uvs[] = { 0, 0,  1, 0,  0, 1 };
+    std::vector<uint8_t> bin(280, 0);
+    memcpy(bin.data(), TRIANGLE_POSITIONS, sizeof(TRIANGLE_POSITIONS));
+    memcpy(bin.data() + 36, TRIANGLE_INDICES, sizeof(TRIANGLE_INDICES));
+    memcpy(bin.data() + 44, uvs, sizeof(uvs));
+    for (size_t i = 0; i < 3; i++) {
+        memcpy(bin.data() + 68 + i * sizeof(PIXEL_PNG), PIXEL_PNG, sizeof(PIXEL_PNG));
+    }
+    return createGlb(TEXTURED_TRIANGLE_JSON, std::move(bin));
+}
+
+static const math::mat4f JOINT_INVERSE_BIND_MATRIX =
+        math::mat4f::translation(math::float3{ 0, -1, 0 });
+
+static std::vector<uint8_t> createSkinnedTriangleGlb() {
+    const float weights[] = { 1, 0, 0, 0,  1, 0, 0, 0,  1, 0, 0, 0 };
+    std::vector<uint8_t> bin(168, 0);
+    memcpy(bin.data(), TRIANGLE_POSITIONS, sizeof(TRIANGLE_POSITIONS));
+    memcpy(bin.data() + 36, TRIANGLE_INDICES, sizeof(TRIANGLE_INDICES));
+    memcpy(bin.data() + 56, weights, sizeof(weights));
+    memcpy(bin.data() + 104, &JOINT_INVERSE_BIND_MATRIX, sizeof(JOINT_INVERSE_BIND_MATRIX));
+    return createGlb(SKINNED_TRIANGLE_JSON, std::move(bin));
+}
+
+// Calls asyncUpdateLoad() until the load completes, and returns the number of calls it took.
+static size_t finishAsyncLoad(ResourceLoader& resourceLoader) {
+    size_t updateCount = 0;
+    float progress = resourceLoader.asyncGetLoadProgress();
+    while (progress < 1.0f && updateCount < 10000) {
+        // the textures are decoded by the job system, give it some time
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        resourceLoader.asyncUpdateLoad();
+        updateCount++;
+        const float newProgress = resourceLoader.asyncGetLoadProgress();
+        EXPECT_LE(progress, newProgress);
+        progress = newProgress;
+    }
+    return updateCount;
+}
+
+// A cache with a single entry, which is returned for any key.
+class SingleEntryMaterialCache : public MaterialCache {
+public:
+    bool load(const char* key, std::vector<uint8_t>* package) override {
+        if (entry.empty()) {
+            return false;
+        }
+        *package = entry;
+        return true;
+    }
+
+    void store(const char* key, const uint8_t* package, size_t size) override {
+        entry.assign(package, package + size);
+        storeCount++;
+    }
+
+    std::vector<uint8_t> entry;
+    size_t storeCount = 0;
+};
+
+class GltfioTest : public testing::Test {
+protected:
+    void SetUp() override {
+        engine = Engine::create(Engine::Backend::NOOP);
+        materials = createUbershaderLoader(engine);
+        loader = AssetLoader::create({ engine, materials });
+    }
+
+    void TearDown() override {
+        AssetLoader::destroy(&loader);
+        materials->destroyMaterials();
+        delete materials;
+        Engine::destroy(&engine);
+    }
+
+    Engine* engine = nullptr;
+    MaterialProvider* materials = nullptr;
+    AssetLoader* loader = nullptr;
+};
+
+TEST_F(GltfioTest, InstancedAsset) {
+    const std::vector<uint8_t> glb = createTriangleGlb();
+    FilamentInstance* instances[2] = {};
+    FilamentAsset* asset = loader->createInstancedAsset(glb.data(), uint32_t(glb.size()),
+            instances, 2);
+    ASSERT_NE(asset, nullptr);
+    ASSERT_NE(instances[0], nullptr);
+    ASSERT_NE(instances[1], nullptr);
+    ASSERT_NE(instances[0], instances[1]);
+    EXPECT_EQ(instances[0]->getAsset(), asset);
+    EXPECT_EQ(instances[1]->getAsset(), asset);
+
+    // Each instance has its own entities, under its own root, which is parented to the asset root.
+    auto& tcm = engine->getTransformManager();
+    ASSERT_EQ(instances[0]->getEntityCount(), 1);
+    ASSERT_EQ(instances[1]->getEntityCount(), 1);
+    const Entity entities[2] = { instances[0]->getEntities()[0], instances[1]->getEntities()[0] };
+    EXPECT_NE(entities[0], entities[1]);
+    EXPECT_NE(instances[0]->getRoot(), instances[1]->getRoot());
+    for (FilamentInstance* instance : instances) {
+        EXPECT_NE(instance->getRoot(), asset->getRoot());
+        EXPECT_EQ(tcm.getParent(tcm.getInstance(instance->getRoot())), asset->getRoot());
+    }
+
+    // The vertex buffers, index buffers and material instances are created once and shared.
+    auto fasset = upcast(asset);
+    EXPECT_EQ(fasset->mVertexBuffers.size(), 1);
+    EXPECT_EQ(fasset->mIndexBuffers.size(), 1);
+    ASSERT_EQ(asset->getMaterialInstanceCount(), 1);
+    auto& rm = engine->getRenderableManager();
+    for (Entity entity : entities) {
+        auto ri = rm.getInstance(entity);
+        ASSERT_TRUE(ri);
+        EXPECT_EQ(rm.getMaterialInstanceAt(ri, 0), asset->getMaterialInstances()[0]);
+    }
+
+    // Releasing the source data also releases the node maps of the instances.
+    ResourceLoader({ engine, {}, false, false }).loadResources(asset);
+    EXPECT_EQ(upcast(instances[0])->nodeMap.size(), 1);
+    EXPECT_EQ(upcast(instances[1])->nodeMap.size(), 1);
+    asset->releaseSourceData();
+    EXPECT_TRUE(fasset->mNodeMap.empty());
+    EXPECT_TRUE(upcast(instances[0])->nodeMap.empty());
+    EXPECT_TRUE(upcast(instances[1])->nodeMap.empty());
+
+    loader->destroyAsset(asset);
+}
+
+TEST_F(GltfioTest, InstancedSkinnedAsset) {
+    const std::vector<uint8_t> glb = createSkinnedTriangleGlb();
+    FilamentInstance* instances[2] = {};
+    FilamentAsset* asset = loader->createInstancedAsset(glb.data(), uint32_t(glb.size()),
+            instances, 2);
+    ASSERT_NE(asset, nullptr);
+    ASSERT_NE(instances[0], nullptr);
+    ASSERT_NE(instances[1], nullptr);
+
+    // The skins belong to the instances, the asset itself has none.
+    ResourceLoader({ engine, {}, false, false }).loadResources(asset);
+    EXPECT_TRUE(upcast(asset)->mSkins.empty());
+    const Skin& skin0 = upcast(instances[0])->skins.at(0);
+    const Skin& skin1 = upcast(instances[1])->skins.at(0);
+
+    // Each instance binds its own joint and its own mesh, with the same inverse bind matrix.
+    for (FilamentInstance* instance : instances) {
+        const Skin& skin = upcast(instance)->skins.at(0);
+        ASSERT_EQ(instance->getEntityCount(), 2);
+        ASSERT_EQ(skin.joints.size(), 1);
+        ASSERT_EQ(skin.targets.size(), 1);
+        ASSERT_EQ(skin.inverseBindMatrices.size(), 1);
+        const Entity* entities = instance->getEntities();
+        const Entity* end = entities + instance->getEntityCount();
+        EXPECT_NE(std::find(entities, end, skin.joints[0]), end);
+        EXPECT_NE(std::find(entities, end, skin.targets[0]), end);
+        EXPECT_EQ(skin.inverseBindMatrices[0], JOINT_INVERSE_BIND_MATRIX);
+    }
+    EXPECT_NE(skin0.joints[0], skin1.joints[0]);
+    EXPECT_NE(skin0.targets[0], skin1.targets[0]);
+
+    loader->destroyAsset(asset);
+}
+
+TEST_F(GltfioTest, InvalidCachedMaterial) {
+    SingleEntryMaterialCache cache;
+    auto createMaterialInstance = [this, &cache]() {
+        MaterialProvider* generator = createMaterialGenerator(engine, &cache);
+        MaterialKey config = {};
+        UvMap uvmap = {};
+        MaterialInstance* mi = generator->createMaterialInstance(&config, &uvmap, "test");
+        const bool created = mi != nullptr;
+        engine->destroy(mi);
+        generator->destroyMaterials();
+        delete generator;
+        return created;
+    };
+
+    // A garbage entry is rebuilt and replaced.
+    cache.entry.assign(64, 0xAB);
+    EXPECT_TRUE(createMaterialInstance());
+    EXPECT_EQ(cache.storeCount, 1);
+
+    // The valid entry is used as is.
+    EXPECT_TRUE(createMaterialInstance());
+    EXPECT_EQ(cache.storeCount, 1);
+
+    // A truncated entry is rebuilt and replaced.
+    cache.entry.resize(cache.entry.size() / 2);
+    EXPECT_TRUE(createMaterialInstance());
+    EXPECT_EQ(cache.storeCount, 2);
+}
+
+TEST_F(GltfioTest, AsyncLoadWithoutTextures) {
+    const std::vector<uint8_t> glb = createTriangleGlb();
+    FilamentAsset* assets[2] = {
+        loader->createAssetFromBinary(glb.data(), uint32_t(glb.size())),
+        loader->createAssetFromBinary(glb.data(), uint32_t(glb.size()))
+    };
+    ASSERT_NE(assets[0], nullptr);
+    ASSERT_NE(assets[1], nullptr);
+
+    // There is nothing to decode, so the load is complete right away, and the next one can start
+    // without any call to asyncUpdateLoad().
+    ResourceLoader resourceLoader({ engine, {}, false, false });
+    EXPECT_TRUE(resourceLoader.asyncBeginLoad(assets[0]));
+    EXPECT_EQ(1.0f, resourceLoader.asyncGetLoadProgress());
+    EXPECT_TRUE(resourceLoader.asyncBeginLoad(assets[1]));
+    EXPECT_EQ(1.0f, resourceLoader.asyncGetLoadProgress());
+
+    // resources can't be loaded twice
+    EXPECT_FALSE(resourceLoader.asyncBeginLoad(assets[0]));
+
+    loader->destroyAsset(assets[0]);
+    loader->destroyAsset(assets[1]);
+}
+
+TEST_F(GltfioTest, AsyncLoadProgress) {
+    const std::vector<uint8_t> glb = createTexturedTriangleGlb();
+    FilamentAsset* asset = loader->createAssetFromBinary(glb.data(), uint32_t(glb.size()));
+    ASSERT_NE(asset, nullptr);
+    ASSERT_EQ(asset->getTextureBindingCount(), 3);
+
+    // A budget of one byte uploads a single texture per update.
+    ResourceLoader resourceLoader({ engine, {}, false, false, 1 });
+    EXPECT_TRUE(resourceLoader.asyncBeginLoad(asset));
+    EXPECT_EQ(0.0f, resourceLoader.asyncGetLoadProgress());
+    EXPECT_LE(3, finishAsyncLoad(resourceLoader));
+    EXPECT_EQ(1.0f, resourceLoader.asyncGetLoadProgress());
+    EXPECT_EQ(upcast(asset)->mTextures.size(), 3);
+
+    loader->destroyAsset(asset);
+}
+
+TEST_F(GltfioTest, AsyncLoadCancel) {
+    const std::vector<uint8_t> glb = createTexturedTriangleGlb();
+    FilamentAsset* assets[2] = {
+        loader->createAssetFromBinary(glb.data(), uint32_t(glb.size())),
+        loader->createAssetFromBinary(glb.data(), uint32_t(glb.size()))
+    };
+    ASSERT_NE(assets[0], nullptr);
+    ASSERT_NE(assets[1], nullptr);
+
+    // A second load is refused while the first one is in progress.
+    ResourceLoader resourceLoader({ engine, {}, false, false, 1 });
+    EXPECT_TRUE(resourceLoader.asyncBeginLoad(assets[0]));
+    EXPECT_FALSE(resourceLoader.asyncBeginLoad(assets[1]));
+
+    // Once cancelled mid-load, nothing is in progress anymore and the second load can start.
+    resourceLoader.asyncUpdateLoad();
+    resourceLoader.asyncCancelLoad();
+    EXPECT_EQ(1.0f, resourceLoader.asyncGetLoadProgress());
+    EXPECT_TRUE(resourceLoader.asyncBeginLoad(assets[1]));
+    finishAsyncLoad(resourceLoader);
+    EXPECT_EQ(1.0f, resourceLoader.asyncGetLoadProgress());
+
+    loader->destroyAsset(assets[0]);
+    loader->destroyAsset(assets[1]);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
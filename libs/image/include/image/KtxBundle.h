@@ -78,6 +78,21 @@ public:
      */
     KtxBundle(uint8_t const* bytes, uint32_t nbytes);
 
+    /**
+     * Creates a bundle that references the blobs of the given serialized data instead of copying
+     * them, e.g. to consume a memory-mapped KTX file. Only the header and the metadata are copied.
+     *
+     * The data must outlive the bundle and must not be modified while it is referenced. The first
+     * call to setBlob() or allocateBlob() copies every blob into the bundle, after which the data
+     * is no longer referenced.
+     */
+    static KtxBundle* createView(uint8_t const* bytes, uint32_t nbytes);
+
+    /**
+     * Returns true if the blobs of this bundle are referenced rather than owned.
+     */
+    bool isView() const;
+
     /**
      * Serializes the bundle into the given target memory. Returns false if there's not enough
      * memory.
@@ -264,6 +279,8 @@ public:
     static constexpr uint32_t SRGB8_ALPHA8_ETC2_EAC = 0x9279;
 
 private:
+    void deserialize(uint8_t const* bytes, uint32_t nbytes, bool copyBlobs);
+
     image::KtxInfo mInfo = {};
     uint32_t mNumMipLevels;
     uint32_t mArrayLength;
@@ -22,6 +22,10 @@
 
 #include <image/KtxBundle.h>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
 namespace image {
 
 /**
@@ -50,22 +54,18 @@ namespace ktx {
     TextureFormat toTextureFormat(const KtxInfo& info);
 
     /**
-     * Creates a Texture object from a KTX file and populates all of its faces and miplevels.
+     * Creates an empty Texture object for the miplevels of a KTX bundle, starting at firstLevel.
      *
      * @param engine Used to create the Filament Texture
      * @param ktx In-memory representation of a KTX file
      * @param srgb Forces the KTX-specified format into an SRGB format if possible
-     * @param callback Gets called after all texture data has been uploaded to the GPU
-     * @param userdata Passed into the callback
+     * @param firstLevel The KTX miplevel that becomes the base level of the texture
      */
-    inline Texture* createTexture(Engine* engine, const KtxBundle& ktx, bool srgb,
-            Callback callback, void* userdata) {
+    inline Texture* createTextureObject(Engine* engine, const KtxBundle& ktx, bool srgb,
+            uint32_t firstLevel = 0) {
         using Sampler = Texture::Sampler;
         const auto& ktxinfo = ktx.getInfo();
         const uint32_t nmips = ktx.getNumMipLevels();
-        const auto cdatatype = toCompressedPixelDataType(ktxinfo);
-        const auto datatype = toPixelDataType(ktxinfo);
-        const auto dataformat = toPixelDataFormat(ktxinfo);
 
         auto texformat = toTextureFormat(ktxinfo);
         if (srgb) {
@@ -77,13 +77,68 @@ namespace ktx {
             }
         }
 
-        Texture* texture = Texture::Builder()
-            .width(ktxinfo.pixelWidth)
-            .height(ktxinfo.pixelHeight)
-            .levels(static_cast<uint8_t>(nmips))
+        return Texture::Builder()
+            .width(std::max(ktxinfo.pixelWidth >> firstLevel, 1u))
+            .height(std::max(ktxinfo.pixelHeight >> firstLevel, 1u))
+            .levels(static_cast<uint8_t>(nmips - firstLevel))
             .sampler(ktx.isCubemap() ? Sampler::SAMPLER_CUBEMAP : Sampler::SAMPLER_2D)
             .format(texformat)
             .build(*engine);
+    }
+
+    /**
+     * Uploads one miplevel of a KTX bundle, with all of its cubemap faces, into a level of the
+     * given texture. The bundle's data is not copied, it must stay alive until the callback is
+     * called.
+     */
+    inline void uploadLevel(Engine* engine, Texture* texture, uint32_t textureLevel,
+            const KtxBundle& ktx, uint32_t ktxLevel,
+            PixelBufferDescriptor::Callback cb, void* cbuser) {
+        const auto& ktxinfo = ktx.getInfo();
+        uint8_t* data;
+        uint32_t size;
+        ktx.getBlob({ktxLevel, 0, 0}, &data, &size);
+
+        if (isCompressed(ktxinfo)) {
+            const auto cdatatype = toCompressedPixelDataType(ktxinfo);
+            if (ktx.isCubemap()) {
+                PixelBufferDescriptor pbd(data, size * 6, cdatatype, size, cb, cbuser);
+                texture->setImage(*engine, textureLevel, std::move(pbd),
+                        Texture::FaceOffsets(size));
+                return;
+            }
+            PixelBufferDescriptor pbd(data, size, cdatatype, size, cb, cbuser);
+            texture->setImage(*engine, textureLevel, std::move(pbd));
+            return;
+        }
+
+        const auto datatype = toPixelDataType(ktxinfo);
+        const auto dataformat = toPixelDataFormat(ktxinfo);
+        if (ktx.isCubemap()) {
+            PixelBufferDescriptor pbd(data, size * 6, dataformat, datatype, cb, cbuser);
+            texture->setImage(*engine, textureLevel, std::move(pbd), Texture::FaceOffsets(size));
+            return;
+        }
+        PixelBufferDescriptor pbd(data, size, dataformat, datatype, cb, cbuser);
+        texture->setImage(*engine, textureLevel, std::move(pbd));
+    }
+
+    /**
+     * Creates a Texture object from a KTX file and populates all of its faces and miplevels.
+     *
+     * Miplevels are uploaded from the smallest to the largest. The bundle's data is not copied,
+     * the bundle must stay alive until the callback is called.
+     *
+     * @param engine Used to create the Filament Texture
+     * @param ktx In-memory representation of a KTX file
+     * @param srgb Forces the KTX-specified format into an SRGB format if possible
+     * @param callback Gets called after all texture data has been uploaded to the GPU
+     * @param userdata Passed into the callback
+     */
+    inline Texture* createTexture(Engine* engine, const KtxBundle& ktx, bool srgb,
+            Callback callback, void* userdata) {
+        const uint32_t nmips = ktx.getNumMipLevels();
+        Texture* texture = createTextureObject(engine, ktx, srgb);
 
         struct Userdata {
             uint32_t remainingBuffers;
@@ -103,39 +158,8 @@ namespace ktx {
             }
         };
 
-        uint8_t* data;
-        uint32_t size;
-
-        if (isCompressed(ktxinfo)) {
-            if (ktx.isCubemap()) {
-                for (uint32_t level = 0; level < nmips; ++level) {
-                    ktx.getBlob({level, 0, 0}, &data, &size);
-                    PixelBufferDescriptor pbd(data, size * 6, cdatatype, size, cb, cbuser);
-                    texture->setImage(*engine, level, std::move(pbd), Texture::FaceOffsets(size));
-                }
-                return texture;
-            }
-            for (uint32_t level = 0; level < nmips; ++level) {
-                ktx.getBlob({level, 0, 0}, &data, &size);
-                PixelBufferDescriptor pbd(data, size, cdatatype, size, cb, cbuser);
-                texture->setImage(*engine, level, std::move(pbd));
-            }
-            return texture;
-        }
-
-        if (ktx.isCubemap()) {
-            for (uint32_t level = 0; level < nmips; ++level) {
-                ktx.getBlob({level, 0, 0}, &data, &size);
-                PixelBufferDescriptor pbd(data, size * 6, dataformat, datatype, cb, cbuser);
-                texture->setImage(*engine, level, std::move(pbd), Texture::FaceOffsets(size));
-            }
-            return texture;
-        }
-
-        for (uint32_t level = 0; level < nmips; ++level) {
-            ktx.getBlob({level, 0, 0}, &data, &size);
-            PixelBufferDescriptor pbd(data, size, dataformat, datatype, cb, cbuser);
-            texture->setImage(*engine, level, std::move(pbd));
+        for (uint32_t level = nmips; level-- > 0;) {
+            uploadLevel(engine, texture, level, ktx, level, cb, cbuser);
         }
         return texture;
     }
@@ -156,6 +180,123 @@ namespace ktx {
         return createTexture(engine, *ktx, srgb, freeKtx, ktx);
     }
 
+    /**
+     * Uploads a KTX bundle progressively, so that a low resolution version of a large texture, such
+     * as an IBL cubemap, can be displayed right away.
+     *
+     * A texture can only be sampled once all of its miplevels are uploaded, so the streamer creates
+     * two textures. The preview texture holds the smallest miplevels of the bundle and is uploaded
+     * by the constructor. The full texture is uploaded by calls to upload(), from its smallest
+     * miplevel to its largest, so that the uploads can be spread over several frames. Clients
+     * display the preview until isComplete() returns true, then switch to the full texture.
+     *
+     * The blobs of the bundle are never copied, so a view bundle of a memory-mapped file is uploaded
+     * straight from the mapping. The streamer takes ownership of the bundle and destroys it once it
+     * is no longer referenced by the engine. Clients own both textures.
+     *
+     * Bundles that are no larger than the preview size are uploaded at once by the constructor.
+     * There is no preview texture in that case, and the full texture can be used right away.
+     */
+    class TextureStreamer {
+    public:
+        /**
+         * @param engine Used to create and upload the Filament Textures
+         * @param ktx Bundle to upload, ownership is transferred to the streamer
+         * @param srgb Forces the KTX-specified format into an SRGB format if possible
+         * @param previewSize Maximum width and height of the preview texture
+         */
+        TextureStreamer(Engine* engine, KtxBundle* ktx, bool srgb, uint32_t previewSize = 64)
+                : mEngine(engine), mState(new State{ ktx, {} }) {
+            const KtxInfo& info = ktx->getInfo();
+            const uint32_t nmips = ktx->getNumMipLevels();
+            uint32_t previewLevel = 0;
+            while (previewLevel + 1 < nmips &&
+                    std::max(info.pixelWidth, info.pixelHeight) >> previewLevel > previewSize) {
+                previewLevel++;
+            }
+
+            // One reference for each upload, plus one for the streamer itself.
+            mState->references = 1 + nmips + (previewLevel ? nmips - previewLevel : 0);
+
+            mTexture = createTextureObject(engine, *ktx, srgb);
+            mNextLevel = nmips;
+            if (previewLevel == 0) {
+                // The bundle is small enough to be uploaded at once, it doesn't need a preview.
+                upload(std::numeric_limits<size_t>::max());
+                return;
+            }
+            mPreview = createTextureObject(engine, *ktx, srgb, previewLevel);
+            for (uint32_t level = nmips; level-- > previewLevel;) {
+                uploadLevel(engine, mPreview, level - previewLevel, *ktx, level, release, mState);
+            }
+        }
+
+        ~TextureStreamer() {
+            // Levels that were never uploaded no longer hold a reference.
+            releaseReferences(mState, 1 + mNextLevel);
+        }
+
+        TextureStreamer(TextureStreamer const&) = delete;
+        TextureStreamer& operator=(TextureStreamer const&) = delete;
+
+        /**
+         * Returns the preview texture, which can be used right away, or nullptr if the full
+         * texture was uploaded by the constructor.
+         */
+        Texture* getPreview() const noexcept { return mPreview; }
+
+        /**
+         * Returns the full texture, which can only be used once isComplete() returns true.
+         */
+        Texture* getTexture() const noexcept { return mTexture; }
+
+        /**
+         * Uploads the next miplevels of the full texture, smallest first, until at least maxBytes
+         * have been uploaded or all miplevels are uploaded. Returns isComplete().
+         */
+        bool upload(size_t maxBytes) {
+            KtxBundle const& ktx = *mState->ktx;
+            size_t uploaded = 0;
+            while (mNextLevel > 0 && uploaded < maxBytes) {
+                const uint32_t level = --mNextLevel;
+                uint8_t* data;
+                uint32_t size;
+                ktx.getBlob({level, 0, 0}, &data, &size);
+                uploaded += size_t(size) * (ktx.isCubemap() ? 6 : 1);
+                uploadLevel(mEngine, mTexture, level, ktx, level, release, mState);
+            }
+            return isComplete();
+        }
+
+        /**
+         * Returns true once every miplevel of the full texture has been submitted to the engine.
+         */
+        bool isComplete() const noexcept { return mNextLevel == 0; }
+
+    private:
+        struct State {
+            KtxBundle* ktx;
+            std::atomic<uint32_t> references;
+        };
+
+        static void release(void*, size_t, void* user) {
+            releaseReferences((State*) user, 1);
+        }
+
+        static void releaseReferences(State* state, uint32_t count) {
+            if (state->references.fetch_sub(count, std::memory_order_acq_rel) == count) {
+                delete state->ktx;
+                delete state;
+            }
+        }
+
+        Engine* mEngine;
+        State* mState;
+        Texture* mPreview = nullptr;
+        Texture* mTexture = nullptr;
+        uint32_t mNextLevel = 0;
+    };
+
     template<typename T>
     T toCompressedFilamentEnum(uint32_t format) {
         switch (format) {
@@ -56,12 +56,20 @@ struct KtxMetadata {
 // Extremely simple contiguous storage for an array of blobs. Assumes that the total number of blobs
 // is relatively small compared to the size of each blob, and that resizing individual blobs does
 // not occur frequently.
+//
+// In view mode, the blobs live in external memory and only their addresses are stored.
 struct KtxBlobList {
     std::vector<uint8_t> blobs;
     std::vector<uint32_t> sizes;
+    std::vector<uint8_t const*> views;
+
+    bool isView() const { return !views.empty(); }
 
     // Obtains a pointer to the given blob.
     uint8_t* get(uint32_t blobIndex) {
+        if (isView()) {
+            return const_cast<uint8_t*>(views[blobIndex]);
+        }
         uint8_t* result = blobs.data();
         for (uint32_t i = 0; i < blobIndex; ++i) {
             result += sizes[i];
@@ -94,6 +102,24 @@ struct KtxBlobList {
         sizes[blobIndex] = newSize;
         blobs.swap(newBlobs);
     }
+
+    // Copies the referenced blobs into contiguous storage, and stops referencing them.
+    void materialize() {
+        if (!isView()) {
+            return;
+        }
+        size_t totalSize = 0;
+        for (uint32_t size : sizes) {
+            totalSize += size;
+        }
+        blobs.resize(totalSize);
+        uint8_t* dst = blobs.data();
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            memcpy(dst, views[i], sizes[i]);
+            dst += sizes[i];
+        }
+        views.clear();
+    }
 };
 
 KtxBundle::~KtxBundle() = default;
@@ -108,6 +134,20 @@ KtxBundle::KtxBundle(uint32_t numMipLevels, uint32_t arrayLength, bool isCubemap
 
 KtxBundle::KtxBundle(uint8_t const* bytes, uint32_t nbytes) :
         mBlobs(new KtxBlobList), mMetadata(new KtxMetadata) {
+    deserialize(bytes, nbytes, true);
+}
+
+KtxBundle* KtxBundle::createView(uint8_t const* bytes, uint32_t nbytes) {
+    KtxBundle* bundle = new KtxBundle(0, 0, false);
+    bundle->deserialize(bytes, nbytes, false);
+    return bundle;
+}
+
+bool KtxBundle::isView() const {
+    return mBlobs->isView();
+}
+
+void KtxBundle::deserialize(uint8_t const* bytes, uint32_t nbytes, bool copyBlobs) {
     ASSERT_PRECONDITION(sizeof(SerializationHeader) <= nbytes, "KTX buffer is too small");
 
     // First, "parse" the header by casting it to a struct.
@@ -149,18 +189,31 @@ KtxBundle::KtxBundle(uint8_t const* bytes, uint32_t nbytes) :
     const bool isNonArrayCube = mNumCubeFaces > 1 && mArrayLength == 1;
     const uint32_t facesPerMip = mArrayLength * mNumCubeFaces;
 
-    // Extract blobs from the serialized byte stream.
-    const uint32_t totalSize = nbytes - (pdata - bytes);
-    mBlobs->blobs.resize(totalSize);
+    // Extract blobs from the serialized byte stream, or in view mode, remember where they are.
+    uint8_t const* const bytesEnd = bytes + nbytes;
+    if (copyBlobs) {
+        const uint32_t totalSize = nbytes - (pdata - bytes);
+        mBlobs->blobs.resize(totalSize);
+    } else {
+        mBlobs->views.resize(mBlobs->sizes.size());
+    }
     for (uint32_t mipmap = 0; mipmap < mNumMipLevels; ++mipmap) {
+        ASSERT_PRECONDITION(pdata + sizeof(uint32_t) <= bytesEnd, "KTX buffer is too small");
         const uint32_t imageSize = *((uint32_t const*) pdata);
         const uint32_t faceSize = isNonArrayCube ? imageSize : (imageSize / facesPerMip);
         const uint32_t levelSize = faceSize * mNumCubeFaces * mArrayLength;
         pdata += sizeof(uint32_t);
-        memcpy(mBlobs->get(flatten(this, {mipmap, 0, 0})), pdata, levelSize);
+        ASSERT_PRECONDITION(levelSize <= size_t(bytesEnd - pdata), "KTX buffer is too small");
+        if (copyBlobs) {
+            memcpy(mBlobs->get(flatten(this, {mipmap, 0, 0})), pdata, levelSize);
+        }
         for (uint32_t layer = 0; layer < mArrayLength; ++layer) {
             for (uint32_t face = 0; face < mNumCubeFaces; ++face) {
-                mBlobs->sizes[flatten(this, {mipmap, layer, face})] = faceSize;
+                const uint32_t flatIndex = flatten(this, {mipmap, layer, face});
+                mBlobs->sizes[flatIndex] = faceSize;
+                if (!copyBlobs) {
+                    mBlobs->views[flatIndex] = pdata;
+                }
                 pdata += faceSize;
                 pdata += cubePadding;
             }
@@ -324,6 +377,7 @@ bool KtxBundle::setBlob(KtxBlobIndex index, uint8_t const* data, uint32_t size)
             index.cubeFace >= mNumCubeFaces) {
         return false;
     }
+    mBlobs->materialize();
     uint32_t flatIndex = flatten(this, index);
     uint32_t blobSize = mBlobs->sizes[flatIndex];
     if (blobSize != size) {
@@ -338,6 +392,7 @@ bool KtxBundle::allocateBlob(KtxBlobIndex index, uint32_t size) {
             index.cubeFace >= mNumCubeFaces) {
         return false;
     }
+    mBlobs->materialize();
     uint32_t flatIndex = flatten(this, index);
     mBlobs->resize(flatIndex, size);
     return true;
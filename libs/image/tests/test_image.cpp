@@ -33,6 +33,7 @@
 #include <math/vec4.h>
 
 #include <fstream>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -427,6 +428,49 @@ TEST_F(ImageTest, Ktx) { // NOLINT
     }
 }
 
+TEST_F(ImageTest, KtxView) { // NOLINT
+    uint8_t foo[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t bar[] = {9, 10, 11, 12};
+    KtxBundle nascent(2, 1, true);
+    for (uint32_t face = 0; face < 6; ++face) {
+        ASSERT_TRUE(nascent.setBlob({0, 0, face}, foo, sizeof(foo)));
+        ASSERT_TRUE(nascent.setBlob({1, 0, face}, bar, sizeof(bar)));
+    }
+    nascent.setMetadata("foo", "bar");
+    vector<uint8_t> buffer(nascent.getSerializedLength());
+    ASSERT_TRUE(nascent.serialize(buffer.data(), buffer.size()));
+
+    std::unique_ptr<KtxBundle> view(KtxBundle::createView(buffer.data(), buffer.size()));
+    ASSERT_TRUE(view->isView());
+    ASSERT_EQ(view->getNumMipLevels(), 2);
+    ASSERT_TRUE(view->isCubemap());
+    ASSERT_EQ(string(view->getMetadata("foo")), "bar");
+
+    // Blobs are referenced in place.
+    uint8_t* data;
+    uint32_t size;
+    for (uint32_t face = 0; face < 6; ++face) {
+        ASSERT_TRUE(view->getBlob({1, 0, face}, &data, &size));
+        ASSERT_EQ(size, sizeof(bar));
+        ASSERT_GE(data, buffer.data());
+        ASSERT_LE(data + size, buffer.data() + buffer.size());
+        ASSERT_EQ(memcmp(data, bar, size), 0);
+    }
+
+    vector<uint8_t> reserialized(view->getSerializedLength());
+    ASSERT_TRUE(view->serialize(reserialized.data(), reserialized.size()));
+    ASSERT_EQ(reserialized, buffer);
+
+    // Modifying a view copies its blobs.
+    ASSERT_TRUE(view->setBlob({1, 0, 5}, foo, sizeof(foo)));
+    ASSERT_FALSE(view->isView());
+    ASSERT_TRUE(view->getBlob({0, 0, 2}, &data, &size));
+    ASSERT_TRUE(data < buffer.data() || data >= buffer.data() + buffer.size());
+    ASSERT_EQ(memcmp(data, foo, size), 0);
+    ASSERT_TRUE(view->getBlob({1, 0, 5}, &data, &size));
+    ASSERT_EQ(size, sizeof(foo));
+}
+
 TEST_F(ImageTest, getSphericalHarmonics) {
     KtxBundle ktx(2, 1, true);
 
@@ -184,6 +184,7 @@ const char* toString(backend::SamplerType type) {
         case backend::SamplerType::SAMPLER_2D: return "sampler2D";
         case backend::SamplerType::SAMPLER_CUBEMAP: return "samplerCubemap";
         case backend::SamplerType::SAMPLER_EXTERNAL: return "samplerExternal";
+        case backend::SamplerType::SAMPLER_2D_ARRAY: return "sampler2DArray";
     }
 }
 
@@ -24,7 +24,7 @@
 #define SYSTRACE_TAG_JOBSYSTEM      (1<<2)
 
 
-#if defined(ANDROID)
+#if defined(__linux__)
 
 #include <atomic>
 
@@ -98,6 +98,8 @@
 // No user serviceable code below...
 // ------------------------------------------------------------------------------------------------
 
+#if defined(ANDROID)
+
 namespace utils {
 namespace details {
 
@@ -218,8 +220,15 @@ private:
 } // namespace details
 } // namespace utils
 
-// ------------------------------------------------------------------------------------------------
 #else // !ANDROID
+
+// On Linux, events are recorded in memory and can be dumped in the Chrome trace-event format
+#include <utils/linux/Systrace.h>
+
+#endif // ANDROID
+
+// ------------------------------------------------------------------------------------------------
+#else // !__linux__
 // ------------------------------------------------------------------------------------------------
 
 #define SYSTRACE_ENABLE()
@@ -232,6 +241,6 @@ private:
 #define SYSTRACE_VALUE32(name, val)
 #define SYSTRACE_VALUE64(name, val)
 
-#endif // ANDROID
+#endif // __linux__
 
 #endif // TNT_UTILS_SYSTRACE_H
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UTILS_LINUX_SYSTRACE_H
+#define UTILS_LINUX_SYSTRACE_H
+
+// This file is included by utils/Systrace.h, don't include it directly.
+
+#include <atomic>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <utils/compiler.h>
+
+namespace utils {
+namespace details {
+
+/*
+ * Linux implementation of Systrace.
+ *
+ * There is no system-wide tracing facility we can write to, instead each thread records its
+ * events into its own fixed-size ring buffer, which only that thread writes to, so recording is
+ * lock-free and never allocates (except the first time a thread records an event).
+ * When a ring buffer is full, the oldest events are overwritten.
+ *
+ * Nothing is recorded until startCapture() is called, and the recorded events can be dumped
+ * in the Chrome trace-event JSON format at any time, which can be loaded in chrome://tracing
+ * or in Perfetto.
+ *
+ * If the SYSTRACE_CAPTURE_FILE environment variable is set, the capture starts the first time
+ * tracing is enabled and is dumped to that file when the process exits.
+ */
+class Systrace {
+public:
+
+    enum tags {
+        NEVER       = SYSTRACE_TAG_NEVER,
+        ALWAYS      = SYSTRACE_TAG_ALWAYS,
+        FILAMENT    = SYSTRACE_TAG_FILAMENT,
+        JOBSYSTEM   = SYSTRACE_TAG_JOBSYSTEM
+        // we could define more TAGS here, as we need them.
+    };
+
+    Systrace(uint32_t tag) noexcept {
+        if (tag) init(tag);
+    }
+
+    static void enable(uint32_t tags) noexcept;
+    static void disable(uint32_t tags) noexcept;
+
+    // starts recording the events of the enabled tags, events recorded before are discarded
+    static void startCapture() noexcept;
+
+    // stops recording events, the events recorded so far can still be dumped
+    static void stopCapture() noexcept;
+
+    // writes the events recorded since startCapture() as Chrome trace-event JSON.
+    // This can be called from any thread, while other threads are recording.
+    static bool dump(const char* path) noexcept;
+    static void dump(FILE* file) noexcept;
+
+    inline void asyncBegin(uint32_t tag, const char* name, int32_t cookie) noexcept {
+        if (tag && UTILS_UNLIKELY(mIsTracingEnabled)) {
+            record('b', name, cookie);
+        }
+    }
+
+    inline void asyncEnd(uint32_t tag, const char* name, int32_t cookie) noexcept {
+        if (tag && UTILS_UNLIKELY(mIsTracingEnabled)) {
+            record('e', name, cookie);
+        }
+    }
+
+    inline void value(uint32_t tag, const char* name, int32_t value) noexcept {
+        if (tag && UTILS_UNLIKELY(mIsTracingEnabled)) {
+            record('C', name, value);
+        }
+    }
+
+    inline void value(uint32_t tag, const char* name, int64_t value) noexcept {
+        if (tag && UTILS_UNLIKELY(mIsTracingEnabled)) {
+            record('C', name, value);
+        }
+    }
+
+private:
+    friend class ScopedTrace;
+
+    inline void traceBegin(uint32_t tag, const char* name) noexcept {
+        if (tag && UTILS_UNLIKELY(mIsTracingEnabled)) {
+            record('B', name, 0);
+        }
+    }
+
+    inline void traceEnd(uint32_t tag) noexcept {
+        if (tag && UTILS_UNLIKELY(mIsTracingEnabled)) {
+            record('E', nullptr, 0);
+        }
+    }
+
+    void init(uint32_t tag) noexcept {
+        mIsTracingEnabled = isTracingEnabled(tag);
+    }
+
+    // phase is the Chrome trace-event phase of the event
+    static void record(char phase, const char* name, int64_t value) noexcept;
+
+    static bool isTracingEnabled(uint32_t tag) noexcept;
+
+    static std::atomic<uint32_t> sIsTracingEnabled;
+    static std::atomic_bool sIsCapturing;
+
+    // cached value for faster access, no need to be initialized
+    bool mIsTracingEnabled;
+};
+
+// ------------------------------------------------------------------------------------------------
+
+class ScopedTrace {
+public:
+    // we don't inline this because it's relatively heavy due to a global check
+    ScopedTrace(uint32_t tag, const char* name) noexcept : mTrace(tag), mTag(tag) {
+        mTrace.traceBegin(tag, name);
+    }
+
+    inline ~ScopedTrace() noexcept {
+        mTrace.traceEnd(mTag);
+    }
+
+    inline void value(uint32_t tag, const char* name, int32_t v) noexcept {
+        mTrace.value(tag, name, v);
+    }
+
+    inline void value(uint32_t tag, const char* name, int64_t v) noexcept {
+        mTrace.value(tag, name, v);
+    }
+
+private:
+    Systrace mTrace;
+    const uint32_t mTag;
+};
+
+} // namespace details
+} // namespace utils
+
+#endif // UTILS_LINUX_SYSTRACE_H
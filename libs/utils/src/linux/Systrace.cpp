@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <utils/Systrace.h>
+#include <utils/Log.h>
+
+#if defined(__linux__) && !defined(ANDROID)
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <mutex>
+#include <vector>
+
+#include <string.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace utils {
+namespace details {
+
+namespace {
+
+// number of events each thread keeps, must be a power of two
+constexpr size_t RING_CAPACITY = 8192;
+
+struct Event {                  // 64 bytes
+    int64_t timestamp;          // nanoseconds
+    int64_t value;              // counter value or async cookie
+    char phase;                 // Chrome trace-event phase: B, E, C, b or e
+    char name[47];              // truncated copy of the name, names are not always literals
+};
+static_assert(sizeof(Event) == 64, "Event should be a cache-line");
+
+struct Ring {
+    // index of the next event to write, only written by the owner thread
+    std::atomic<uint64_t> head = { 0 };
+    pid_t tid = 0;
+    char threadName[16] = {};
+    Event events[RING_CAPACITY];
+};
+
+// rings are never destroyed, so they can be dumped after their thread is gone
+std::mutex sRingsLock;
+std::vector<Ring*> sRings;
+
+thread_local Ring* tRing = nullptr;
+
+std::atomic<int64_t> sCaptureStart = { 0 };
+pthread_once_t sCaptureFileOnce = PTHREAD_ONCE_INIT;
+
+int64_t now() noexcept {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+UTILS_NOINLINE
+Ring* registerThread() noexcept {
+    Ring* const ring = new Ring;
+    ring->tid = pid_t(syscall(SYS_gettid));
+    pthread_getname_np(pthread_self(), ring->threadName, sizeof(ring->threadName));
+    std::lock_guard<std::mutex> guard(sRingsLock);
+    sRings.push_back(ring);
+    return ring;
+}
+
+void writeJsonString(FILE* file, const char* s) noexcept {
+    fputc('"', file);
+    for (; *s; s++) {
+        const unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fputc('\\', file);
+            fputc(c, file);
+        } else if (c < 0x20) {
+            fprintf(file, "\\u%04x", c);
+        } else {
+            fputc(c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+void dumpAtExit() noexcept {
+    const char* path = getenv("SYSTRACE_CAPTURE_FILE");
+    if (path && *path) {
+        Systrace::dump(path);
+    }
+}
+
+void startCaptureFromEnvironment() noexcept {
+    const char* path = getenv("SYSTRACE_CAPTURE_FILE");
+    if (path && *path) {
+        Systrace::startCapture();
+        atexit(dumpAtExit);
+    }
+}
+
+} // anonymous namespace
+
+std::atomic<uint32_t> Systrace::sIsTracingEnabled = { 0 };
+std::atomic_bool Systrace::sIsCapturing = { false };
+
+void Systrace::enable(uint32_t tags) noexcept {
+    pthread_once(&sCaptureFileOnce, startCaptureFromEnvironment);
+    sIsTracingEnabled.fetch_or(tags, std::memory_order_relaxed);
+}
+
+void Systrace::disable(uint32_t tags) noexcept {
+    sIsTracingEnabled.fetch_and(~tags, std::memory_order_relaxed);
+}
+
+void Systrace::startCapture() noexcept {
+    sCaptureStart.store(now(), std::memory_order_relaxed);
+    sIsCapturing.store(true, std::memory_order_release);
+}
+
+void Systrace::stopCapture() noexcept {
+    sIsCapturing.store(false, std::memory_order_release);
+}
+
+bool Systrace::isTracingEnabled(uint32_t tag) noexcept {
+    if (tag && UTILS_UNLIKELY(sIsCapturing.load(std::memory_order_relaxed))) {
+        return bool((sIsTracingEnabled.load(std::memory_order_relaxed) | SYSTRACE_TAG_ALWAYS) & tag);
+    }
+    return false;
+}
+
+void Systrace::record(char phase, const char* name, int64_t value) noexcept {
+    Ring* ring = tRing;
+    if (UTILS_UNLIKELY(!ring)) {
+        ring = tRing = registerThread();
+    }
+
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    Event& event = ring->events[head & (RING_CAPACITY - 1)];
+    event.timestamp = now();
+    event.value = value;
+    event.phase = phase;
+    if (name) {
+        strncpy(event.name, name, sizeof(event.name) - 1);
+        event.name[sizeof(event.name) - 1] = 0;
+    } else {
+        event.name[0] = 0;
+    }
+    // publishes the event
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+bool Systrace::dump(const char* path) noexcept {
+    FILE* file = fopen(path, "w");
+    if (UTILS_UNLIKELY(!file)) {
+        slog.e << "Error opening trace file " << path << ": " << strerror(errno) << io::endl;
+        return false;
+    }
+    dump(file);
+    return fclose(file) == 0;
+}
+
+void Systrace::dump(FILE* file) noexcept {
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> guard(sRingsLock);
+        rings = sRings;
+    }
+
+    const int64_t captureStart = sCaptureStart.load(std::memory_order_relaxed);
+    const int pid = getpid();
+    std::vector<Event> events;
+    events.reserve(RING_CAPACITY);
+    bool first = true;
+
+    fprintf(file, "{\"traceEvents\":[");
+    for (Ring const* ring : rings) {
+        // The owner thread may be writing while we copy its events. The events it could have
+        // overwritten during the copy are discarded, by checking the head again afterwards.
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        const uint64_t begin = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+        events.clear();
+        for (uint64_t i = begin; i < head; i++) {
+            events.push_back(ring->events[i & (RING_CAPACITY - 1)]);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t last = ring->head.load(std::memory_order_relaxed);
+        // the event being written when we read the head, overwrites the one at last - capacity
+        const uint64_t firstValid = last + 1 > RING_CAPACITY ? last + 1 - RING_CAPACITY : 0;
+        const size_t skip = size_t(std::min(std::max(firstValid, begin) - begin, head - begin));
+
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                      "\"args\":{\"name\":", first ? "" : ",", pid, ring->tid);
+        writeJsonString(file, ring->threadName);
+        fprintf(file, "}}");
+        first = false;
+
+        for (size_t i = skip, c = events.size(); i < c; i++) {
+            Event const& event = events[i];
+            if (event.timestamp < captureStart) {
+                continue;
+            }
+            // Chrome wants timestamps in microseconds
+            fprintf(file, ",\n{\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRId64 ".%03d",
+                    event.phase, pid, ring->tid,
+                    event.timestamp / 1000, int(event.timestamp % 1000));
+            if (event.phase != 'E') {
+                fprintf(file, ",\"name\":");
+                writeJsonString(file, event.name);
+            }
+            if (event.phase == 'C') {
+                fprintf(file, ",\"args\":{\"value\":%" PRId64 "}", event.value);
+            } else if (event.phase == 'b' || event.phase == 'e') {
+                fprintf(file, ",\"cat\":\"systrace\",\"id\":%" PRId64, event.value);
+            }
+            fprintf(file, "}");
+        }
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fflush(file);
+}
+
+} // namespace details
+} // namespace utils
+
+#endif // __linux__ && !ANDROID
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#define SYSTRACE_TAG SYSTRACE_TAG_ALWAYS
+#include <utils/Systrace.h>
+
+#include <string>
+#include <thread>
+
+#include <stdio.h>
+
+using namespace utils::details;
+
+static size_t count(std::string const& s, std::string const& what) {
+    size_t n = 0;
+    for (size_t pos = s.find(what); pos != std::string::npos; pos = s.find(what, pos + 1)) {
+        n++;
+    }
+    return n;
+}
+
+static std::string dumpToString() {
+    char* data = nullptr;
+    size_t size = 0;
+    FILE* file = open_memstream(&data, &size);
+    Systrace::dump(file);
+    fclose(file);
+    std::string result(data, size);
+    free(data);
+    return result;
+}
+
+TEST(SystraceTest, ChromeTraceJson) {
+    {
+        // nothing is recorded before the capture starts
+        SYSTRACE_NAME("before capture");
+    }
+
+    Systrace::startCapture();
+
+    auto work = []() {
+        for (int i = 0; i < 10; i++) {
+            SYSTRACE_NAME("work \"quoted\"");
+            SYSTRACE_VALUE32("counter", i);
+        }
+    };
+    std::thread thread(work);
+    work();
+    thread.join();
+
+    {
+        SYSTRACE_CONTEXT();
+        SYSTRACE_ASYNC_BEGIN("async", 42);
+        SYSTRACE_ASYNC_END("async", 42);
+    }
+
+    Systrace::stopCapture();
+    {
+        SYSTRACE_NAME("after capture");
+    }
+
+    std::string json = dumpToString();
+    EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+    EXPECT_EQ(0u, count(json, "before capture"));
+    EXPECT_EQ(0u, count(json, "after capture"));
+    EXPECT_EQ(20u, count(json, "\"ph\":\"B\""));
+    EXPECT_EQ(20u, count(json, "\"ph\":\"E\""));
+    EXPECT_EQ(20u, count(json, "\"name\":\"work \\\"quoted\\\"\""));
+    EXPECT_EQ(20u, count(json, "\"ph\":\"C\""));
+    EXPECT_EQ(1u, count(json, "\"ph\":\"b\""));
+    EXPECT_EQ(1u, count(json, "\"ph\":\"e\""));
+    EXPECT_EQ(2u, count(json, "\"id\":42"));
+}
+
+TEST(SystraceTest, RingOverflow) {
+    Systrace::startCapture();
+    for (int i = 0; i < 100000; i++) {
+        SYSTRACE_NAME("overflow");
+    }
+    Systrace::stopCapture();
+
+    // only the most recent events of the thread are kept
+    std::string json = dumpToString();
+    size_t n = count(json, "\"name\":\"overflow\"");
+    EXPECT_GT(n, 0u);
+    EXPECT_LT(n, 100000u);
+}
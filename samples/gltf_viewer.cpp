@@ -162,6 +162,16 @@ int main(int argc, char** argv) {
     }
 
     auto loadAsset = [&app](utils::Path filename) {
+        // Binary files are mapped rather than read, their buffers are uploaded from the mapping.
+        if (filename.getExtension() == "glb") {
+            app.asset = app.loader->createAssetFromBinaryFile(filename.c_str());
+            if (!app.asset) {
+                std::cerr << "Unable to parse " << filename << std::endl;
+                exit(1);
+            }
+            return;
+        }
+
         // Peek at the file size to allow pre-allocation.
         long contentSize = static_cast<long>(getFileSize(filename.c_str()));
         if (contentSize <= 0) {
@@ -178,11 +188,7 @@ int main(int argc, char** argv) {
         }
 
         // Parse the glTF file and create Filament entities.
-        if (filename.getExtension() == "glb") {
-            app.asset = app.loader->createAssetFromBinary(buffer.data(), buffer.size());
-        } else {
-            app.asset = app.loader->createAssetFromJson(buffer.data(), buffer.size());
-        }
+        app.asset = app.loader->createAssetFromJson(buffer.data(), buffer.size());
         buffer.clear();
         buffer.shrink_to_fit();
 
@@ -85,6 +85,37 @@ vec2 uvToRenderTargetUV(vec2 uv) {
 highp vec3 getLightSpacePosition() {
     return vertex_lightSpacePosition.xyz * (1.0 / vertex_lightSpacePosition.w);
 }
+
+/**
+ * Returns the index of the shadow cascade covering the current fragment. Unused cascades
+ * have a split distance of FLT_MAX, so the last used cascade covers everything behind it.
+ */
+uint getShadowCascade() {
+    highp float z = -(getViewFromWorldMatrix() * vec4(getWorldPosition(), 1.0)).z;
+    bvec4 greater = greaterThan(vec4(z), frameUniforms.cascadeSplits);
+    return uint(dot(vec4(greater), vec4(1.0)));
+}
+
+/**
+ * Returns the position of the current fragment in the light space of the specified cascade.
+ * See getLightSpacePosition() in shadowing.vs for details about the normal bias.
+ */
+highp vec3 getCascadeLightSpacePosition(const uint cascade) {
+    // the first cascade is computed per vertex, this branch is coherent for most fragments
+    if (cascade == 0u) {
+        return getLightSpacePosition();
+    }
+    highp vec3 p = getWorldPosition();
+#if defined(HAS_ATTRIBUTE_TANGENTS)
+    // without tangents there is no normal, and no normal bias
+    vec3 n = getWorldGeometricNormalVector();
+    float NoL = saturate(dot(n, frameUniforms.lightDirection));
+    float sinTheta = sqrt(1.0 - NoL * NoL);
+    p += n * (sinTheta * frameUniforms.cascadeNormalBias[cascade]);
+#endif
+    highp vec4 lightSpacePosition = frameUniforms.lightFromWorldMatrix[cascade] * vec4(p, 1.0);
+    return lightSpacePosition.xyz * (1.0 / lightSpacePosition.w);
+}
 #endif
 
 #if defined(MATERIAL_HAS_DOUBLE_SIDED_CAPABILITY)
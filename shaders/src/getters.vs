@@ -2,8 +2,9 @@
 // Uniforms access
 //------------------------------------------------------------------------------
 
+// the light space transform of the first shadow cascade, the others are computed per fragment
 mat4 getLightFromWorldMatrix() {
-    return frameUniforms.lightFromWorldMatrix;
+    return frameUniforms.lightFromWorldMatrix[0];
 }
 
 /** @public-api */
@@ -20,6 +20,8 @@
 
 #include <meshoptimizer.h>
 
+#include <utils/algorithm.h>
+
 using namespace filamesh;
 using namespace filament::math;
 using namespace std;
@@ -88,6 +90,59 @@ void MeshWriter::optimize(Mesh& mesh) {
     // e.g. we already (potentially) use snorm16 for uvs, half-floats for tangents, etc.
 }
 
+void MeshWriter::buildClusters(Mesh& mesh) {
+    // Meshlet limits: 64 vertices is the most meshoptimizer supports, and 124 triangles keeps the
+    // triangle count a multiple of 4, as it recommends.
+    constexpr size_t MAX_VERTICES = 64;
+    constexpr size_t MAX_TRIANGLES = 124;
+
+    // The bounds are computed from the quantized positions, so they match what's rendered.
+    vector<float3> positions(mesh.vertexCount);
+    for (size_t i = 0; i < mesh.vertexCount; i++) {
+        const half4 position = (mFlags & INTERLEAVED) ?
+                mesh.vertices[i].position : mesh.positions[i];
+        if (mFlags & POSITION_SNORM16) {
+            const float3 p = unpackSnorm16(utils::bit_cast<short4>(position)).xyz;
+            positions[i] = mesh.positionBounds.center + p * mesh.positionBounds.halfExtent;
+        } else {
+            positions[i] = float3(position.xyz);
+        }
+    }
+
+    mesh.clusters.clear();
+    for (size_t partIndex = 0; partIndex < mesh.parts.size(); partIndex++) {
+        const Part& part = mesh.parts[partIndex];
+        uint32_t* partIndices = mesh.indices.data() + part.offset;
+
+        vector<meshopt_Meshlet> meshlets(meshopt_buildMeshletsBound(part.indexCount,
+                MAX_VERTICES, MAX_TRIANGLES));
+        meshlets.resize(meshopt_buildMeshlets(meshlets.data(), partIndices, part.indexCount,
+                mesh.vertexCount, MAX_VERTICES, MAX_TRIANGLES));
+
+        // Rewrite the triangles of the part, one meshlet after the other. Meshlets keep the
+        // triangle order of the vertex cache optimization.
+        uint32_t offset = part.offset;
+        for (const meshopt_Meshlet& meshlet : meshlets) {
+            const meshopt_Bounds bounds = meshopt_computeMeshletBounds(meshlet,
+                    &positions.data()->x, mesh.vertexCount, sizeof(float3));
+            const uint32_t indexCount = meshlet.triangle_count * 3u;
+            mesh.clusters.push_back({
+                uint32_t(partIndex), offset, indexCount,
+                float3(bounds.center[0], bounds.center[1], bounds.center[2]), bounds.radius,
+                float3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]),
+                float3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]),
+                bounds.cone_cutoff
+            });
+            for (size_t t = 0; t < meshlet.triangle_count; t++) {
+                mesh.indices[offset++] = meshlet.vertices[meshlet.indices[t][0]];
+                mesh.indices[offset++] = meshlet.vertices[meshlet.indices[t][1]];
+                mesh.indices[offset++] = meshlet.vertices[meshlet.indices[t][2]];
+            }
+        }
+        assert(offset == part.offset + part.indexCount);
+    }
+}
+
 bool MeshWriter::serialize(ostream& out, Mesh& mesh) {
     const bool hasIndex16 = mesh.vertexCount <= numeric_limits<uint16_t>::max();
     const bool hasUV1 = !mesh.uv1.empty();
@@ -97,15 +152,24 @@ bool MeshWriter::serialize(ostream& out, Mesh& mesh) {
         return false;
     }
 
-    // Compute the overall bounding box.
+    // Compute the overall bounding box. Quantized positions are normalized to the bounds of
+    // all the vertices, which the reader gets from the header.
     Box aabb = mesh.parts.at(0).aabb;
     for (size_t i = 1; i < mesh.parts.size(); i++) {
         aabb.unionSelf(mesh.parts.at(i).aabb);
     }
+    if (mFlags & POSITION_SNORM16) {
+        aabb = mesh.positionBounds;
+    }
 
     // It's safe to optimize the mesh regardless of the compression setting.
     optimize(mesh);
 
+    // Clusters are built last, as they depend on the final triangle order.
+    if (mFlags & CLUSTERS) {
+        buildClusters(mesh);
+    }
+
     // Perform compression of vertex data if it has been requested.
     CompressionHeader cheader {};
     vector<unsigned char> compressedVertices;
@@ -250,5 +314,10 @@ bool MeshWriter::serialize(ostream& out, Mesh& mesh) {
         write(out, char(0));
     }
 
+    if (mFlags & CLUSTERS) {
+        write(out, uint32_t(mesh.clusters.size()));
+        write(out, mesh.clusters.data(), uint32_t(mesh.clusters.size()));
+    }
+
     return true;
 }
@@ -53,11 +53,16 @@ struct Mesh {
     std::vector<decltype(Vertex::color)>     colors;
     std::vector<decltype(Vertex::uv0)>       uv0;
     std::vector<decltype(Vertex::uv0)>       uv1;
+    // bounds the positions are normalized to when the POSITION_SNORM16 flag is set
+    Box positionBounds;
+    // generated by MeshWriter when the CLUSTERS flag is set
+    std::vector<Cluster> clusters;
 };
 
 class MeshWriter {
     uint32_t mFlags;
     void optimize(Mesh& mesh);
+    void buildClusters(Mesh& mesh);
 public:
     MeshWriter(uint32_t flags) : mFlags(flags) {}
     bool serialize(std::ostream&, Mesh& mesh);
@@ -47,10 +47,14 @@ using Assimp::Importer;
 bool g_interleaved = false;
 bool g_snormUVs = false;
 bool g_compression = false;
+bool g_clusters = false;
+bool g_quantizePositions = false;
 
 Mesh g_mesh;
 float2 g_minUV = float2(std::numeric_limits<float>::max());
 float2 g_maxUV = float2(std::numeric_limits<float>::lowest());
+float3 g_minPosition = float3(std::numeric_limits<float>::max());
+float3 g_maxPosition = float3(std::numeric_limits<float>::lowest());
 
 template<bool SNORMUVS>
 static ushort2 convertUV(float2 uv) {
@@ -63,14 +67,27 @@ static ushort2 convertUV(float2 uv) {
     }
 }
 
+// Positions are either half-floats, or 16-bit integers normalized to the bounds of the mesh.
+static half4 convertPosition(float3 position) {
+    if (g_quantizePositions) {
+        const Box& bounds = g_mesh.positionBounds;
+        // flat meshes have a null extent along one axis, all their positions are at the center
+        const float3 extent = bounds.halfExtent;
+        const float3 p = (position - bounds.center) /
+                float3(extent.x ? extent.x : 1, extent.y ? extent.y : 1, extent.z ? extent.z : 1);
+        return bit_cast<half4>(packSnorm16(float4(clamp(p, -1.0f, 1.0f), 1.0f)));
+    }
+    return half4(position, 1.0_h);
+}
+
 template<typename VECTOR, typename INDEX>
 static Box computeAABB(VECTOR const* positions, INDEX const* indices,
-        size_t count, size_t stride) noexcept {
+        size_t count, size_t stride, size_t baseIndex = 0) noexcept {
     filament::math::float3 bmin(std::numeric_limits<float>::max());
     filament::math::float3 bmax(std::numeric_limits<float>::lowest());
     for (size_t i = 0; i < count; ++i) {
         VECTOR const* p = reinterpret_cast<VECTOR const *>(
-                (char const*) positions + indices[i] * stride);
+                (char const*) positions + (indices[i] - baseIndex) * stride);
         const filament::math::float3 v(p->x, p->y, p->z);
         bmin = min(bmin, v);
         bmax = max(bmax, v);
@@ -85,6 +102,11 @@ void preprocessNode(const aiScene* scene, const aiNode* node) {
             std::cerr << "Error: mesh " << i <<  " does not have normals" << std::endl;
             continue;
         }
+        const float3* vertices = reinterpret_cast<const float3*>(mesh->mVertices);
+        for (size_t j = 0; j < mesh->mNumVertices; j++) {
+            g_minPosition = min(vertices[j], g_minPosition);
+            g_maxPosition = max(vertices[j], g_maxPosition);
+        }
         if (!mesh->HasTextureCoords(0)) {
             std::cerr << "Warning: mesh " << i <<  " does not have texture coordinates"
                     << std::endl;
@@ -167,7 +189,7 @@ void processNode(const aiScene* scene, const aiNode* node, std::vector<Part>& me
                     }
                     color = colors ? colors[j] : float4(1.0f);
                     Vertex vertex {
-                        .position = half4(vertices[j], 1.0_h),
+                        .position = convertPosition(vertices[j]),
                         .tangents = short4(filament::math::packSnorm16(q.xyzw)),
                         .color = ubyte4(clamp(color, 0.0f, 1.0f) * 255.0f),
                         .uv0 = uv0 ? convertUV<SNORMUVS>(uv0[j].xy) : ushort2(0),
@@ -197,11 +219,18 @@ void processNode(const aiScene* scene, const aiNode* node, std::vector<Part>& me
                     }
                 }
 
-                size_t stride = INTERLEAVED ? sizeof(Vertex) : sizeof(Vertex::position);
-                const decltype(Vertex::position)* positions =
-                        INTERLEAVED ? &g_mesh.vertices.data()->position : g_mesh.positions.data();
-                const Box aabb(computeAABB(positions,
-                        g_mesh.indices.data() + indexBufferOffset, indicesCount, stride));
+                Box aabb;
+                if (g_quantizePositions) {
+                    // the stored positions are quantized, use the source positions instead
+                    aabb = computeAABB(vertices, g_mesh.indices.data() + indexBufferOffset,
+                            indicesCount, sizeof(float3), indicesOffset);
+                } else {
+                    size_t stride = INTERLEAVED ? sizeof(Vertex) : sizeof(Vertex::position);
+                    const decltype(Vertex::position)* positions = INTERLEAVED ?
+                            &g_mesh.vertices.data()->position : g_mesh.positions.data();
+                    aabb = computeAABB(positions,
+                            g_mesh.indices.data() + indexBufferOffset, indicesCount, stride);
+                }
 
                 meshes.emplace_back(Part {
                     .offset = indexBufferOffset,
@@ -241,6 +270,12 @@ static void printUsage(const char* name) {
                     "       interleaves mesh attributes\n\n"
                     "   --compress, -c\n"
                     "       enable compression\n\n"
+                    "   --clusters, -m\n"
+                    "       split parts into clusters of triangles (meshlets) that can be culled\n"
+                    "       individually at runtime\n\n"
+                    "   --quantize, -q\n"
+                    "       store positions as 16-bit integers normalized to the bounds of the mesh,\n"
+                    "       rather than half-floats, for a better precision with large meshes\n\n"
     );
 
     const std::string from("FILAMESH");
@@ -262,12 +297,14 @@ static void license() {
 }
 
 static int handleArguments(int argc, char* argv[]) {
-    static constexpr const char* OPTSTR = "hilc";
+    static constexpr const char* OPTSTR = "hilcmq";
     static const struct option OPTIONS[] = {
             { "help",        no_argument, 0, 'h' },
             { "license",     no_argument, 0, 'l' },
             { "interleaved", no_argument, 0, 'i' },
             { "compress",    no_argument, 0, 'c' },
+            { "clusters",    no_argument, 0, 'm' },
+            { "quantize",    no_argument, 0, 'q' },
             { 0, 0, 0, 0 }  // termination of the option list
     };
 
@@ -292,6 +329,12 @@ static int handleArguments(int argc, char* argv[]) {
             case 'c':
                 g_compression = true;
                 break;
+            case 'm':
+                g_clusters = true;
+                break;
+            case 'q':
+                g_quantizePositions = true;
+                break;
         }
     }
 
@@ -345,6 +388,7 @@ int main(int argc, char* argv[]) {
     preprocessNode(scene, node);
     g_snormUVs = g_minUV.x >= -1.0f && g_minUV.x <= 1.0f && g_maxUV.x >= -1.0f && g_maxUV.x <= 1.0f &&
                  g_minUV.y >= -1.0f && g_minUV.y <= 1.0f && g_maxUV.y >= -1.0f && g_maxUV.y <= 1.0f;
+    g_mesh.positionBounds = Box().set(g_minPosition, g_maxPosition);
 
     // Consume assimp data and produce filamesh data.
     if (g_interleaved) {
@@ -399,6 +443,12 @@ int main(int argc, char* argv[]) {
     if (g_compression) {
         flags |= filamesh::COMPRESSION;
     }
+    if (g_clusters) {
+        flags |= filamesh::CLUSTERS;
+    }
+    if (g_quantizePositions) {
+        flags |= filamesh::POSITION_SNORM16;
+    }
     MeshWriter(flags).serialize(out, g_mesh);
 
     out.flush();
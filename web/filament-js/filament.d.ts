@@ -622,6 +622,7 @@ export enum Texture$Sampler {
     SAMPLER_2D,
     SAMPLER_CUBEMAP,
     SAMPLER_EXTERNAL,
+    SAMPLER_2D_ARRAY,
 }
 
 export enum Texture$Usage {
@@ -1494,6 +1494,10 @@ class_<ResourceLoader>("gltfio$ResourceLoader")
         self->addResourceData(url, std::move(*buffer.bd));
     }), allow_raw_pointers())
 
-    .function("loadResources", &ResourceLoader::loadResources, allow_raw_pointers());
+    .function("loadResources", &ResourceLoader::loadResources, allow_raw_pointers())
+    .function("asyncBeginLoad", &ResourceLoader::asyncBeginLoad, allow_raw_pointers())
+    .function("asyncUpdateLoad", &ResourceLoader::asyncUpdateLoad)
+    .function("asyncGetLoadProgress", &ResourceLoader::asyncGetLoadProgress)
+    .function("asyncCancelLoad", &ResourceLoader::asyncCancelLoad);
 
 } // EMSCRIPTEN_BINDINGS
@@ -144,7 +144,8 @@ enum_<Frustum::Plane>("Frustum$Plane")
 enum_<Texture::Sampler>("Texture$Sampler") // aka backend::SamplerType
     .value("SAMPLER_2D", Texture::Sampler::SAMPLER_2D)
     .value("SAMPLER_CUBEMAP", Texture::Sampler::SAMPLER_CUBEMAP)
-    .value("SAMPLER_EXTERNAL", Texture::Sampler::SAMPLER_EXTERNAL);
+    .value("SAMPLER_EXTERNAL", Texture::Sampler::SAMPLER_EXTERNAL)
+    .value("SAMPLER_2D_ARRAY", Texture::Sampler::SAMPLER_2D_ARRAY);
 
 enum_<Texture::InternalFormat>("Texture$InternalFormat") // aka backend::TextureFormat
     .value("R8", Texture::InternalFormat::R8)